@@ -0,0 +1,32 @@
+#pragma once
+
+#include <unistd.h>
+
+#include <cstring>
+#include <string>
+
+#include "storage/disk_manager.h"
+
+/**
+ * @description: 创建测试文件（已存在时先删除），直接通过disk_manager写入num_pages个页面并fsync，
+ *              第i个页面的前4个字节为页号i，其余为0
+ * @return {int} 测试文件的文件句柄
+ * @param {DiskManager*} disk_manager 打开测试文件的disk_manager
+ * @param {string&} file_name 测试文件名
+ * @param {int} num_pages 页面个数
+ */
+inline int prepare_file(DiskManager *disk_manager, const std::string &file_name, int num_pages) {
+    if (disk_manager->is_file(file_name)) {
+        disk_manager->destroy_file(file_name);
+    }
+    disk_manager->create_file(file_name);
+    int fd = disk_manager->open_file(file_name);
+    char buf[PAGE_SIZE] = {};
+    for (int i = 0; i < num_pages; i++) {
+        memcpy(buf, &i, sizeof(int));
+        disk_manager->write_page(fd, i, buf, PAGE_SIZE);
+    }
+    fsync(fd);
+    disk_manager->set_fd2pageno(fd, num_pages);
+    return fd;
+}
@@ -0,0 +1,96 @@
+/**
+ * 缓冲池并发吞吐量测试
+ *
+ * 在一组常驻缓冲池的页面上做随机的 fetch_page/unpin_page（只读点查负载），
+ * 分别在 1 个分区和 N 个分区的缓冲池上，统计不同线程数下每秒完成的 fetch/unpin 次数。
+ *
+ * 用法: buffer_pool_bench [num_pages] [seconds_per_run]
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench_util.h"
+#include "storage/buffer_pool_manager.h"
+#include "storage/disk_manager.h"
+
+static const std::string BENCH_FILE_NAME = "buffer_pool_bench.db";
+
+/**
+ * @description: 运行一轮测试
+ * @return {double} 每秒完成的fetch_page+unpin_page次数
+ */
+static double run_once(DiskManager *disk_manager, int fd, int num_pages, size_t num_instances, int num_threads,
+                       double seconds) {
+    BufferPoolManager bpm(num_pages, disk_manager, num_instances);
+    // 预热：所有页面常驻缓冲池，测试过程中只有命中
+    for (int i = 0; i < num_pages; i++) {
+        PageId page_id = {fd, i};
+        bpm.fetch_page(page_id);
+        bpm.unpin_page(page_id, false);
+    }
+
+    std::atomic<bool> stop{false};
+    std::vector<uint64_t> ops(num_threads, 0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&, t]() {
+            std::mt19937 rng(t + 1);
+            std::uniform_int_distribution<int> dist(0, num_pages - 1);
+            uint64_t local_ops = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                for (int k = 0; k < 64; k++) {
+                    PageId page_id = {fd, dist(rng)};
+                    Page *page = bpm.fetch_page(page_id);
+                    if (page != nullptr) {
+                        bpm.unpin_page(page_id, false);
+                    }
+                }
+                local_ops += 64;
+            }
+            ops[t] = local_ops;
+        });
+    }
+    auto start = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    stop = true;
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    uint64_t total = 0;
+    for (auto n : ops) {
+        total += n;
+    }
+    return total / elapsed;
+}
+
+int main(int argc, char **argv) {
+    int num_pages = argc > 1 ? atoi(argv[1]) : 4096;
+    double seconds = argc > 2 ? atof(argv[2]) : 1.0;
+
+    DiskManager *disk_manager = new DiskManager();
+    int fd = prepare_file(disk_manager, BENCH_FILE_NAME, num_pages);
+
+    int max_threads = std::max(1u, std::thread::hardware_concurrency()) * 2;
+    printf("pages=%d, partitions=1 vs %zu, %.1fs per run\n", num_pages, (size_t)BUFFER_POOL_INSTANCES, seconds);
+    printf("%8s %16s %16s %8s\n", "threads", "1 part (ops/s)", "N part (ops/s)", "speedup");
+    for (int num_threads = 1; num_threads <= max_threads && num_threads <= 64; num_threads *= 2) {
+        double single = run_once(disk_manager, fd, num_pages, 1, num_threads, seconds);
+        double parted = run_once(disk_manager, fd, num_pages, BUFFER_POOL_INSTANCES, num_threads, seconds);
+        printf("%8d %16.0f %16.0f %8.2f\n", num_threads, single, parted, parted / single);
+    }
+
+    disk_manager->close_file(fd);
+    disk_manager->destroy_file(BENCH_FILE_NAME);
+    delete disk_manager;
+    return 0;
+}
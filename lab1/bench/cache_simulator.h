@@ -0,0 +1,101 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "replacer/replacer.h"
+
+/**
+ * @description: 不经过磁盘，只用 Replacer 接口模拟一个容量为 pool_size 的缓冲池：
+ *              命中时 pin + unpin，未命中时先取空闲帧，没有空闲帧再调用 victim 淘汰，并统计 victim 的耗时
+ */
+class CacheSimulator {
+   public:
+    CacheSimulator(Replacer *replacer, size_t pool_size) : replacer_(replacer), frame_page_(pool_size, -1) {
+        for (size_t i = 0; i < pool_size; i++) {
+            free_frames_.push_back(static_cast<frame_id_t>(pool_size - 1 - i));
+        }
+    }
+
+    /**
+     * @description: 访问一个页面
+     * @return {bool} 命中返回true
+     */
+    bool access(int64_t page) {
+        auto it = page_table_.find(page);
+        if (it != page_table_.end()) {
+            replacer_->pin(it->second);
+            replacer_->unpin(it->second);
+            return true;
+        }
+        frame_id_t frame_id;
+        if (!free_frames_.empty()) {
+            frame_id = free_frames_.back();
+            free_frames_.pop_back();
+        } else {
+            auto start = std::chrono::steady_clock::now();
+            bool found = replacer_->victim(&frame_id);
+            victim_ns_ += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start)
+                              .count();
+            victims_++;
+            if (!found) {
+                return false;
+            }
+            page_table_.erase(frame_page_[frame_id]);
+        }
+        frame_page_[frame_id] = page;
+        page_table_[page] = frame_id;
+        replacer_->load(frame_id, PageId{static_cast<int>(page >> 32), static_cast<page_id_t>(page)});
+        replacer_->pin(frame_id);
+        replacer_->unpin(frame_id);
+        return false;
+    }
+
+    uint64_t get_victims() const { return victims_; }
+
+    uint64_t get_victim_ns() const { return victim_ns_; }
+
+   private:
+    Replacer *replacer_;
+    std::vector<int64_t> frame_page_;
+    std::vector<frame_id_t> free_frames_;
+    std::unordered_map<int64_t, frame_id_t> page_table_;
+    uint64_t victims_ = 0;      // 调用victim的次数
+    uint64_t victim_ns_ = 0;    // victim的总耗时（纳秒）
+};
+
+/**
+ * @description: Zipf 分布的页面号生成器，热点页面被打散到整个表中
+ */
+class ZipfGenerator {
+   public:
+    ZipfGenerator(int64_t n, double theta, uint32_t seed) : n_(n), rng_(seed), dist_(0.0, 1.0) {
+        cdf_.resize(n);
+        double sum = 0;
+        for (int64_t i = 0; i < n; i++) {
+            sum += 1.0 / std::pow(static_cast<double>(i + 1), theta);
+            cdf_[i] = sum;
+        }
+        for (auto &c : cdf_) {
+            c /= sum;
+        }
+    }
+
+    int64_t next() {
+        int64_t rank = std::lower_bound(cdf_.begin(), cdf_.end(), dist_(rng_)) - cdf_.begin();
+        rank = std::min(rank, n_ - 1);
+        // 用一个大素数把排名映射到页面号，避免热点集中在表头
+        return (rank * 2654435761LL) % n_;
+    }
+
+   private:
+    int64_t n_;
+    std::mt19937 rng_;
+    std::uniform_real_distribution<double> dist_;
+    std::vector<double> cdf_;
+};
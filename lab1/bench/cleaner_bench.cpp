@@ -0,0 +1,123 @@
+/**
+ * 后台刷脏开销测试
+ *
+ * 在只有 1 个分区、帧数为 pool_size 的缓冲池上，装满页面并把其中 1/20 标记为脏页，统计：
+ * - 不需要写回时一次 clean_pages 的耗时（判断是否需要写回），它在分区的 latch_ 内完成；
+ * - 需要写回时每轮 clean_pages 的耗时和写回的页数；
+ * - 一个前台线程随机 fetch_page/unpin_page（约 1/5 未命中，未命中要加 latch_）每秒完成的次数，
+ *   分别在没有刷脏线程和另一个线程不停调用 clean_pages 时测量。
+ * clean_pages 只遍历脏页集合，判断是否需要写回只读计数，耗时不随 pool_size 增长，也就不会长时间占住 latch_。
+ *
+ * 用法: cleaner_bench [run_ms] [pool_size...]
+ */
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench_util.h"
+#include "storage/buffer_pool_manager.h"
+#include "storage/disk_manager.h"
+
+static const std::string BENCH_FILE_NAME = "cleaner_bench.db";
+
+/**
+ * @description: 一个线程在[0, num_pages)上随机fetch_page/unpin_page，直到运行了run_ms毫秒
+ * @return {double} 每秒完成的fetch/unpin次数
+ */
+static double run_fetches(BufferPoolManager *bpm, int fd, int num_pages, int run_ms) {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> dist(0, num_pages - 1);
+    uint64_t num_fetches = 0;
+    auto start = std::chrono::steady_clock::now();
+    auto end = start + std::chrono::milliseconds(run_ms);
+    while (std::chrono::steady_clock::now() < end) {
+        for (int i = 0; i < 256; i++) {
+            PageId page_id = {fd, dist(rng)};
+            if (bpm->fetch_page(page_id) == nullptr) {
+                printf("page %d: fetch failed\n", page_id.page_no);
+                exit(1);
+            }
+            bpm->unpin_page(page_id, false);
+        }
+        num_fetches += 256;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return num_fetches / seconds;
+}
+
+int main(int argc, char **argv) {
+    int run_ms = argc > 1 ? atoi(argv[1]) : 1000;
+    std::vector<size_t> pool_sizes;
+    for (int i = 2; i < argc; i++) {
+        pool_sizes.push_back(atol(argv[i]));
+    }
+    if (pool_sizes.empty()) {
+        pool_sizes = {4096, 16384, 65536};
+    }
+
+    // 脏页比例不超过1、干净帧比例不低于0，clean_pages只做判断不写回
+    PageCleanerConfig idle_config;
+    idle_config.max_dirty_ratio = 1.0;
+    idle_config.min_clean_ratio = 0.0;
+    // 有脏页就写回
+    PageCleanerConfig clean_config;
+    clean_config.max_dirty_ratio = 0.0;
+
+    printf("%10s %14s %16s %16s %18s %22s\n", "pool_size", "check us", "clean round us", "pages per round",
+           "fetches/s alone", "fetches/s + cleaner");
+    for (size_t pool_size : pool_sizes) {
+        int num_pages = static_cast<int>(pool_size + pool_size / 4);
+        DiskManager disk_manager;
+        int fd = prepare_file(&disk_manager, BENCH_FILE_NAME, num_pages);
+        BufferPoolManager bpm(pool_size, &disk_manager, 1);
+        for (int i = 0; i < static_cast<int>(pool_size); i++) {
+            PageId page_id = {fd, i};
+            bpm.fetch_page(page_id);
+            bpm.unpin_page(page_id, i % 20 == 0);
+        }
+
+        const int num_checks = 1000;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < num_checks; i++) {
+            bpm.clean_pages(idle_config);
+        }
+        double check_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() /
+                          num_checks;
+
+        int num_rounds = 0;
+        size_t num_cleaned = 0;
+        start = std::chrono::steady_clock::now();
+        while (size_t cleaned = bpm.clean_pages(clean_config)) {
+            num_cleaned += cleaned;
+            num_rounds++;
+        }
+        double round_us = num_rounds == 0 ? 0.0
+                                          : std::chrono::duration<double, std::micro>(
+                                                std::chrono::steady_clock::now() - start).count() / num_rounds;
+
+        double alone = run_fetches(&bpm, fd, num_pages, run_ms);
+        std::atomic<bool> stop{false};
+        std::thread cleaner([&] {
+            while (!stop.load(std::memory_order_relaxed)) {
+                bpm.clean_pages(idle_config);
+            }
+        });
+        double with_cleaner = run_fetches(&bpm, fd, num_pages, run_ms);
+        stop = true;
+        cleaner.join();
+
+        printf("%10zu %14.2f %16.1f %16.1f %18.0f %22.0f\n", pool_size, check_us, round_us,
+               num_rounds == 0 ? 0.0 : static_cast<double>(num_cleaned) / num_rounds, alone, with_cleaner);
+        disk_manager.close_file(fd);
+    }
+
+    DiskManager disk_manager;
+    disk_manager.destroy_file(BENCH_FILE_NAME);
+    return 0;
+}
@@ -0,0 +1,84 @@
+/**
+ * CLOCK 替换器并发竞争测试
+ *
+ * 多个线程直接调用 Replacer 接口，模拟缓冲池命中路径：
+ * 每次在随机帧上 pin + unpin，每 evict_interval 次再做一次 victim + unpin（模拟未命中时的淘汰和重新装入）。
+ * 分别在加锁的 ClockReplacer 和不加锁的 LockFreeClockReplacer 上统计不同线程数下每秒完成的操作次数。
+ *
+ * 用法: clock_contention_bench [num_frames] [seconds_per_run] [evict_interval]
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "replacer/clock_replacer.h"
+#include "replacer/lock_free_clock_replacer.h"
+
+/**
+ * @description: 运行一轮测试
+ * @return {double} 每秒完成的pin+unpin次数
+ */
+static double run_once(Replacer *replacer, int num_frames, int num_threads, double seconds, int evict_interval) {
+    for (int i = 0; i < num_frames; i++) {
+        replacer->unpin(i);
+    }
+
+    std::atomic<bool> stop{false};
+    std::vector<uint64_t> ops(num_threads, 0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&, t]() {
+            std::mt19937 rng(t + 1);
+            std::uniform_int_distribution<int> dist(0, num_frames - 1);
+            uint64_t local_ops = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                for (int k = 0; k < 64; k++) {
+                    frame_id_t frame_id = dist(rng);
+                    replacer->pin(frame_id);
+                    replacer->unpin(frame_id);
+                    if (evict_interval > 0 && (local_ops + k) % evict_interval == 0 && replacer->victim(&frame_id)) {
+                        replacer->unpin(frame_id);
+                    }
+                }
+                local_ops += 64;
+            }
+            ops[t] = local_ops;
+        });
+    }
+    auto start = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    stop = true;
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    uint64_t total = 0;
+    for (auto n : ops) {
+        total += n;
+    }
+    return total / elapsed;
+}
+
+int main(int argc, char **argv) {
+    int num_frames = argc > 1 ? atoi(argv[1]) : 4096;
+    double seconds = argc > 2 ? atof(argv[2]) : 1.0;
+    int evict_interval = argc > 3 ? atoi(argv[3]) : 100;
+
+    int max_threads = std::max(1u, std::thread::hardware_concurrency()) * 2;
+    printf("frames=%d, victim every %d ops, %.1fs per run\n", num_frames, evict_interval, seconds);
+    printf("%8s %18s %18s %8s\n", "threads", "mutex (ops/s)", "lock-free (ops/s)", "speedup");
+    for (int num_threads = 1; num_threads <= max_threads && num_threads <= 64; num_threads *= 2) {
+        ClockReplacer locked(num_frames);
+        LockFreeClockReplacer lock_free(num_frames);
+        double base = run_once(&locked, num_frames, num_threads, seconds, evict_interval);
+        double atomic = run_once(&lock_free, num_frames, num_threads, seconds, evict_interval);
+        printf("%8d %18.0f %18.0f %8.2f\n", num_threads, base, atomic, atomic / base);
+    }
+    return 0;
+}
@@ -0,0 +1,173 @@
+/**
+ * 压缩二级缓存测试
+ *
+ * 测试文件中的页面模拟 CHAR(n) 列补零的表页面：每条记录有一个整数和几个只用了开头若干字节的定长字符串。
+ * 在 num_pages 个页面上做 Zipf 分布的点查，缓冲池只有 pool_size 个帧，分别在不启用压缩缓存和
+ * 压缩缓存预算为缓冲池内存的 1/4、1/2、1 倍时，统计每次点查的磁盘读次数和压缩缓存中的页面数
+ * （有效缓存容量 = 缓冲池帧数 + 压缩缓存中的页面数）。最后给出单个页面压缩和解压的耗时。
+ *
+ * 用法: compressed_cache_bench [pool_size] [num_pages] [num_lookups]
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "storage/buffer_pool_manager.h"
+#include "storage/compressed_page_cache.h"
+#include "storage/disk_manager.h"
+
+static const std::string BENCH_FILE_NAME = "compressed_cache_bench.db";
+// 每条记录: int id + 3个CHAR(32) + 1个CHAR(64)，字符串只用开头的几个字节，其余补零
+static constexpr int RECORD_SIZE = 4 + 3 * 32 + 64;
+
+/**
+ * @description: 按记录的格式填充一个页面
+ */
+static void fill_page(char *buf, int page_no, std::mt19937 &rng) {
+    memset(buf, 0, PAGE_SIZE);
+    std::uniform_int_distribution<int> len_dist(4, 12);
+    std::uniform_int_distribution<int> char_dist('a', 'z');
+    int num_records = PAGE_SIZE / RECORD_SIZE;
+    for (int slot = 0; slot < num_records; slot++) {
+        char *record = buf + slot * RECORD_SIZE;
+        int id = page_no * num_records + slot;
+        memcpy(record, &id, sizeof(int));
+        int offsets[] = {4, 4 + 32, 4 + 64, 4 + 96};
+        for (int offset : offsets) {
+            int len = len_dist(rng);
+            for (int i = 0; i < len; i++) {
+                record[offset + i] = static_cast<char>(char_dist(rng));
+            }
+        }
+    }
+}
+
+/**
+ * @description: 创建测试文件，并直接通过disk_manager写入num_pages个页面
+ * @return {int} 测试文件的文件句柄
+ */
+static int prepare_file(DiskManager *disk_manager, int num_pages) {
+    if (disk_manager->is_file(BENCH_FILE_NAME)) {
+        disk_manager->destroy_file(BENCH_FILE_NAME);
+    }
+    disk_manager->create_file(BENCH_FILE_NAME);
+    int fd = disk_manager->open_file(BENCH_FILE_NAME);
+    std::mt19937 rng(7);
+    char buf[PAGE_SIZE];
+    for (int i = 0; i < num_pages; i++) {
+        fill_page(buf, i, rng);
+        disk_manager->write_page(fd, i, buf, PAGE_SIZE);
+    }
+    disk_manager->set_fd2pageno(fd, num_pages);
+    return fd;
+}
+
+struct RunResult {
+    double disk_reads_per_lookup;   // 每次点查平均的磁盘读次数
+    double hit_ratio;               // 缓冲池或压缩缓存命中的比例
+    size_t tier_pages;              // 结束时压缩缓存中的页面数
+    size_t tier_bytes;              // 结束时压缩缓存占用的内存
+};
+
+/**
+ * @description: 运行一轮测试，先用一半的点查预热，只统计后一半
+ */
+static RunResult run_once(DiskManager *disk_manager, int fd, size_t pool_size, int num_pages, int num_lookups,
+                          size_t tier_bytes) {
+    BufferPoolManager bpm(pool_size, disk_manager);
+    bpm.set_compressed_cache_size(tier_bytes);
+    std::mt19937 rng(42);
+    std::vector<double> weights(num_pages);
+    for (int i = 0; i < num_pages; i++) {
+        weights[i] = 1.0 / std::pow(i + 1, 0.8);
+    }
+    std::discrete_distribution<int> zipf(weights.begin(), weights.end());
+    // 热点页面在文件中打散
+    std::vector<int> permutation(num_pages);
+    for (int i = 0; i < num_pages; i++) {
+        permutation[i] = i;
+    }
+    std::shuffle(permutation.begin(), permutation.end(), rng);
+
+    for (int round = 0; round < 2; round++) {
+        bpm.reset_stats();
+        for (int i = 0; i < num_lookups / 2; i++) {
+            PageId page_id = {fd, permutation[zipf(rng)]};
+            bpm.fetch_page(page_id);
+            bpm.unpin_page(page_id, false);
+        }
+    }
+    uint64_t lookups = num_lookups / 2;
+    uint64_t disk_reads = bpm.get_fetch_misses() - bpm.get_tier_hits();
+    const CompressedPageCache &tier = bpm.get_compressed_cache();
+    return {static_cast<double>(disk_reads) / lookups, 100.0 * (lookups - disk_reads) / lookups, tier.get_num_pages(),
+            tier.get_bytes_used()};
+}
+
+/**
+ * @description: 单个页面压缩和解压的平均耗时
+ */
+static void measure_codec(DiskManager *disk_manager, int fd, int num_pages) {
+    std::vector<char> pages(static_cast<size_t>(num_pages) * PAGE_SIZE);
+    for (int i = 0; i < num_pages; i++) {
+        disk_manager->read_page(fd, i, pages.data() + static_cast<size_t>(i) * PAGE_SIZE, PAGE_SIZE);
+    }
+    std::vector<char> compressed(static_cast<size_t>(num_pages) * PAGE_SIZE);
+    std::vector<size_t> sizes(num_pages);
+    size_t total = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_pages; i++) {
+        sizes[i] = compress_page(pages.data() + static_cast<size_t>(i) * PAGE_SIZE,
+                                 compressed.data() + static_cast<size_t>(i) * PAGE_SIZE, PAGE_SIZE);
+        total += sizes[i];
+    }
+    auto mid = std::chrono::steady_clock::now();
+    char out[PAGE_SIZE];
+    for (int i = 0; i < num_pages; i++) {
+        if (sizes[i] == 0 || !decompress_page(compressed.data() + static_cast<size_t>(i) * PAGE_SIZE, sizes[i], out) ||
+            memcmp(out, pages.data() + static_cast<size_t>(i) * PAGE_SIZE, PAGE_SIZE) != 0) {
+            printf("page %d: round trip failed\n", i);
+            exit(1);
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    double compress_us = std::chrono::duration<double, std::micro>(mid - start).count() / num_pages;
+    double decompress_us = std::chrono::duration<double, std::micro>(end - mid).count() / num_pages;
+    printf("average compressed page: %.0f bytes (%.2fx), compress %.2f us/page, decompress %.2f us/page\n",
+           static_cast<double>(total) / num_pages, static_cast<double>(PAGE_SIZE) * num_pages / total, compress_us,
+           decompress_us);
+}
+
+int main(int argc, char **argv) {
+    size_t pool_size = argc > 1 ? atol(argv[1]) : 1024;
+    int num_pages = argc > 2 ? atoi(argv[2]) : 8192;
+    int num_lookups = argc > 3 ? atoi(argv[3]) : 200000;
+
+    DiskManager *disk_manager = new DiskManager();
+    int fd = prepare_file(disk_manager, num_pages);
+
+    printf("pool_size=%zu (%zu KB), num_pages=%d, lookups=%d\n", pool_size, pool_size * PAGE_SIZE / 1024, num_pages,
+           num_lookups);
+    printf("%12s %20s %12s %12s %12s %20s\n", "tier budget", "disk reads/lookup", "hit %", "tier pages", "tier KB",
+           "effective pages");
+    for (double fraction : {0.0, 0.25, 0.5, 1.0}) {
+        size_t tier_bytes = static_cast<size_t>(fraction * pool_size * PAGE_SIZE);
+        RunResult result = run_once(disk_manager, fd, pool_size, num_pages, num_lookups, tier_bytes);
+        char budget[32];
+        snprintf(budget, sizeof(budget), "%zu KB", tier_bytes / 1024);
+        printf("%12s %20.3f %12.2f %12zu %12zu %20zu\n", budget, result.disk_reads_per_lookup, result.hit_ratio,
+               result.tier_pages, result.tier_bytes / 1024, pool_size + result.tier_pages);
+    }
+    measure_codec(disk_manager, fd, std::min(num_pages, 1024));
+
+    disk_manager->close_file(fd);
+    disk_manager->destroy_file(BENCH_FILE_NAME);
+    delete disk_manager;
+    return 0;
+}
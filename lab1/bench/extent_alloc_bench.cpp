@@ -0,0 +1,158 @@
+/**
+ * 区段预分配测试
+ *
+ * 两个表同时批量插入：交替地在两个文件末尾通过 BufferPoolManager::new_page 创建页面，缓冲池较小，
+ * 淘汰的脏页交替写回两个文件，每插入 sync_pages 个页面对两个文件各做一次 fsync（模拟检查点）。
+ * 分别在不预分配和预分配区段为 extent_kb KB 时，统计插入的耗时、文件在磁盘上的碎片数（FIEMAP），
+ * 以及丢弃页缓存之后用 read_pages 顺序读完一个文件的吞吐量。
+ *
+ * 用法: extent_alloc_bench [num_pages] [pool_size] [sync_pages] [extent_kb...]
+ */
+#include <fcntl.h>
+#include <linux/fiemap.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "storage/buffer_pool_manager.h"
+#include "storage/disk_manager.h"
+
+static const std::string BENCH_FILE_NAMES[2] = {"extent_alloc_bench_a.db", "extent_alloc_bench_b.db"};
+// 顺序读时每次read_pages的页面数
+static constexpr int SCAN_BATCH_PAGES = 64;
+
+/**
+ * @description: 文件在磁盘上的碎片数：用FIEMAP取出所有区段，物理上首尾相接的区段算作同一个碎片
+ */
+static unsigned count_fragments(int fd) {
+    struct fiemap header;
+    memset(&header, 0, sizeof(header));
+    header.fm_length = FIEMAP_MAX_OFFSET;
+    header.fm_flags = FIEMAP_FLAG_SYNC;
+    if (ioctl(fd, FS_IOC_FIEMAP, &header) == -1) {
+        return 0;
+    }
+    unsigned num_extents = header.fm_mapped_extents;
+    std::vector<char> buf(sizeof(struct fiemap) + num_extents * sizeof(struct fiemap_extent));
+    struct fiemap *fiemap = reinterpret_cast<struct fiemap *>(buf.data());
+    *fiemap = header;
+    fiemap->fm_flags = 0;
+    fiemap->fm_extent_count = num_extents;
+    if (ioctl(fd, FS_IOC_FIEMAP, fiemap) == -1) {
+        return 0;
+    }
+    unsigned fragments = 0;
+    for (unsigned i = 0; i < fiemap->fm_mapped_extents; i++) {
+        const struct fiemap_extent &extent = fiemap->fm_extents[i];
+        if (i == 0 || fiemap->fm_extents[i - 1].fe_physical + fiemap->fm_extents[i - 1].fe_length != extent.fe_physical) {
+            fragments++;
+        }
+    }
+    return fragments;
+}
+
+/**
+ * @description: 丢弃页缓存之后顺序读完文件
+ * @return {double} 耗时（秒）
+ */
+static double run_scan(DiskManager *disk_manager, int fd, int num_pages) {
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    std::vector<char> buffer(static_cast<size_t>(SCAN_BATCH_PAGES) * PAGE_SIZE);
+    char *pages[SCAN_BATCH_PAGES];
+    for (int i = 0; i < SCAN_BATCH_PAGES; i++) {
+        pages[i] = buffer.data() + static_cast<size_t>(i) * PAGE_SIZE;
+    }
+    auto start = std::chrono::steady_clock::now();
+    for (int page_no = 0; page_no < num_pages; page_no += SCAN_BATCH_PAGES) {
+        int n = std::min(SCAN_BATCH_PAGES, num_pages - page_no);
+        disk_manager->read_pages(fd, page_no, pages, n);
+        for (int i = 0; i < n; i++) {
+            int expected = page_no + i;
+            if (memcmp(pages[i], &expected, sizeof(int)) != 0) {
+                printf("page %d: wrong content\n", expected);
+                exit(1);
+            }
+        }
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char **argv) {
+    int num_pages = argc > 1 ? atoi(argv[1]) : 32768;
+    size_t pool_size = argc > 2 ? atol(argv[2]) : 256;
+    int sync_pages = argc > 3 ? atoi(argv[3]) : 256;
+    std::vector<size_t> extent_kbs;
+    for (int i = 4; i < argc; i++) {
+        extent_kbs.push_back(atol(argv[i]));
+    }
+    if (extent_kbs.empty()) {
+        extent_kbs = {0, DEFAULT_EXTENT_SIZE / 1024};
+    }
+
+    DiskManager *disk_manager = new DiskManager();
+    printf("2 files x %d pages (%d MB each), pool_size=%zu, fsync every %d pages\n", num_pages,
+           num_pages / (1024 * 1024 / PAGE_SIZE), pool_size, sync_pages);
+    printf("%12s %12s %16s %16s %20s\n", "extent", "load s", "fragments (a/b)", "fallocate calls", "cold scan MB/s");
+    for (size_t extent_kb : extent_kbs) {
+        disk_manager->set_extent_size(extent_kb * 1024);
+        uint64_t reserved_before = disk_manager->get_num_extents_reserved();
+        int fds[2];
+        for (int f = 0; f < 2; f++) {
+            if (disk_manager->is_file(BENCH_FILE_NAMES[f])) {
+                disk_manager->destroy_file(BENCH_FILE_NAMES[f]);
+            }
+            disk_manager->create_file(BENCH_FILE_NAMES[f]);
+            fds[f] = disk_manager->open_file(BENCH_FILE_NAMES[f]);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        {
+            BufferPoolManager bpm(pool_size, disk_manager);
+            for (int i = 0; i < num_pages; i++) {
+                for (int f = 0; f < 2; f++) {
+                    PageId page_id = {fds[f], INVALID_PAGE_ID};
+                    Page *page = bpm.new_page(&page_id);
+                    if (page == nullptr) {
+                        printf("new_page failed\n");
+                        return 1;
+                    }
+                    memcpy(page->get_data(), &page_id.page_no, sizeof(int));
+                    bpm.unpin_page(page_id, true);
+                }
+                if ((i + 1) % sync_pages == 0) {
+                    fsync(fds[0]);
+                    fsync(fds[1]);
+                }
+            }
+            for (int f = 0; f < 2; f++) {
+                bpm.flush_all_pages(fds[f]);
+                fsync(fds[f]);
+            }
+        }
+        double load_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        unsigned fragments[2] = {count_fragments(fds[0]), count_fragments(fds[1])};
+        double mb = static_cast<double>(num_pages) * PAGE_SIZE / (1024 * 1024);
+        double scan_seconds = run_scan(disk_manager, fds[0], num_pages);
+        char extent_name[32], fragments_text[32];
+        snprintf(extent_name, sizeof(extent_name), extent_kb == 0 ? "none" : "%zu KB", extent_kb);
+        snprintf(fragments_text, sizeof(fragments_text), "%u/%u", fragments[0], fragments[1]);
+        printf("%12s %12.2f %16s %16lu %20.1f\n", extent_name, load_seconds, fragments_text,
+               static_cast<unsigned long>(disk_manager->get_num_extents_reserved() - reserved_before),
+               mb / scan_seconds);
+
+        for (int f = 0; f < 2; f++) {
+            disk_manager->close_file(fds[f]);
+            disk_manager->destroy_file(BENCH_FILE_NAMES[f]);
+        }
+    }
+    delete disk_manager;
+    return 0;
+}
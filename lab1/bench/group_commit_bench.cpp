@@ -0,0 +1,103 @@
+/**
+ * 日志组提交测试
+ *
+ * num_threads 个线程不断提交事务，每次提交追加一条 record_size 字节的日志并等待它持久化，运行 run_ms 毫秒。
+ * 分别统计两种写日志方式在不同并发提交线程数下每秒提交的事务数：
+ * 每次提交各自在日志末尾预留范围 pwrite 再 fdatasync（原来的 write_log 加上持久化），
+ * 以及通过 LogWriter 追加到日志缓冲区后 wait_durable，由刷盘线程把同时提交的事务合并成一次写入和一次 fdatasync。
+ *
+ * 用法: group_commit_bench [record_size] [run_ms] [num_threads...]
+ */
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "storage/disk_manager.h"
+
+static const std::string BASELINE_LOG_NAME = "group_commit_bench.log";
+
+/**
+ * @description: num_threads个线程循环执行commit直到运行了run_ms毫秒
+ * @return {double} 每秒提交的事务数
+ */
+template <typename Commit>
+static double run_commits(int num_threads, int run_ms, Commit commit) {
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> num_commits{0};
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&] {
+            uint64_t commits = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                commit();
+                commits++;
+            }
+            num_commits.fetch_add(commits);
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(run_ms));
+    stop = true;
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return num_commits.load() / seconds;
+}
+
+int main(int argc, char **argv) {
+    int record_size = argc > 1 ? atoi(argv[1]) : 128;
+    int run_ms = argc > 2 ? atoi(argv[2]) : 1000;
+    std::vector<int> thread_counts;
+    for (int i = 3; i < argc; i++) {
+        thread_counts.push_back(atoi(argv[i]));
+    }
+    if (thread_counts.empty()) {
+        thread_counts = {1, 2, 4, 8, 16, 32, 64};
+    }
+
+    printf("record_size=%d, %d ms per run\n", record_size, run_ms);
+    printf("%10s %24s %24s %20s\n", "threads", "fsync per commit /s", "group commit /s", "commits per fsync");
+    std::vector<char> record(record_size, 'x');
+    for (int num_threads : thread_counts) {
+        DiskManager disk_manager;
+        for (const std::string &name : {LOG_FILE_NAME, BASELINE_LOG_NAME}) {
+            if (disk_manager.is_file(name)) {
+                disk_manager.destroy_file(name);
+            }
+            disk_manager.create_file(name);
+        }
+
+        int baseline_fd = disk_manager.open_file(BASELINE_LOG_NAME);
+        std::atomic<off_t> baseline_end{0};
+        double baseline = run_commits(num_threads, run_ms, [&] {
+            off_t offset = baseline_end.fetch_add(record_size);
+            if (pwrite(baseline_fd, record.data(), record_size, offset) != record_size || fdatasync(baseline_fd) != 0) {
+                printf("baseline log write failed\n");
+                exit(1);
+            }
+        });
+        disk_manager.close_file(baseline_fd);
+
+        LogWriter *log_writer = disk_manager.get_log_writer();
+        uint64_t syncs_before = log_writer->get_num_syncs();
+        std::atomic<uint64_t> num_commits{0};
+        double group = run_commits(num_threads, run_ms, [&] {
+            log_writer->wait_durable(log_writer->append(record.data(), record_size));
+            num_commits.fetch_add(1, std::memory_order_relaxed);
+        });
+        uint64_t syncs = log_writer->get_num_syncs() - syncs_before;
+        printf("%10d %24.0f %24.0f %20.1f\n", num_threads, baseline, group,
+               syncs == 0 ? 0.0 : static_cast<double>(num_commits.load()) / syncs);
+
+        disk_manager.destroy_file(BASELINE_LOG_NAME);
+    }
+
+    DiskManager disk_manager;
+    disk_manager.destroy_file(LOG_FILE_NAME);
+    return 0;
+}
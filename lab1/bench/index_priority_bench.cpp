@@ -0,0 +1,122 @@
+/**
+ * 页面类别提示测试
+ *
+ * 模拟在一棵三层 B+ 树上做点查：每次点查依次访问根结点、一个内部结点、一个叶子结点，再按叶子中的记录位置
+ * 访问一个堆表页面；叶子和堆表页面都远多于缓冲池的帧数，根结点和内部结点则可以全部常驻。
+ * 可选地在每次点查之后顺序扫描另一个表的 scan_step 个页面。
+ * 分别在不带类别提示（所有页面都是 HEAP）和带类别提示（INDEX_INNER/INDEX_LEAF/HEAP/SCAN）时，
+ * 统计每次点查平均的缺页数，以及其中发生在根结点和内部结点上的缺页数。
+ *
+ * 用法: index_priority_bench [pool_size] [fanout] [heap_pages] [num_lookups] [scan_step] [replacer_type...]
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench_util.h"
+#include "storage/buffer_pool_manager.h"
+#include "storage/disk_manager.h"
+
+static const std::string INDEX_FILE_NAME = "index_priority_bench_index.db";
+static const std::string HEAP_FILE_NAME = "index_priority_bench_heap.db";
+static const std::string SCAN_FILE_NAME = "index_priority_bench_scan.db";
+
+struct RunResult {
+    double misses_per_lookup;       // 每次点查的平均缺页数
+    double inner_misses_per_lookup; // 其中根结点和内部结点上的平均缺页数
+};
+
+/**
+ * @description: 访问一个页面，返回这次访问是否缺页
+ */
+static bool access(BufferPoolManager *bpm, PageId page_id, BufferAccessStrategy *strategy, PageClass page_class) {
+    uint64_t misses_before = bpm->get_stats().get(BufferStat::MISS);
+    bpm->fetch_page(page_id, strategy, page_class);
+    bpm->unpin_page(page_id, false);
+    return bpm->get_stats().get(BufferStat::MISS) != misses_before;
+}
+
+/**
+ * @description: 运行一轮测试。索引文件中页号0是根结点，[1, fanout]是内部结点，之后是fanout * fanout个叶子
+ */
+static RunResult run_once(DiskManager *disk_manager, const std::string &replacer_type, size_t pool_size, int fanout,
+                          int index_fd, int heap_fd, int heap_pages, int scan_fd, int scan_pages, int num_lookups,
+                          int scan_step, bool use_hints) {
+    BufferPoolManager bpm(pool_size, disk_manager, BUFFER_POOL_INSTANCES, replacer_type);
+    PageClass inner_class = use_hints ? PageClass::INDEX_INNER : PageClass::HEAP;
+    PageClass leaf_class = use_hints ? PageClass::INDEX_LEAF : PageClass::HEAP;
+    PageClass scan_class = use_hints ? PageClass::SCAN : PageClass::HEAP;
+    int num_leaves = fanout * fanout;
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> leaf_dist(0, num_leaves - 1);
+    std::uniform_int_distribution<int> heap_dist(0, heap_pages - 1);
+
+    // 预热：先跑一轮点查，使缓冲池达到稳定状态
+    uint64_t misses = 0;
+    uint64_t inner_misses = 0;
+    int scan_cursor = 0;
+    for (int round = 0; round < 2; round++) {
+        misses = 0;
+        inner_misses = 0;
+        for (int i = 0; i < num_lookups; i++) {
+            int leaf = leaf_dist(rng);
+            bool miss = access(&bpm, {index_fd, 0}, nullptr, inner_class);
+            miss += access(&bpm, {index_fd, 1 + leaf / fanout}, nullptr, inner_class);
+            inner_misses += miss;
+            misses += miss;
+            misses += access(&bpm, {index_fd, 1 + fanout + leaf}, nullptr, leaf_class);
+            misses += access(&bpm, {heap_fd, heap_dist(rng)}, nullptr, PageClass::HEAP);
+            for (int k = 0; k < scan_step; k++) {
+                access(&bpm, {scan_fd, scan_cursor}, nullptr, scan_class);
+                scan_cursor = (scan_cursor + 1) % scan_pages;
+            }
+        }
+    }
+    return {static_cast<double>(misses) / num_lookups, static_cast<double>(inner_misses) / num_lookups};
+}
+
+int main(int argc, char **argv) {
+    size_t pool_size = argc > 1 ? atol(argv[1]) : 1024;
+    int fanout = argc > 2 ? atoi(argv[2]) : 64;
+    int heap_pages = argc > 3 ? atoi(argv[3]) : 16384;
+    int num_lookups = argc > 4 ? atoi(argv[4]) : 50000;
+    int scan_step = argc > 5 ? atoi(argv[5]) : 2;
+    std::vector<std::string> replacer_types;
+    for (int i = 6; i < argc; i++) {
+        replacer_types.push_back(argv[i]);
+    }
+    if (replacer_types.empty()) {
+        replacer_types = {"CLOCK", "CLOCK-LF", "LRU-K"};
+    }
+    int index_pages = 1 + fanout + fanout * fanout;
+    int scan_pages = heap_pages;
+
+    DiskManager *disk_manager = new DiskManager();
+    int index_fd = prepare_file(disk_manager, INDEX_FILE_NAME, index_pages);
+    int heap_fd = prepare_file(disk_manager, HEAP_FILE_NAME, heap_pages);
+    int scan_fd = prepare_file(disk_manager, SCAN_FILE_NAME, scan_pages);
+
+    printf("pool_size=%zu, fanout=%d (%d inner pages, %d leaves), heap_pages=%d, lookups=%d, %d scan pages per lookup\n",
+           pool_size, fanout, 1 + fanout, fanout * fanout, heap_pages, num_lookups, scan_step);
+    printf("%10s %8s %18s %24s\n", "replacer", "hints", "misses/lookup", "inner misses/lookup");
+    for (const auto &replacer_type : replacer_types) {
+        for (bool use_hints : {false, true}) {
+            RunResult result = run_once(disk_manager, replacer_type, pool_size, fanout, index_fd, heap_fd, heap_pages,
+                                        scan_fd, scan_pages, num_lookups, scan_step, use_hints);
+            printf("%10s %8s %18.3f %24.3f\n", replacer_type.c_str(), use_hints ? "on" : "off",
+                   result.misses_per_lookup, result.inner_misses_per_lookup);
+        }
+    }
+
+    disk_manager->close_file(index_fd);
+    disk_manager->destroy_file(INDEX_FILE_NAME);
+    disk_manager->close_file(heap_fd);
+    disk_manager->destroy_file(HEAP_FILE_NAME);
+    disk_manager->close_file(scan_fd);
+    disk_manager->destroy_file(SCAN_FILE_NAME);
+    delete disk_manager;
+    return 0;
+}
@@ -0,0 +1,133 @@
+/**
+ * 只读映射测试
+ *
+ * 创建一个 num_records 条记录的表文件，分别用普通打开（页面经过缓冲池）和只读打开（页面直接从 DiskManager 的只读映射中读取），
+ * 统计 RmScan 全表扫描每条记录调用一次 get_record 的吞吐量，以及随机 get_record 点查的吞吐量。
+ * 冷扫描之前用 posix_fadvise(POSIX_FADV_DONTNEED) 丢弃文件在页缓存中的内容，热扫描在冷扫描之后立即再扫描一遍。
+ *
+ * 用法: mmap_scan_bench [num_records] [pool_size] [num_lookups]
+ */
+#include <fcntl.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "record/rm_file_handle.h"
+#include "record/rm_scan.h"
+#include "storage/buffer_pool_manager.h"
+#include "storage/disk_manager.h"
+
+static const std::string BENCH_FILE_NAME = "mmap_scan_bench.db";
+static constexpr int RECORD_SIZE = 128;
+
+/**
+ * @description: 创建表文件：直接写入文件头，再通过RmFileHandle插入记录，每条记录以它的序号开头
+ * @return {vector<Rid>} 所有记录的位置
+ */
+static std::vector<Rid> prepare_table(DiskManager *disk_manager, int num_records) {
+    if (disk_manager->is_file(BENCH_FILE_NAME)) {
+        disk_manager->destroy_file(BENCH_FILE_NAME);
+    }
+    disk_manager->create_file(BENCH_FILE_NAME);
+    int fd = disk_manager->open_file(BENCH_FILE_NAME);
+    RmFileHdr file_hdr{};
+    file_hdr.record_size = RECORD_SIZE;
+    file_hdr.num_pages = 1;
+    file_hdr.first_free_page_no = RM_NO_PAGE;
+    file_hdr.num_records_per_page =
+        (BITMAP_WIDTH * (PAGE_SIZE - 1 - (int)sizeof(RmPageHdr) - Page::OFFSET_PAGE_HDR)) / (1 + RECORD_SIZE * BITMAP_WIDTH);
+    file_hdr.bitmap_size = (file_hdr.num_records_per_page + BITMAP_WIDTH - 1) / BITMAP_WIDTH;
+    disk_manager->write_page(fd, RM_FILE_HDR_PAGE, (char *)&file_hdr, sizeof(file_hdr));
+
+    std::vector<Rid> rids;
+    {
+        BufferPoolManager bpm(1024, disk_manager);
+        RmFileHandle file_handle(disk_manager, &bpm, fd);
+        char buf[RECORD_SIZE] = {};
+        for (int i = 0; i < num_records; i++) {
+            memcpy(buf, &i, sizeof(int));
+            rids.push_back(file_handle.insert_record(buf, nullptr));
+        }
+        bpm.flush_all_pages(fd);
+        file_hdr = file_handle.get_file_hdr();
+        disk_manager->write_page(fd, RM_FILE_HDR_PAGE, (char *)&file_hdr, sizeof(file_hdr));
+    }
+    fsync(fd);
+    disk_manager->close_file(fd);
+    return rids;
+}
+
+/**
+ * @description: 全表扫描并读出每条记录，检查记录的顺序
+ * @return {double} 耗时（秒）
+ */
+static double run_scan(RmFileHandle *file_handle, int num_records) {
+    auto start = std::chrono::steady_clock::now();
+    int count = 0;
+    for (RmScan scan(file_handle); !scan.is_end(); scan.next()) {
+        std::unique_ptr<RmRecord> record = file_handle->get_record(scan.rid(), nullptr);
+        if (memcmp(record->data, &count, sizeof(int)) != 0) {
+            printf("record %d: wrong content\n", count);
+            exit(1);
+        }
+        count++;
+    }
+    if (count != num_records) {
+        printf("scanned %d of %d records\n", count, num_records);
+        exit(1);
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @description: 随机点查
+ * @return {double} 耗时（秒）
+ */
+static double run_lookups(RmFileHandle *file_handle, const std::vector<Rid> &rids, int num_lookups) {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> dist(0, rids.size() - 1);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_lookups; i++) {
+        int id = dist(rng);
+        std::unique_ptr<RmRecord> record = file_handle->get_record(rids[id], nullptr);
+        if (memcmp(record->data, &id, sizeof(int)) != 0) {
+            printf("record %d: wrong content\n", id);
+            exit(1);
+        }
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char **argv) {
+    int num_records = argc > 1 ? atoi(argv[1]) : 1000000;
+    size_t pool_size = argc > 2 ? atol(argv[2]) : 4096;
+    int num_lookups = argc > 3 ? atoi(argv[3]) : 1000000;
+
+    DiskManager *disk_manager = new DiskManager();
+    std::vector<Rid> rids = prepare_table(disk_manager, num_records);
+    double mb = static_cast<double>(disk_manager->get_file_size(BENCH_FILE_NAME)) / (1024 * 1024);
+    printf("num_records=%d (%.1f MB), pool_size=%zu, lookups=%d\n", num_records, mb, pool_size, num_lookups);
+    printf("%12s %16s %16s %16s %16s\n", "mode", "cold scan MB/s", "warm scan MB/s", "lookups/s", "pool misses");
+
+    for (bool read_only : {false, true}) {
+        int fd = disk_manager->open_file(BENCH_FILE_NAME);
+        BufferPoolManager bpm(pool_size, disk_manager);
+        RmFileHandle file_handle(disk_manager, &bpm, fd, read_only);
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        double cold_seconds = run_scan(&file_handle, num_records);
+        double warm_seconds = run_scan(&file_handle, num_records);
+        double lookup_seconds = run_lookups(&file_handle, rids, num_lookups);
+        printf("%12s %16.1f %16.1f %16.0f %16lu\n", read_only ? "mmap" : "buffered", mb / cold_seconds,
+               mb / warm_seconds, num_lookups / lookup_seconds, static_cast<unsigned long>(bpm.get_fetch_misses()));
+        disk_manager->close_file(fd);
+    }
+
+    disk_manager->destroy_file(BENCH_FILE_NAME);
+    delete disk_manager;
+    return 0;
+}
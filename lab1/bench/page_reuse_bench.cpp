@@ -0,0 +1,156 @@
+/**
+ * 空闲页面重用测试
+ *
+ * 创建一个 num_records 条记录的表文件，按插入顺序删除最早的和最新的记录，只保留中间 keep_percent% 的记录，
+ * 再插入和最早的记录同样多的新记录。每个阶段之后写回所有页面，统计数据文件的大小、扫描范围内的页面数、
+ * 文件空闲页面列表中的页面数，以及丢弃页缓存之后一次全表扫描的耗时。
+ * 删除产生的空页面归还给文件：末尾的空页面被截掉，文件变小；中间的空页面被扫描跳过，之后插入时重用，文件不再增长。
+ * 删除之后再模拟事务回滚：用insert_record(rid, buf)把第一个和最后一个页面上被删除的记录写回原位置，
+ * 这两个页面已经被归还（最后一个页面被截掉），写回时要重新占用它们；之后检查这些记录在重用空页面的插入之后仍然完好。
+ *
+ * 用法: page_reuse_bench [num_records] [keep_percent] [pool_size]
+ */
+#include <fcntl.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "record/rm_file_handle.h"
+#include "record/rm_scan.h"
+#include "storage/buffer_pool_manager.h"
+#include "storage/disk_manager.h"
+
+static const std::string BENCH_FILE_NAME = "page_reuse_bench.db";
+static constexpr int RECORD_SIZE = 128;
+
+/**
+ * @description: 创建只有文件头的表文件
+ * @return {int} 表文件的文件句柄
+ */
+static int prepare_file(DiskManager *disk_manager) {
+    if (disk_manager->is_file(BENCH_FILE_NAME)) {
+        disk_manager->destroy_file(BENCH_FILE_NAME);
+    }
+    disk_manager->create_file(BENCH_FILE_NAME);
+    int fd = disk_manager->open_file(BENCH_FILE_NAME);
+    RmFileHdr file_hdr{};
+    file_hdr.record_size = RECORD_SIZE;
+    file_hdr.num_pages = 1;
+    file_hdr.first_free_page_no = RM_NO_PAGE;
+    file_hdr.num_records_per_page =
+        (BITMAP_WIDTH * (PAGE_SIZE - 1 - (int)sizeof(RmPageHdr) - Page::OFFSET_PAGE_HDR)) / (1 + RECORD_SIZE * BITMAP_WIDTH);
+    file_hdr.bitmap_size = (file_hdr.num_records_per_page + BITMAP_WIDTH - 1) / BITMAP_WIDTH;
+    disk_manager->write_page(fd, RM_FILE_HDR_PAGE, (char *)&file_hdr, sizeof(file_hdr));
+    return fd;
+}
+
+/**
+ * @description: 写回所有页面并丢弃页缓存，然后全表扫描并读出每条记录
+ * @return {double} 扫描的耗时（秒）
+ */
+static double run_cold_scan(BufferPoolManager *bpm, RmFileHandle *file_handle, int fd, int expected_records) {
+    bpm->flush_all_pages(fd);
+    fsync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    auto start = std::chrono::steady_clock::now();
+    int count = 0;
+    for (RmScan scan(file_handle); !scan.is_end(); scan.next()) {
+        file_handle->get_record(scan.rid(), nullptr);
+        count++;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (count != expected_records) {
+        printf("scanned %d of %d records\n", count, expected_records);
+        exit(1);
+    }
+    return seconds;
+}
+
+/**
+ * @description: 检查写回原位置的记录内容，内容不对时退出
+ */
+static void verify_restored(RmFileHandle *file_handle, const std::vector<Rid> &rids, const std::vector<int> &restored) {
+    for (int i : restored) {
+        auto record = file_handle->get_record(rids[i], nullptr);
+        if (memcmp(record->data, &i, sizeof(int)) != 0) {
+            printf("record %d at page %d slot %d was not restored\n", i, rids[i].page_no, rids[i].slot_no);
+            exit(1);
+        }
+    }
+}
+
+static void report(const char *stage, DiskManager *disk_manager, BufferPoolManager *bpm, RmFileHandle *file_handle,
+                   int fd, int num_records) {
+    double seconds = run_cold_scan(bpm, file_handle, fd, num_records);
+    double mb = static_cast<double>(disk_manager->get_file_size(BENCH_FILE_NAME)) / (1024 * 1024);
+    printf("%24s %12d %12.1f %12d %12zu %16.1f\n", stage, num_records, mb, file_handle->get_file_hdr().num_pages,
+           disk_manager->get_num_free_pages(fd), seconds * 1000);
+}
+
+int main(int argc, char **argv) {
+    int num_records = argc > 1 ? atoi(argv[1]) : 1000000;
+    int keep_percent = argc > 2 ? atoi(argv[2]) : 10;
+    size_t pool_size = argc > 3 ? atol(argv[3]) : 1024;
+
+    DiskManager *disk_manager = new DiskManager();
+    int fd = prepare_file(disk_manager);
+    BufferPoolManager bpm(pool_size, disk_manager);
+    RmFileHandle file_handle(disk_manager, &bpm, fd);
+    printf("num_records=%d, keep=%d%%, pool_size=%zu\n", num_records, keep_percent, pool_size);
+    printf("%24s %12s %12s %12s %12s %16s\n", "stage", "records", "file MB", "scan pages", "free pages",
+           "cold scan ms");
+
+    std::vector<Rid> rids;
+    char buf[RECORD_SIZE] = {};
+    for (int i = 0; i < num_records; i++) {
+        memcpy(buf, &i, sizeof(int));
+        rids.push_back(file_handle.insert_record(buf, nullptr));
+    }
+    report("loaded", disk_manager, &bpm, &file_handle, fd, num_records);
+
+    // 删除最早的和最新的记录，保留中间的keep_percent%
+    int num_deleted_head = num_records * (100 - keep_percent) / 200;
+    int keep_end = num_deleted_head + num_records * keep_percent / 100;
+    for (int i = 0; i < num_records; i++) {
+        if (i < num_deleted_head || i >= keep_end) {
+            file_handle.delete_record(rids[i], nullptr);
+        }
+    }
+    file_handle.release_empty_pages();
+    int num_kept = keep_end - num_deleted_head;
+    report("deleted", disk_manager, &bpm, &file_handle, fd, num_kept);
+
+    // 回滚第一个和最后一个页面上的删除
+    page_id_t first_page_no = rids.front().page_no;
+    page_id_t last_page_no = rids.back().page_no;
+    printf("page %d free: %d, page %d beyond file: %d\n", first_page_no,
+           disk_manager->is_page_free(fd, first_page_no), last_page_no,
+           last_page_no >= disk_manager->get_fd2pageno(fd));
+    std::vector<int> restored;
+    for (int i = 0; i < num_records; i++) {
+        if ((i < num_deleted_head || i >= keep_end) &&
+            (rids[i].page_no == first_page_no || rids[i].page_no == last_page_no)) {
+            memcpy(buf, &i, sizeof(int));
+            file_handle.insert_record(rids[i], buf);
+            restored.push_back(i);
+        }
+    }
+    verify_restored(&file_handle, rids, restored);
+    int num_restored = static_cast<int>(restored.size());
+    report("rolled back", disk_manager, &bpm, &file_handle, fd, num_kept + num_restored);
+
+    for (int i = 0; i < num_deleted_head; i++) {
+        file_handle.insert_record(buf, nullptr);
+    }
+    verify_restored(&file_handle, rids, restored);
+    report("reinserted", disk_manager, &bpm, &file_handle, fd, num_kept + num_restored + num_deleted_head);
+
+    disk_manager->close_file(fd);
+    disk_manager->destroy_file(BENCH_FILE_NAME);
+    delete disk_manager;
+    return 0;
+}
@@ -0,0 +1,163 @@
+/**
+ * 缓冲池命中延迟测试
+ *
+ * 所有页面常驻缓冲池，多个线程随机地 fetch_page + unpin_page，统计每次命中的平均延迟（纳秒）。
+ * 对比对象是原来的命中路径：每个分区一把 latch_ 保护 unordered_map 页表和 pin_count，
+ * 这里用同样分区个数的 LatchedPageTable 模拟；缓冲池分别使用 LRU 和无锁的 CLOCK-LF 置换策略。
+ *
+ * 用法: page_table_bench [num_pages] [seconds_per_run]
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "bench_util.h"
+#include "storage/buffer_pool_manager.h"
+#include "storage/disk_manager.h"
+
+static const std::string BENCH_FILE_NAME = "page_table_bench.db";
+
+/**
+ * 原来的命中路径：按PageId哈希选择分区，在分区的latch_内查页表并增加pin_count
+ */
+class LatchedPageTable {
+   public:
+    explicit LatchedPageTable(int fd, int num_pages) : partitions_(BUFFER_POOL_INSTANCES) {
+        for (int i = 0; i < num_pages; i++) {
+            PageId page_id = {fd, i};
+            Partition &partition = partition_of(page_id);
+            frame_id_t frame_id = static_cast<frame_id_t>(partition.pin_counts.size());
+            partition.page_table[page_id] = frame_id;
+            partition.pin_counts.push_back(0);
+        }
+    }
+
+    bool fetch(PageId page_id) {
+        Partition &partition = partition_of(page_id);
+        std::scoped_lock lock{partition.latch};
+        auto it = partition.page_table.find(page_id);
+        if (it == partition.page_table.end()) {
+            return false;
+        }
+        partition.pin_counts[it->second]++;
+        return true;
+    }
+
+    void unpin(PageId page_id) {
+        Partition &partition = partition_of(page_id);
+        std::scoped_lock lock{partition.latch};
+        partition.pin_counts[partition.page_table.at(page_id)]--;
+    }
+
+   private:
+    struct Partition {
+        std::mutex latch;
+        std::unordered_map<PageId, frame_id_t, PageIdHash> page_table;
+        std::vector<int> pin_counts;
+    };
+
+    Partition &partition_of(PageId page_id) { return partitions_[PageIdHash()(page_id) % partitions_.size()]; }
+
+    std::vector<Partition> partitions_;
+};
+
+/**
+ * @description: 多个线程随机地对num_pages个页面执行access，运行seconds秒
+ * @return {double} 每次访问的平均延迟（纳秒）
+ */
+template <typename AccessFn>
+static double measure(int num_pages, int num_threads, double seconds, AccessFn access) {
+    std::atomic<bool> stop{false};
+    std::vector<uint64_t> ops(num_threads, 0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&, t]() {
+            std::mt19937 rng(t + 1);
+            std::uniform_int_distribution<int> dist(0, num_pages - 1);
+            uint64_t local_ops = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                for (int k = 0; k < 64; k++) {
+                    access(dist(rng));
+                }
+                local_ops += 64;
+            }
+            ops[t] = local_ops;
+        });
+    }
+    auto start = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    stop = true;
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    uint64_t total = 0;
+    for (auto n : ops) {
+        total += n;
+    }
+    // 每个线程在elapsed内完成ops[t]次访问，平均延迟 = 线程数 * 时间 / 总次数
+    return total == 0 ? 0 : elapsed * num_threads * 1e9 / total;
+}
+
+/**
+ * @description: 在缓冲池上测试一轮，所有页面预先读入，测试过程中只有命中
+ * @return {double} 每次fetch_page+unpin_page的平均延迟（纳秒）
+ */
+static double run_bpm(DiskManager *disk_manager, int fd, int num_pages, const std::string &replacer_type,
+                      int num_threads, double seconds) {
+    BufferPoolManager bpm(num_pages, disk_manager, BUFFER_POOL_INSTANCES, replacer_type);
+    for (int i = 0; i < num_pages; i++) {
+        PageId page_id = {fd, i};
+        bpm.fetch_page(page_id);
+        bpm.unpin_page(page_id, false);
+    }
+    double latency = measure(num_pages, num_threads, seconds, [&](int page_no) {
+        PageId page_id = {fd, page_no};
+        if (bpm.fetch_page(page_id) != nullptr) {
+            bpm.unpin_page(page_id, false);
+        }
+    });
+    if (bpm.get_fetch_misses() != static_cast<uint64_t>(num_pages)) {
+        fprintf(stderr, "warning: %lu misses during the run\n", (unsigned long)(bpm.get_fetch_misses() - num_pages));
+    }
+    return latency;
+}
+
+int main(int argc, char **argv) {
+    int num_pages = argc > 1 ? atoi(argv[1]) : 4096;
+    double seconds = argc > 2 ? atof(argv[2]) : 1.0;
+
+    DiskManager *disk_manager = new DiskManager();
+    int fd = prepare_file(disk_manager, BENCH_FILE_NAME, num_pages);
+
+    printf("pages=%d, partitions=%zu, %.1fs per run, %u hardware threads\n", num_pages,
+           (size_t)BUFFER_POOL_INSTANCES, seconds, std::thread::hardware_concurrency());
+    printf("%8s %16s %16s %16s\n", "threads", "latched (ns)", "LRU (ns)", "CLOCK-LF (ns)");
+    for (int num_threads = 1; num_threads <= 64; num_threads *= 2) {
+        LatchedPageTable latched(fd, num_pages);
+        double baseline = measure(num_pages, num_threads, seconds, [&](int page_no) {
+            PageId page_id = {fd, page_no};
+            if (latched.fetch(page_id)) {
+                latched.unpin(page_id);
+            }
+        });
+        double lru = run_bpm(disk_manager, fd, num_pages, "LRU", num_threads, seconds);
+        double clock_lf = run_bpm(disk_manager, fd, num_pages, "CLOCK-LF", num_threads, seconds);
+        printf("%8d %16.1f %16.1f %16.1f\n", num_threads, baseline, lru, clock_lf);
+    }
+
+    disk_manager->close_file(fd);
+    disk_manager->destroy_file(BENCH_FILE_NAME);
+    delete disk_manager;
+    return 0;
+}
@@ -0,0 +1,86 @@
+/**
+ * 顺序预读测试
+ *
+ * 顺序扫描一个不在操作系统页缓存中的文件（写入后用posix_fadvise丢弃页缓存），每个页面模拟work_us微秒的处理开销，
+ * 分别在不开启预读和开启预读时统计扫描耗时、前台未命中次数以及预读的命中和浪费次数。
+ *
+ * 用法: read_ahead_bench [num_pages] [pool_size] [work_us] [window]
+ */
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "bench_util.h"
+#include "storage/buffer_pool_manager.h"
+#include "storage/disk_manager.h"
+
+static const std::string BENCH_FILE_NAME = "read_ahead_bench.db";
+
+/**
+ * @description: 模拟处理一个页面的开销
+ */
+static void busy_work(int work_us) {
+    auto end = std::chrono::steady_clock::now() + std::chrono::microseconds(work_us);
+    while (std::chrono::steady_clock::now() < end) {
+    }
+}
+
+static void run_once(DiskManager *disk_manager, int fd, int num_pages, size_t pool_size, int work_us,
+                     const ReadAheadConfig *config) {
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    BufferPoolManager bpm(pool_size, disk_manager);
+    if (config != nullptr) {
+        bpm.start_read_ahead(*config);
+    }
+    BufferAccessStrategy strategy;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_pages; i++) {
+        PageId page_id = {fd, i};
+        Page *page = bpm.fetch_page(page_id, &strategy);
+        int value;
+        memcpy(&value, page->get_data(), sizeof(int));
+        if (value != i) {
+            fprintf(stderr, "page %d has wrong content %d\n", i, value);
+            exit(1);
+        }
+        busy_work(work_us);
+        bpm.unpin_page(page_id, false);
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    bpm.stop_read_ahead();
+
+    printf("%10s %10.3f %10.1f %10lu %10lu %10lu %10lu\n", config != nullptr ? "on" : "off", elapsed,
+           num_pages * (PAGE_SIZE / 1024.0 / 1024.0) / elapsed, (unsigned long)bpm.get_fetch_misses(),
+           (unsigned long)bpm.get_prefetch_reads(), (unsigned long)bpm.get_prefetch_hits(),
+           (unsigned long)bpm.get_prefetch_wasted());
+}
+
+int main(int argc, char **argv) {
+    int num_pages = argc > 1 ? atoi(argv[1]) : 16384;
+    size_t pool_size = argc > 2 ? atol(argv[2]) : 1024;
+    int work_us = argc > 3 ? atoi(argv[3]) : 20;
+    ReadAheadConfig config;
+    if (argc > 4) {
+        config.window = atol(argv[4]);
+    }
+
+    DiskManager *disk_manager = new DiskManager();
+    int fd = prepare_file(disk_manager, BENCH_FILE_NAME, num_pages);
+
+    printf("pages=%d, pool_size=%zu, %dus work per page, window=%zu\n", num_pages, pool_size, work_us, config.window);
+    printf("%10s %10s %10s %10s %10s %10s %10s\n", "read-ahead", "seconds", "MB/s", "misses", "prefetched",
+           "pf hits", "pf wasted");
+    run_once(disk_manager, fd, num_pages, pool_size, work_us, nullptr);
+    run_once(disk_manager, fd, num_pages, pool_size, work_us, &config);
+
+    disk_manager->close_file(fd);
+    disk_manager->destroy_file(BENCH_FILE_NAME);
+    delete disk_manager;
+    return 0;
+}
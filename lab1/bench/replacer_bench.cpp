@@ -0,0 +1,71 @@
+/**
+ * 替换策略命中率测试
+ *
+ * 不经过磁盘，只用 Replacer 接口模拟一个容量为 pool_size 的缓冲池：
+ * 命中时 pin + unpin，未命中时先取空闲帧，没有空闲帧再调用 victim 淘汰。
+ *
+ * 负载为点查 + 周期性全表扫描的混合负载：
+ * - 点查按 Zipf 分布访问 num_pages 个页面中的热点
+ * - 每 scan_interval 次点查插入一次对全部 num_pages 个页面的顺序扫描
+ * 分别统计点查的命中率和总体命中率。
+ *
+ * 用法: replacer_bench [pool_size] [num_pages] [num_lookups] [scan_interval]
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "cache_simulator.h"
+#include "replacer/replacer_factory.h"
+
+struct PolicyResult {
+    uint64_t lookups = 0;
+    uint64_t lookup_hits = 0;
+    uint64_t accesses = 0;
+    uint64_t hits = 0;
+};
+
+static PolicyResult run_mixed(Replacer *replacer, size_t pool_size, int64_t num_pages, uint64_t num_lookups,
+                              uint64_t scan_interval) {
+    CacheSimulator sim(replacer, pool_size);
+    ZipfGenerator zipf(num_pages, 0.99, 42);
+    PolicyResult result;
+    for (uint64_t i = 0; i < num_lookups; i++) {
+        if (scan_interval != 0 && i % scan_interval == scan_interval / 2) {
+            for (int64_t page = 0; page < num_pages; page++) {
+                result.hits += sim.access(page);
+                result.accesses++;
+            }
+        }
+        bool hit = sim.access(zipf.next());
+        result.lookup_hits += hit;
+        result.hits += hit;
+        result.lookups++;
+        result.accesses++;
+    }
+    return result;
+}
+
+int main(int argc, char **argv) {
+    size_t pool_size = argc > 1 ? atol(argv[1]) : 1024;
+    int64_t num_pages = argc > 2 ? atol(argv[2]) : 16384;
+    uint64_t num_lookups = argc > 3 ? atol(argv[3]) : 1000000;
+    uint64_t scan_interval = argc > 4 ? atol(argv[4]) : 100000;
+
+    std::vector<std::pair<std::string, std::unique_ptr<Replacer>>> policies;
+    for (const char *type : {"LRU", "CLOCK", "CLOCK-LF", "LRU-2", "LRU-3", "ARC"}) {
+        policies.emplace_back(type, std::unique_ptr<Replacer>(create_replacer(type, pool_size)));
+    }
+
+    printf("pool_size=%zu, num_pages=%ld, lookups=%lu, full scan every %lu lookups\n", pool_size, num_pages,
+           num_lookups, scan_interval);
+    printf("%8s %14s %14s\n", "policy", "lookup hit %", "overall hit %");
+    for (auto &policy : policies) {
+        PolicyResult r = run_mixed(policy.second.get(), pool_size, num_pages, num_lookups, scan_interval);
+        printf("%8s %14.2f %14.2f\n", policy.first.c_str(), 100.0 * r.lookup_hits / r.lookups,
+               100.0 * r.hits / r.accesses);
+    }
+    return 0;
+}
@@ -0,0 +1,134 @@
+/**
+ * 缓冲池扩容/缩容测试
+ *
+ * 1 grow/shrink：缓冲池从 pool_size 个帧开始，把 num_pages 个页面的内容改写为“页号 + 轮次”并标记为脏页，
+ *   然后扩容到 max_pool_size、再缩容回 pool_size，每次调整后都读出全部页面检查内容，
+ *   确认缩容写回并移出的脏页没有丢失，同时统计每次 resize 的耗时。
+ * 2 固定着页面缩容：固定住缓冲池中的所有页面后缩容到一半，resize 应在 timeout_ms 左右返回 false，
+ *   缓冲池大小保持不变；解除固定后再缩容应当成功。
+ *
+ * 用法: resize_bench [num_pages] [pool_size] [max_pool_size] [rounds] [timeout_ms]
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "bench_util.h"
+#include "storage/buffer_pool_manager.h"
+#include "storage/disk_manager.h"
+
+static const std::string BENCH_FILE_NAME = "resize_bench.db";
+
+/**
+ * @description: 把每个页面第二个int改写为round并标记为脏页
+ */
+static bool write_round(BufferPoolManager *bpm, int fd, int num_pages, int round) {
+    for (int i = 0; i < num_pages; i++) {
+        PageId page_id = {fd, i};
+        Page *page = bpm->fetch_page(page_id);
+        if (page == nullptr) {
+            return false;
+        }
+        memcpy(page->get_data() + sizeof(int), &round, sizeof(int));
+        bpm->unpin_page(page_id, true);
+    }
+    return true;
+}
+
+/**
+ * @description: 检查每个页面的页号和轮次，返回内容不对的页面个数
+ */
+static int verify_round(BufferPoolManager *bpm, int fd, int num_pages, int round) {
+    int errors = 0;
+    for (int i = 0; i < num_pages; i++) {
+        PageId page_id = {fd, i};
+        Page *page = bpm->fetch_page(page_id);
+        if (page == nullptr) {
+            errors++;
+            continue;
+        }
+        if (memcmp(page->get_data(), &i, sizeof(int)) != 0 ||
+            memcmp(page->get_data() + sizeof(int), &round, sizeof(int)) != 0) {
+            errors++;
+        }
+        bpm->unpin_page(page_id, false);
+    }
+    return errors;
+}
+
+/**
+ * @description: 调用resize并返回耗时（毫秒）
+ */
+static double timed_resize(BufferPoolManager *bpm, size_t new_pool_size, int timeout_ms, bool *resized) {
+    auto start = std::chrono::steady_clock::now();
+    *resized = bpm->resize(new_pool_size, std::chrono::milliseconds(timeout_ms));
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char **argv) {
+    int num_pages = argc > 1 ? atoi(argv[1]) : 16384;
+    size_t pool_size = argc > 2 ? atol(argv[2]) : 4096;
+    size_t max_pool_size = argc > 3 ? atol(argv[3]) : 32768;
+    int rounds = argc > 4 ? atoi(argv[4]) : 4;
+    int timeout_ms = argc > 5 ? atoi(argv[5]) : 200;
+
+    DiskManager disk_manager;
+    int fd = prepare_file(&disk_manager, BENCH_FILE_NAME, num_pages);
+    BufferPoolManager bpm(pool_size, &disk_manager, BUFFER_POOL_INSTANCES, REPLACER_TYPE, max_pool_size);
+    printf("num_pages=%d, pool_size=%zu, max_pool_size=%zu, rounds=%d\n", num_pages, pool_size,
+           bpm.get_max_pool_size(), rounds);
+
+    int failed = 0;
+    printf("%8s %10s %12s %12s %10s\n", "round", "resize to", "resize ms", "pool_size", "errors");
+    for (int round = 1; round <= rounds; round++) {
+        if (!write_round(&bpm, fd, num_pages, round)) {
+            printf("round %d: fetch failed\n", round);
+            return 1;
+        }
+        for (size_t target : {bpm.get_max_pool_size(), pool_size}) {
+            bool resized;
+            double ms = timed_resize(&bpm, target, timeout_ms, &resized);
+            int errors = verify_round(&bpm, fd, num_pages, round);
+            printf("%8d %10zu %12.2f %12zu %10d\n", round, target, ms, bpm.get_pool_size(), errors);
+            if (!resized || bpm.get_pool_size() != target || errors != 0) {
+                failed++;
+            }
+        }
+    }
+
+    // 固定住缓冲池中的所有页面，缩容时超出范围的帧都无法空出来
+    std::vector<PageId> pinned;
+    for (int i = 0; i < num_pages && pinned.size() < pool_size; i++) {
+        PageId page_id = {fd, i};
+        if (bpm.fetch_page(page_id) == nullptr) {
+            break;
+        }
+        pinned.push_back(page_id);
+    }
+    bool resized;
+    double ms = timed_resize(&bpm, pool_size / 2, timeout_ms, &resized);
+    printf("shrink to %zu with %zu pinned pages: %s after %.1f ms (timeout %d ms), pool_size=%zu\n", pool_size / 2,
+           pinned.size(), resized ? "succeeded" : "gave up", ms, timeout_ms, bpm.get_pool_size());
+    if (resized || bpm.get_pool_size() <= pool_size / 2) {
+        failed++;
+    }
+    for (const PageId &page_id : pinned) {
+        bpm.unpin_page(page_id, false);
+    }
+    ms = timed_resize(&bpm, pool_size / 2, timeout_ms, &resized);
+    int errors = verify_round(&bpm, fd, num_pages, rounds);
+    printf("shrink to %zu after unpin: %s after %.1f ms, pool_size=%zu, errors=%d\n", pool_size / 2,
+           resized ? "succeeded" : "gave up", ms, bpm.get_pool_size(), errors);
+    if (!resized || bpm.get_pool_size() != pool_size / 2 || errors != 0) {
+        failed++;
+    }
+
+    bpm.flush_all_pages(fd);
+    disk_manager.close_file(fd);
+    disk_manager.destroy_file(BENCH_FILE_NAME);
+    printf("%d checks failed\n", failed);
+    return failed == 0 ? 0 : 1;
+}
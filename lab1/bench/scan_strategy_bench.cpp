@@ -0,0 +1,103 @@
+/**
+ * 顺序扫描访问策略测试
+ *
+ * 一个OLTP负载在oltp_pages个页面上做Zipf分布的点查，同时一个报表查询反复顺序扫描scan_pages个页面
+ * （每次点查之后扫描scan_step个页面）。分别统计以下三种情况下点查的缓冲池命中率：
+ * - 没有报表查询
+ * - 报表查询通过整个缓冲池扫描
+ * - 报表查询使用BufferAccessStrategy私有的环形缓冲区扫描
+ *
+ * 用法: scan_strategy_bench [pool_size] [oltp_pages] [scan_pages] [num_lookups] [scan_step]
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench_util.h"
+#include "storage/buffer_pool_manager.h"
+#include "storage/disk_manager.h"
+
+static const std::string OLTP_FILE_NAME = "scan_strategy_bench_oltp.db";
+static const std::string SCAN_FILE_NAME = "scan_strategy_bench_scan.db";
+
+enum class ScanMode { NONE, SHARED_POOL, RING };
+
+/**
+ * @description: 运行一轮测试
+ * @return {double} 点查的命中率
+ */
+static double run_once(DiskManager *disk_manager, size_t pool_size, int oltp_fd, int oltp_pages, int scan_fd,
+                       int scan_pages, int num_lookups, int scan_step, ScanMode mode) {
+    BufferPoolManager bpm(pool_size, disk_manager);
+    std::mt19937 rng(42);
+    // 点查按Zipf分布集中在少数热点页面上
+    std::vector<double> weights(oltp_pages);
+    for (int i = 0; i < oltp_pages; i++) {
+        weights[i] = 1.0 / std::pow(i + 1, 0.99);
+    }
+    std::discrete_distribution<int> zipf(weights.begin(), weights.end());
+
+    // 预热：所有OLTP页面装入缓冲池
+    for (int i = 0; i < oltp_pages; i++) {
+        PageId page_id = {oltp_fd, i};
+        bpm.fetch_page(page_id);
+        bpm.unpin_page(page_id, false);
+    }
+
+    BufferAccessStrategy strategy;
+    BufferAccessStrategy *scan_strategy = mode == ScanMode::RING ? &strategy : nullptr;
+    int scan_cursor = 0;
+    uint64_t lookup_hits = 0;
+    for (int i = 0; i < num_lookups; i++) {
+        PageId page_id = {oltp_fd, zipf(rng)};
+        uint64_t hits_before = bpm.get_fetch_hits();
+        bpm.fetch_page(page_id);
+        lookup_hits += bpm.get_fetch_hits() - hits_before;
+        bpm.unpin_page(page_id, false);
+
+        if (mode == ScanMode::NONE) {
+            continue;
+        }
+        for (int k = 0; k < scan_step; k++) {
+            PageId scan_page_id = {scan_fd, scan_cursor};
+            bpm.fetch_page(scan_page_id, scan_strategy);
+            bpm.unpin_page(scan_page_id, false);
+            scan_cursor = (scan_cursor + 1) % scan_pages;
+        }
+    }
+    return 100.0 * lookup_hits / num_lookups;
+}
+
+int main(int argc, char **argv) {
+    size_t pool_size = argc > 1 ? atol(argv[1]) : 1024;
+    int oltp_pages = argc > 2 ? atoi(argv[2]) : 768;
+    int scan_pages = argc > 3 ? atoi(argv[3]) : 8192;
+    int num_lookups = argc > 4 ? atoi(argv[4]) : 100000;
+    int scan_step = argc > 5 ? atoi(argv[5]) : 4;
+
+    DiskManager *disk_manager = new DiskManager();
+    int oltp_fd = prepare_file(disk_manager, OLTP_FILE_NAME, oltp_pages);
+    int scan_fd = prepare_file(disk_manager, SCAN_FILE_NAME, scan_pages);
+
+    printf("pool_size=%zu, oltp_pages=%d, scan_pages=%d, lookups=%d, %d scan pages per lookup\n", pool_size,
+           oltp_pages, scan_pages, num_lookups, scan_step);
+    printf("%24s %14s\n", "report query", "lookup hit %");
+    printf("%24s %14.2f\n", "none", run_once(disk_manager, pool_size, oltp_fd, oltp_pages, scan_fd, scan_pages,
+                                             num_lookups, scan_step, ScanMode::NONE));
+    printf("%24s %14.2f\n", "scan via shared pool", run_once(disk_manager, pool_size, oltp_fd, oltp_pages, scan_fd,
+                                                             scan_pages, num_lookups, scan_step, ScanMode::SHARED_POOL));
+    printf("%24s %14.2f\n", "scan via ring strategy", run_once(disk_manager, pool_size, oltp_fd, oltp_pages, scan_fd,
+                                                               scan_pages, num_lookups, scan_step, ScanMode::RING));
+
+    disk_manager->close_file(oltp_fd);
+    disk_manager->destroy_file(OLTP_FILE_NAME);
+    disk_manager->close_file(scan_fd);
+    disk_manager->destroy_file(SCAN_FILE_NAME);
+    delete disk_manager;
+    return 0;
+}
@@ -0,0 +1,164 @@
+/**
+ * 页面访问序列回放测试
+ *
+ * 把页面访问序列（trace）在每一种置换策略、每一种缓冲池大小上回放，统计：
+ * - 命中率
+ * - 每次 victim 的平均耗时（纳秒）
+ * - 回放吞吐量（每秒访问次数）
+ * 用于根据实际负载选择置换策略，选好的策略名称可以直接传给 BufferPoolManager 的构造函数。
+ *
+ * 内置三种合成的访问序列：
+ * - zipf:  num_accesses 次按 Zipf(0.99) 分布的点查
+ * - scan:  对 num_pages 个页面反复做顺序扫描，共 num_accesses 次访问
+ * - mixed: Zipf 点查，每 num_accesses / 10 次点查插入一次全表扫描
+ * 另外可以给出任意多个记录下来的访问序列文件，文件每行一次访问，格式为 "page_no" 或 "fd page_no"，
+ * 空行和以 # 开头的行被忽略。
+ *
+ * 用法: trace_replay_bench [num_pages] [num_accesses] [pool_size,pool_size,...] [trace_file ...]
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "cache_simulator.h"
+#include "replacer/replacer_factory.h"
+
+struct Trace {
+    std::string name;
+    std::vector<int64_t> pages;     // (fd << 32) | page_no
+};
+
+static Trace make_zipf_trace(int64_t num_pages, uint64_t num_accesses) {
+    Trace trace{"zipf", {}};
+    ZipfGenerator zipf(num_pages, 0.99, 42);
+    trace.pages.reserve(num_accesses);
+    for (uint64_t i = 0; i < num_accesses; i++) {
+        trace.pages.push_back(zipf.next());
+    }
+    return trace;
+}
+
+static Trace make_scan_trace(int64_t num_pages, uint64_t num_accesses) {
+    Trace trace{"scan", {}};
+    trace.pages.reserve(num_accesses);
+    for (uint64_t i = 0; i < num_accesses; i++) {
+        trace.pages.push_back(static_cast<int64_t>(i % num_pages));
+    }
+    return trace;
+}
+
+static Trace make_mixed_trace(int64_t num_pages, uint64_t num_accesses) {
+    Trace trace{"mixed", {}};
+    ZipfGenerator zipf(num_pages, 0.99, 42);
+    uint64_t scan_interval = std::max<uint64_t>(1, num_accesses / 10);
+    trace.pages.reserve(num_accesses + num_pages * 10);
+    for (uint64_t i = 0; i < num_accesses; i++) {
+        if (i % scan_interval == scan_interval / 2) {
+            for (int64_t page = 0; page < num_pages; page++) {
+                trace.pages.push_back(page);
+            }
+        }
+        trace.pages.push_back(zipf.next());
+    }
+    return trace;
+}
+
+/**
+ * @description: 读取记录下来的访问序列文件
+ * @return {bool} 文件不能打开或格式错误时返回false
+ */
+static bool load_trace_file(const std::string &path, Trace *trace) {
+    std::ifstream in(path);
+    if (!in) {
+        return false;
+    }
+    trace->name = path;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream fields(line);
+        int64_t first;
+        int64_t second;
+        if (!(fields >> first)) {
+            return false;
+        }
+        if (fields >> second) {
+            trace->pages.push_back((first << 32) | static_cast<uint32_t>(second));
+        } else {
+            trace->pages.push_back(first);
+        }
+    }
+    return true;
+}
+
+struct ReplayResult {
+    double hit_ratio = 0;
+    double victim_ns = 0;       // 每次victim的平均耗时
+    double throughput = 0;      // 每秒访问次数
+};
+
+static ReplayResult replay(const Trace &trace, const std::string &replacer_type, size_t pool_size) {
+    std::unique_ptr<Replacer> replacer(create_replacer(replacer_type, pool_size));
+    CacheSimulator sim(replacer.get(), pool_size);
+    uint64_t hits = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int64_t page : trace.pages) {
+        hits += sim.access(page);
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    ReplayResult result;
+    result.hit_ratio = trace.pages.empty() ? 0 : static_cast<double>(hits) / trace.pages.size();
+    result.victim_ns = sim.get_victims() == 0 ? 0 : static_cast<double>(sim.get_victim_ns()) / sim.get_victims();
+    result.throughput = elapsed > 0 ? trace.pages.size() / elapsed : 0;
+    return result;
+}
+
+int main(int argc, char **argv) {
+    int64_t num_pages = argc > 1 ? atol(argv[1]) : 16384;
+    uint64_t num_accesses = argc > 2 ? atol(argv[2]) : 1000000;
+    std::vector<size_t> pool_sizes;
+    std::stringstream pool_arg(argc > 3 ? argv[3] : "256,1024,4096");
+    for (std::string size; std::getline(pool_arg, size, ',');) {
+        if (atol(size.c_str()) > 0) {
+            pool_sizes.push_back(atol(size.c_str()));
+        }
+    }
+
+    std::vector<Trace> traces;
+    traces.push_back(make_zipf_trace(num_pages, num_accesses));
+    traces.push_back(make_scan_trace(num_pages, num_accesses));
+    traces.push_back(make_mixed_trace(num_pages, num_accesses));
+    for (int i = 4; i < argc; i++) {
+        Trace trace;
+        if (!load_trace_file(argv[i], &trace)) {
+            fprintf(stderr, "cannot load trace file %s\n", argv[i]);
+            return 1;
+        }
+        traces.push_back(std::move(trace));
+    }
+
+    printf("num_pages=%ld, num_accesses=%lu (synthetic traces)\n", num_pages, num_accesses);
+    printf("%-12s %10s %10s %10s %14s %14s\n", "trace", "pool_size", "policy", "hit %", "victim (ns)",
+           "accesses/s");
+    for (const Trace &trace : traces) {
+        for (size_t pool_size : pool_sizes) {
+            for (std::string_view type : REPLACER_TYPES) {
+                std::string replacer_type(type);
+                ReplayResult r = replay(trace, replacer_type, pool_size);
+                printf("%-12s %10zu %10s %10.2f %14.1f %14.0f\n", trace.name.c_str(), pool_size,
+                       replacer_type.c_str(), 100.0 * r.hit_ratio, r.victim_ns, r.throughput);
+            }
+        }
+    }
+    return 0;
+}
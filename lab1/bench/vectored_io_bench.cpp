@@ -0,0 +1,120 @@
+/**
+ * 批量读写测试
+ *
+ * 在一个 num_pages 个页面的文件上统计读写页面的系统调用次数（DiskManager 读写延迟分布中记录的调用数，
+ * 每次 pread/preadv/pwrite/pwritev 记录一次）和耗时：
+ * - 不启用预读和启用不同窗口的顺序预读时，用 fetch_page 顺序扫描整个文件，每个页面模拟处理 work_us 微秒，
+ *   使预读线程能够跑在扫描的前面（不处理页面时扫描本身比预读线程被唤醒还快，几乎每个页面都由扫描自己读入）
+ * - 直接用 prefetch_pages 把整个文件读入缓冲池
+ * - 修改所有页面后用 flush_all_pages 写回
+ * 每轮读取之前用 posix_fadvise(POSIX_FADV_DONTNEED) 丢弃文件在页缓存中的内容，使读取尽量落到设备上。
+ *
+ * 用法: vectored_io_bench [num_pages] [pool_size] [work_us]
+ */
+#include <fcntl.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "bench_util.h"
+#include "storage/buffer_pool_manager.h"
+#include "storage/disk_manager.h"
+
+static const std::string BENCH_FILE_NAME = "vectored_io_bench.db";
+
+static void print_row(const char *name, uint64_t syscalls, double seconds) {
+    printf("%32s %12lu %12.2f\n", name, static_cast<unsigned long>(syscalls), seconds * 1000);
+}
+
+/**
+ * @description: 模拟处理一个页面，忙等work_us微秒
+ */
+static void process_page(int work_us) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(work_us);
+    while (std::chrono::steady_clock::now() < deadline) {
+    }
+}
+
+/**
+ * @description: 用fetch_page顺序扫描整个文件并检查页面内容，window为0时不启用预读
+ */
+static void run_scan(DiskManager *disk_manager, int fd, size_t pool_size, int num_pages, size_t window,
+                     int work_us) {
+    BufferPoolManager bpm(pool_size, disk_manager);
+    if (window > 0) {
+        ReadAheadConfig config;
+        config.window = window;
+        bpm.start_read_ahead(config);
+    }
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    uint64_t reads_before = disk_manager->get_read_latency().get_count();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_pages; i++) {
+        PageId page_id = {fd, i};
+        Page *page = bpm.fetch_page(page_id);
+        if (memcmp(page->get_data(), &i, sizeof(int)) != 0) {
+            printf("page %d: wrong content\n", i);
+            exit(1);
+        }
+        process_page(work_us);
+        bpm.unpin_page(page_id, false);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    bpm.stop_read_ahead();
+    std::string name = window > 0 ? "scan, read-ahead window " + std::to_string(window) : "scan, no read-ahead";
+    print_row(name.c_str(), disk_manager->get_read_latency().get_count() - reads_before, seconds);
+}
+
+/**
+ * @description: 用prefetch_pages读入整个文件，再修改所有页面并用flush_all_pages写回
+ */
+static void run_bulk(DiskManager *disk_manager, int fd, size_t pool_size, int num_pages) {
+    BufferPoolManager bpm(pool_size, disk_manager);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    uint64_t reads_before = disk_manager->get_read_latency().get_count();
+    auto start = std::chrono::steady_clock::now();
+    size_t loaded = bpm.prefetch_pages({fd, 0}, num_pages);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (loaded != static_cast<size_t>(num_pages)) {
+        printf("prefetch_pages loaded %zu of %d pages\n", loaded, num_pages);
+        exit(1);
+    }
+    print_row("prefetch_pages", disk_manager->get_read_latency().get_count() - reads_before, seconds);
+
+    for (int i = 0; i < num_pages; i++) {
+        PageId page_id = {fd, i};
+        Page *page = bpm.fetch_page(page_id);
+        page->get_data()[PAGE_SIZE - 1]++;
+        bpm.unpin_page(page_id, true);
+    }
+    uint64_t writes_before = disk_manager->get_write_latency().get_count();
+    start = std::chrono::steady_clock::now();
+    bpm.flush_all_pages(fd);
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    print_row("flush_all_pages", disk_manager->get_write_latency().get_count() - writes_before, seconds);
+}
+
+int main(int argc, char **argv) {
+    int num_pages = argc > 1 ? atoi(argv[1]) : 1000;
+    size_t pool_size = argc > 2 ? atol(argv[2]) : 2048;
+    int work_us = argc > 3 ? atoi(argv[3]) : 10;
+
+    DiskManager *disk_manager = new DiskManager();
+    int fd = prepare_file(disk_manager, BENCH_FILE_NAME, num_pages);
+
+    printf("num_pages=%d, pool_size=%zu, work_us=%d\n", num_pages, pool_size, work_us);
+    printf("%32s %12s %12s\n", "", "syscalls", "ms");
+    run_scan(disk_manager, fd, pool_size, num_pages, 0, work_us);
+    for (size_t window : {32, 128}) {
+        run_scan(disk_manager, fd, pool_size, num_pages, window, work_us);
+    }
+    run_bulk(disk_manager, fd, pool_size, num_pages);
+
+    disk_manager->close_file(fd);
+    disk_manager->destroy_file(BENCH_FILE_NAME);
+    delete disk_manager;
+    return 0;
+}
@@ -2,73 +2,213 @@
 #include <fcntl.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <exception>
 #include <list>
+#include <mutex>
 #include <unordered_map>
 #include <vector>
 
 #include "disk_manager.h"
 #include "errors.h"
 #include "page.h"
-#include "replacer/lru_replacer.h"
-#include "replacer/clock_replacer.h" 
-#include "replacer/replacer.h"
+#include "buffer_access_strategy.h"
+#include "buffer_pool_instance.h"
+#include "buffer_pool_warmer.h"
+#include "buffer_stats.h"
+#include "compressed_page_cache.h"
+#include "page_cleaner.h"
+#include "page_guard.h"
+#include "read_ahead.h"
+
+// 缓冲池默认的分区个数
+static constexpr size_t BUFFER_POOL_INSTANCES = 16;
+// 每个分区至少包含的帧数，帧数太少的缓冲池不再分区，避免小缓冲池被切得过碎
+static constexpr size_t MIN_FRAMES_PER_INSTANCE = 64;
+// flush_all_pages每批写回的最大页面数，一批中的页面在写回期间处于io_in_progress_状态
+static constexpr size_t FLUSH_BATCH_PAGES = 64;
+// prefetch_pages每次preadv读入的最大页面数，一批中的页面在读入期间处于io_in_progress_状态
+static constexpr size_t PREFETCH_BATCH_PAGES = 64;
+// 构造时没有指定最大帧数时，缓冲池在运行时最多扩容到初始帧数的倍数
+static constexpr size_t DEFAULT_MAX_POOL_GROWTH = 2;
+// resize缩容时等待超出范围的页面解除固定的默认时长，超时后只缩掉已经空出来的尾部
+static constexpr std::chrono::milliseconds DEFAULT_RESIZE_TIMEOUT{1000};
 
 class BufferPoolManager {
    private:
-    size_t pool_size_;      // buffer_pool中可容纳页面的个数，即帧的个数
-    Page *pages_;           // buffer_pool中的Page对象数组，在构造空间中申请内存空间，在析构函数中释放，大小为BUFFER_POOL_SIZE
-    std::unordered_map<PageId, frame_id_t, PageIdHash> page_table_; // 帧号和页面号的映射哈希表，用于根据页面的PageId定位该页面的帧编号
-    std::list<frame_id_t> free_list_;   // 空闲帧编号的链表
+    std::atomic<size_t> pool_size_;     // buffer_pool中可容纳页面的个数，即所有分区帧的个数之和，可以在运行时调整
+    size_t max_pool_size_;  // 运行时最多扩容到的帧数，各分区的帧号空间按它划分
+    size_t num_instances_;  // 分区的个数，构造后不再变化，否则页面所在的分区会改变
+    std::vector<BufferPoolInstance *> instances_;   // 各个分区，按PageId的哈希值选择
     DiskManager *disk_manager_;
-    Replacer *replacer_;    // buffer_pool的置换策略，当前赛题中为LRU置换策略
-    std::mutex latch_;      // 用于共享数据结构的并发控制
+    BufferStats stats_;                              // 所有分区共用的按线程分片的事件统计
+    CompressedPageCache compressed_cache_;           // 所有分区共用的压缩二级缓存，默认不启用
+    std::mutex alloc_latch_[BUFFER_POOL_INSTANCES];  // new_page分配页号和free_page归还页号时按fd分段加锁
+    PageCleaner *page_cleaner_ = nullptr;           // 后台刷脏线程，未启动时为nullptr
+    ReadAhead *read_ahead_ = nullptr;               // 预读线程，未启动时为nullptr
+    BufferPoolWarmer *warmer_ = nullptr;            // 预热线程，未启动时为nullptr
+    std::mutex resize_latch_;                        // 串行化resize
 
    public:
-    BufferPoolManager(size_t pool_size, DiskManager *disk_manager)
+    /**
+     * @param replacer_type 置换策略的名称，见replacer_factory.h，默认使用config.h中的REPLACER_TYPE；名称不支持时抛出InternalError
+     * @param max_pool_size 运行时resize最多扩容到的帧数，为0时取pool_size * DEFAULT_MAX_POOL_GROWTH
+     */
+    BufferPoolManager(size_t pool_size, DiskManager *disk_manager, size_t num_instances = BUFFER_POOL_INSTANCES,
+                      const std::string &replacer_type = REPLACER_TYPE, size_t max_pool_size = 0)
         : pool_size_(pool_size), disk_manager_(disk_manager) {
-        // 为buffer pool分配一块连续的内存空间
-        pages_ = new Page[pool_size_];
-        // 可以被Replacer改变
-        if (REPLACER_TYPE.compare("LRU"))
-            replacer_ = new LRUReplacer(pool_size_);
-        else if (REPLACER_TYPE.compare("CLOCK"))
-            replacer_ = new ClockReplacer(pool_size_);
-        else {
-            replacer_ = new LRUReplacer(pool_size_);
-        }
-        // 初始化时，所有的page都在free_list_中
-        for (size_t i = 0; i < pool_size_; ++i) {
-            free_list_.emplace_back(static_cast<frame_id_t>(i));  // static_cast转换数据类型
+        max_pool_size_ = max_pool_size == 0 ? pool_size * DEFAULT_MAX_POOL_GROWTH : std::max(pool_size, max_pool_size);
+        // 分区个数不超过 pool_size / MIN_FRAMES_PER_INSTANCE，且至少为1
+        num_instances_ = std::max<size_t>(1, std::min(num_instances, pool_size / MIN_FRAMES_PER_INSTANCE));
+        // 把帧平均分配到各个分区，余数分给前几个分区
+        try {
+            for (size_t i = 0; i < num_instances_; ++i) {
+                instances_.push_back(new BufferPoolInstance(instance_share(pool_size, i), instance_share(max_pool_size_, i),
+                                                            i, disk_manager_, &stats_, &compressed_cache_,
+                                                            replacer_type));
+            }
+        } catch (...) {
+            for (auto instance : instances_) {
+                delete instance;
+            }
+            throw;
         }
     }
 
     ~BufferPoolManager() {
-        delete[] pages_;
-        delete replacer_;
+        stop_warm_up();
+        stop_read_ahead();
+        stop_page_cleaner();
+        for (auto instance : instances_) {
+            delete instance;
+        }
     }
 
     /**
      * @description: 将目标页面标记为脏页
      * @param {Page*} page 脏页
      */
-    static void mark_dirty(Page* page) { page->is_dirty_ = true; }
+    void mark_dirty(Page* page) { get_instance(page->get_page_id())->mark_dirty(page); }
+
+    /**
+     * @description: 修改被固定的页面的类别，读出页面之后才能确定类别时使用（如B+树结点是否为叶子）
+     * @param {Page*} page 被固定的页面
+     * @param {PageClass} page_class 页面的类别
+     */
+    void set_page_class(Page* page, PageClass page_class) {
+        if (page->page_class_.load(std::memory_order_relaxed) != page_class) {
+            get_instance(page->get_page_id())->set_page_class(page, page_class);
+        }
+    }
+
+    size_t get_pool_size() const { return pool_size_; }
+
+    size_t get_max_pool_size() const { return max_pool_size_; }
+
+    size_t get_num_instances() const { return num_instances_; }
+
+    DiskManager *get_disk_manager() const { return disk_manager_; }
+
+    /**
+     * @description: 命中、未命中、淘汰、脏页写回和等待读写的次数，按文件和全局统计
+     */
+    const BufferStats &get_stats() const { return stats_; }
+
+    void reset_stats() { stats_.reset(); }
+
+    uint64_t get_pages_cleaned() const;
+
+    uint64_t get_foreground_write_backs() const;
+
+    uint64_t get_fetch_hits() const;
+
+    uint64_t get_fetch_misses() const;
+
+    uint64_t get_tier_hits() const;
+
+    uint64_t get_tier_misses() const;
+
+    /**
+     * @description: 压缩二级缓存，用于查看其中的页面数、占用的内存等
+     */
+    const CompressedPageCache &get_compressed_cache() const { return compressed_cache_; }
+
+    /**
+     * @description: 设置压缩二级缓存的内存预算，可以在运行时调整，缩小时立即丢弃超出的页面
+     * @param {size_t} capacity_bytes 内存预算（字节），为0时停用并清空
+     */
+    void set_compressed_cache_size(size_t capacity_bytes) { compressed_cache_.set_capacity(capacity_bytes); }
+
+    uint64_t get_prefetch_reads() const;
+
+    uint64_t get_prefetch_hits() const;
+
+    uint64_t get_prefetch_wasted() const;
+
+    size_t get_warm_up_pages_to_load() const;
+
+    size_t get_warm_up_pages_loaded() const;
 
-   public: 
-    Page* fetch_page(PageId page_id);
+   public:
+    Page* fetch_page(PageId page_id, BufferAccessStrategy *strategy = nullptr, PageClass page_class = PageClass::HEAP);
+
+    ReadPageGuard fetch_page_read(PageId page_id, BufferAccessStrategy *strategy = nullptr,
+                                  PageClass page_class = PageClass::HEAP);
+
+    WritePageGuard fetch_page_write(PageId page_id, PageClass page_class = PageClass::HEAP);
+
+    WritePageGuard new_page_write(PageId* page_id, PageClass page_class = PageClass::HEAP);
 
     bool unpin_page(PageId page_id, bool is_dirty);
 
     bool flush_page(PageId page_id);
 
-    Page* new_page(PageId* page_id);
+    Page* new_page(PageId* page_id, PageClass page_class = PageClass::HEAP);
 
     bool delete_page(PageId page_id);
 
+    bool free_page(PageId page_id);
+
+    WritePageGuard reclaim_page_write(PageId page_id, PageClass page_class = PageClass::HEAP);
+
     void flush_all_pages(int fd);
 
+    void start_page_cleaner(const PageCleanerConfig &config = PageCleanerConfig());
+
+    void stop_page_cleaner();
+
+    size_t clean_pages(const PageCleanerConfig &config);
+
+    void start_read_ahead(const ReadAheadConfig &config = ReadAheadConfig());
+
+    void stop_read_ahead();
+
+    bool prefetch_page(PageId page_id, BufferAccessStrategy *strategy = nullptr, char *copy_out = nullptr);
+
+    size_t prefetch_pages(PageId start, size_t count, BufferAccessStrategy *strategy = nullptr);
+
+    void read_ahead_chain(PageId start, size_t count, NextPageFn next_of);
+
+    bool resize(size_t new_pool_size, std::chrono::milliseconds timeout = DEFAULT_RESIZE_TIMEOUT);
+
+    std::vector<PageId> get_resident_pages();
+
+    void start_warm_up(const std::string &file_name, const WarmUpConfig &config = WarmUpConfig());
+
+    void stop_warm_up();
+
+    bool dump_resident_pages(const std::string &file_name, size_t max_pages = WarmUpConfig().max_pages);
+
    private:
-    bool find_victim_page(frame_id_t* frame_id);
+    // 把total个帧平均分配到各个分区时，第i个分区分到的帧数
+    size_t instance_share(size_t total, size_t i) const {
+        return total / num_instances_ + (i < total % num_instances_ ? 1 : 0);
+    }
 
-    void update_page(Page* page, PageId new_page_id, frame_id_t new_frame_id);
-};
\ No newline at end of file
+    BufferPoolInstance* get_instance(PageId page_id) {
+        return instances_[PageIdHash()(page_id) % num_instances_];
+    }
+};
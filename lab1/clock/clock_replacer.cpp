@@ -21,8 +21,9 @@ ClockReplacer::~ClockReplacer() = default;
  * 1. 如果没有可淘汰的帧，返回 false
  * 2. 时钟指针开始转圈：
  *    - 跳过不在 replacer 中的帧（被 pin 住的）
- *    - 如果 ref=false，淘汰该帧
+ *    - 如果 ref=false 且没有剩余的命数，淘汰该帧
  *    - 如果 ref=true，给"第二次机会"，将 ref 置为 false，继续转
+ *    - 如果 ref=false 但还有命数（索引结点），命数减一，继续转
  * 
  * @param[out] frame_id 被淘汰的帧的 id
  * @return 成功返回 true，否则返回 false
@@ -35,14 +36,14 @@ bool ClockReplacer::victim(frame_id_t* frame_id) {
         return false;
     }
     
-    // 最多转两整圈（第一圈可能把所有 ref 置为 false，第二圈找到目标）
-    size_t max_iterations = max_size_ * 2;
+    // 最多转 2 + MAX_EXTRA_LIVES 整圈（第一圈可能把所有 ref 置为 false，之后每圈把命数减一）
+    size_t max_iterations = max_size_ * (2 + MAX_EXTRA_LIVES);
     
     for (size_t i = 0; i < max_iterations; i++) {
         ClockFrame& frame = frames_[clock_hand_];
         
         if (frame.in_replacer) {
-            if (frame.ref == false) {
+            if (frame.ref == false && frame.lives == 0) {
                 // 找到了！淘汰这个帧
                 *frame_id = static_cast<frame_id_t>(clock_hand_);
                 frame.in_replacer = false;
@@ -50,9 +51,11 @@ bool ClockReplacer::victim(frame_id_t* frame_id) {
                 // 指针移动到下一个位置（为下次淘汰做准备）
                 clock_hand_ = (clock_hand_ + 1) % max_size_;
                 return true;
-            } else {
+            } else if (frame.ref) {
                 // 给"第二次机会"：ref 从 true 变成 false
                 frame.ref = false;
+            } else {
+                frame.lives--;
             }
         }
         
@@ -113,12 +116,63 @@ void ClockReplacer::unpin(frame_id_t frame_id) {
         return;
     }
     
-    // 加入 replacer，并设置 ref=true（刚被使用过，有"第一次机会"）
+    // 加入 replacer，并设置 ref=true（刚被使用过，有"第一次机会"），扫描读入的页面不给这次机会
     frame.in_replacer = true;
-    frame.ref = true;
+    frame.ref = frame.page_class != PageClass::SCAN;
+    frame.lives = PAGE_CLASS_EXTRA_LIVES[static_cast<size_t>(frame.page_class)];
     num_in_replacer_++;
 }
 
+/**
+ * @brief 记录帧中页面的类别
+ * @param frame_id 帧 id
+ * @param page_class 页面的类别
+ */
+void ClockReplacer::set_page_class(frame_id_t frame_id, PageClass page_class) {
+    std::scoped_lock lock{latch_};
+
+    // 边界检查
+    if (frame_id < 0 || static_cast<size_t>(frame_id) >= max_size_) {
+        return;
+    }
+
+    frames_[frame_id].page_class = page_class;
+}
+
+/**
+ * @brief 按淘汰顺序列出接下来最先被淘汰的帧，不改变 replacer 的状态
+ *
+ * 指针每经过一个帧，要么清零引用位，要么命数减一，帧被经过 ref + lives 次之后才会被淘汰。
+ * 从指针处转一圈按 ref + lives 分组，先列出为 0 的帧，再列出为 1 的帧，依此类推，组内按指针经过的顺序；
+ * 这是连续调用 victim 的近似顺序。为 0 的帧已经够 max_frames 个时提前结束
+ *
+ * @param max_frames 最多列出的帧数
+ * @param[out] frames 按淘汰顺序追加帧号
+ * @return 总是返回 true
+ */
+bool ClockReplacer::eviction_order(size_t max_frames, std::vector<frame_id_t> *frames) {
+    std::scoped_lock lock{latch_};
+
+    std::vector<std::vector<frame_id_t>> groups(2 + MAX_EXTRA_LIVES);
+    for (size_t i = 0; i < max_size_ && groups[0].size() < max_frames; i++) {
+        size_t hand = (clock_hand_ + i) % max_size_;
+        const ClockFrame &frame = frames_[hand];
+        if (frame.in_replacer) {
+            groups[frame.ref + frame.lives].push_back(static_cast<frame_id_t>(hand));
+        }
+    }
+    size_t listed = 0;
+    for (const auto &group : groups) {
+        for (frame_id_t frame_id : group) {
+            if (listed++ == max_frames) {
+                return true;
+            }
+            frames->push_back(frame_id);
+        }
+    }
+    return true;
+}
+
 /**
  * @brief 返回当前可以被淘汰的帧数量
  * @return 在 replacer 中的帧数量
@@ -18,6 +18,9 @@
  * 缺点：淘汰时最坏情况需要转一圈 O(n)
  * 
  * 实际数据库（如 PostgreSQL）广泛使用 CLOCK 及其变种
+ * 
+ * 页面类别（PageClass）决定帧的"命数"：引用位清零之后，B+树内部结点和叶子结点还能各多躲过
+ * PAGE_CLASS_EXTRA_LIVES 次扫描；扫描读入的页面 unpin 时不设置引用位，指针下一次经过就被淘汰
  */
 class ClockReplacer : public Replacer {
    public:
@@ -48,11 +51,26 @@ class ClockReplacer : public Replacer {
      */
     void unpin(frame_id_t frame_id) override;
 
+    /**
+     * @brief 按淘汰顺序列出接下来最先被淘汰的帧，不改变 replacer 的状态
+     * @param max_frames 最多列出的帧数
+     * @param[out] frames 按淘汰顺序追加帧号
+     * @return 总是返回 true
+     */
+    bool eviction_order(size_t max_frames, std::vector<frame_id_t> *frames) override;
+
     /**
      * @brief 返回当前可以被淘汰的帧数量
      */
     size_t Size() override;
 
+    /**
+     * @brief 记录帧中页面的类别，下一次 unpin 时按类别设置引用位和命数
+     * @param frame_id 帧 id
+     * @param page_class 页面的类别
+     */
+    void set_page_class(frame_id_t frame_id, PageClass page_class) override;
+
    private:
     /**
      * @brief 每个帧的状态
@@ -60,8 +78,10 @@ class ClockReplacer : public Replacer {
     struct ClockFrame {
         bool ref;          // 引用位：最近是否被访问过
         bool in_replacer;  // 是否在 replacer 中（可被淘汰）
+        uint8_t lives;     // 引用位清零之后还能躲过的扫描次数
+        PageClass page_class;  // 帧中页面的类别
         
-        ClockFrame() : ref(false), in_replacer(false) {}
+        ClockFrame() : ref(false), in_replacer(false), lives(0), page_class(PageClass::HEAP) {}
     };
 
     std::mutex latch_;                 // 互斥锁，保证线程安全
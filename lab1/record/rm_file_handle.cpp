@@ -1,5 +1,7 @@
 #include "rm_file_handle.h"
 
+#include <algorithm>
+
 /**
  * @description: 获取当前表中记录号为rid的记录
  * @param {Rid&} rid 记录号，指定记录的位置
@@ -10,11 +12,14 @@ std::unique_ptr<RmRecord> RmFileHandle::get_record(const Rid& rid, Context* cont
     // Todo:
     // 1. 获取指定记录所在的page handle
     // 2. 初始化一个指向RmRecord的指针（赋值其内部的data和size）
-    RmPageHandle page_handle = fetch_page_handle(rid.page_no);
+    if (read_only_) {
+        RmPageHandle page_handle(&file_hdr_, get_mapped_page(rid.page_no));
+        return std::make_unique<RmRecord>(file_hdr_.record_size, page_handle.get_slot(rid.slot_no));
+    }
+    ReadPageGuard page_guard = fetch_page_read(rid.page_no);
+    RmPageHandle page_handle(&file_hdr_, page_guard.get_page());
     char* slot = page_handle.get_slot(rid.slot_no);
-    auto record = std::make_unique<RmRecord>(file_hdr_.record_size, slot);
-    buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), false);
-    return record;
+    return std::make_unique<RmRecord>(file_hdr_.record_size, slot);
 }
 
 /**
@@ -30,31 +35,43 @@ Rid RmFileHandle::insert_record(char* buf, Context* context) {
     // 3. 将buf复制到空闲slot位置
     // 4. 更新page_handle.page_hdr中的数据结构
     // 注意考虑插入一条记录后页面已满的情况，需要更新file_hdr_.first_free_page_no
-    RmPageHandle page_handle = create_page_handle();
-    int slot_no = Bitmap::first_bit(false, page_handle.bitmap, file_hdr_.num_records_per_page);
-    char* slot = page_handle.get_slot(slot_no);
-    memcpy(slot, buf, file_hdr_.record_size);
-    Bitmap::set(page_handle.bitmap, slot_no);
+    // 只在取空闲页链表头、并在页面将被插满时把它从链表中摘除的期间持有file_hdr_latch_；
+    // 先在页面上占住一个位置，之后只持有页面写锁复制记录
+    std::unique_lock lock{file_hdr_latch_};
+    WritePageGuard page_guard = fetch_free_page();
+    RmPageHandle page_handle(&file_hdr_, page_guard.get_page());
     page_handle.page_hdr->num_records++;
     if (page_handle.page_hdr->num_records == file_hdr_.num_records_per_page) {
         file_hdr_.first_free_page_no = page_handle.page_hdr->next_free_page_no;
     }
-    buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), true);
-    return Rid{page_handle.page->get_page_id().page_no, slot_no};
+    lock.unlock();
+    int slot_no = Bitmap::first_bit(false, page_handle.bitmap, file_hdr_.num_records_per_page);
+    char* slot = page_handle.get_slot(slot_no);
+    memcpy(slot, buf, file_hdr_.record_size);
+    Bitmap::set(page_handle.bitmap, slot_no);
+    return Rid{page_guard.get_page_id().page_no, slot_no};
 }
 
 /**
- * @description: 在当前表中的指定位置插入一条记录
+ * @description: 在当前表中的指定位置插入一条记录，用于事务回滚删除操作。
+ *              删除可能已经让页面变空并被release_empty_pages归还（甚至从文件末尾截掉），这时先重新占用该页面
  * @param {Rid&} rid 要插入记录的位置
  * @param {char*} buf 要插入记录的数据
  */
 void RmFileHandle::insert_record(const Rid& rid, char* buf) {
-    RmPageHandle page_handle = fetch_page_handle(rid.page_no);
+    std::scoped_lock lock{file_hdr_latch_};
+    WritePageGuard page_guard = reclaim_page(rid.page_no);
+    if (page_guard.is_empty()) {
+        page_guard = fetch_page_write(rid.page_no);
+    }
+    RmPageHandle page_handle(&file_hdr_, page_guard.get_page());
     char* slot = page_handle.get_slot(rid.slot_no);
     memcpy(slot, buf, file_hdr_.record_size);
     Bitmap::set(page_handle.bitmap, rid.slot_no);
     page_handle.page_hdr->num_records++;
-    buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), true);
+    if (page_handle.page_hdr->num_records == file_hdr_.num_records_per_page) {
+        unlink_full_page(page_handle);
+    }
 }
 
 /**
@@ -67,15 +84,81 @@ void RmFileHandle::delete_record(const Rid& rid, Context* context) {
     // 1. 获取指定记录所在的page handle
     // 2. 更新page_handle.page_hdr中的数据结构
     // 注意考虑删除一条记录后页面未满的情况，需要调用release_page_handle()
-    RmPageHandle page_handle = fetch_page_handle(rid.page_no);
+    WritePageGuard page_guard = fetch_page_write(rid.page_no);
+    RmPageHandle page_handle(&file_hdr_, page_guard.get_page());
+    std::unique_lock<std::mutex> lock;
+    if (page_handle.page_hdr->num_records == file_hdr_.num_records_per_page) {
+        // 页面将从已满变为未满，要修改空闲页链表；按先file_hdr_latch_后页面写锁的顺序重新加锁，期间页面可能已经变化
+        page_guard.drop();
+        lock = std::unique_lock{file_hdr_latch_};
+        page_guard = fetch_page_write(rid.page_no);
+        page_handle = RmPageHandle(&file_hdr_, page_guard.get_page());
+    }
     bool was_full = (page_handle.page_hdr->num_records == file_hdr_.num_records_per_page);
     Bitmap::reset(page_handle.bitmap, rid.slot_no);
     page_handle.page_hdr->num_records--;
     if (was_full) {
         release_page_handle(page_handle);
     }
-    buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), true);
+    if (page_handle.page_hdr->num_records > 0 || ++num_empty_pages_ < RM_RELEASE_EMPTY_PAGES) {
+        return;
+    }
+    // 空页面积累到一定数量后归还给文件；遍历空闲页链表的代价和表的大小成正比，空页面相对表的大小足够多时才归还
+    page_guard.drop();
+    if (!lock.owns_lock()) {
+        lock = std::unique_lock{file_hdr_latch_};
+    }
+    if (num_empty_pages_ >= file_hdr_.num_pages / RM_EMPTY_PAGES_RATIO) {
+        release_empty_pages_locked();
+    }
+}
 
+/**
+ * @description: 把表中没有记录的页面归还给文件，之后插入记录时新页面优先重用它们，文件末尾的空页面被截掉
+ * @return {int} 归还的页面个数
+ */
+int RmFileHandle::release_empty_pages() {
+    std::scoped_lock lock{file_hdr_latch_};
+    return release_empty_pages_locked();
+}
+
+/**
+ * @description: 遍历空闲页链表，把没有记录的页面从链表中摘除并通过缓冲池归还给文件，调用时持有file_hdr_latch_。
+ *              归还之前先把空页面写回磁盘，并发的扫描即使在归还之后读到该页面，也只会读到没有记录的页面；
+ *              正被固定的页面不能从缓冲池中删除，留在链表中等下次归还
+ * @return {int} 归还的页面个数
+ */
+int RmFileHandle::release_empty_pages_locked() {
+    num_empty_pages_ = 0;
+    int num_released = 0;
+    WritePageGuard prev_guard;
+    page_id_t page_no = file_hdr_.first_free_page_no;
+    while (page_no != RM_NO_PAGE) {
+        WritePageGuard page_guard = fetch_page_write(page_no);
+        RmPageHandle page_handle(&file_hdr_, page_guard.get_page());
+        page_id_t next_page_no = page_handle.page_hdr->next_free_page_no;
+        bool released = false;
+        if (page_handle.page_hdr->num_records == 0) {
+            disk_manager_->write_page(fd_, page_no, page_guard.get_page()->get_data(), PAGE_SIZE);
+            page_guard.drop();
+            released = buffer_pool_manager_->free_page({fd_, page_no});
+        }
+        if (released) {
+            if (prev_guard.is_empty()) {
+                file_hdr_.first_free_page_no = next_page_no;
+            } else {
+                RmPageHandle(&file_hdr_, prev_guard.get_page()).page_hdr->next_free_page_no = next_page_no;
+            }
+            num_released++;
+        } else {
+            prev_guard = page_guard.is_empty() ? fetch_page_write(page_no) : std::move(page_guard);
+        }
+        page_no = next_page_no;
+    }
+    prev_guard.drop();
+    // 文件末尾的空页面已经被截掉，扫描的范围随之缩小
+    file_hdr_.num_pages = std::min(file_hdr_.num_pages, disk_manager_->get_fd2pageno(fd_));
+    return num_released;
 }
 
 
@@ -89,22 +172,21 @@ void RmFileHandle::update_record(const Rid& rid, char* buf, Context* context) {
     // Todo:
     // 1. 获取指定记录所在的page handle
     // 2. 更新记录
-    RmPageHandle page_handle = fetch_page_handle(rid.page_no);
+    WritePageGuard page_guard = fetch_page_write(rid.page_no);
+    RmPageHandle page_handle(&file_hdr_, page_guard.get_page());
     char* slot = page_handle.get_slot(rid.slot_no);
     memcpy(slot, buf, file_hdr_.record_size);
-    buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), true);
-
 }
 
 /**
  * 以下函数为辅助函数，仅提供参考，可以选择完成如下函数，也可以删除如下函数，在单元测试中不涉及如下函数接口的直接调用
 */
 /**
- * @description: 获取指定页面的页面句柄
+ * @description: 获取指定页面并加读锁
  * @param {int} page_no 页面号
- * @return {RmPageHandle} 指定页面的句柄
+ * @return {ReadPageGuard} 指定页面的guard，用于生成RmPageHandle
  */
-RmPageHandle RmFileHandle::fetch_page_handle(int page_no) const {
+ReadPageGuard RmFileHandle::fetch_page_read(int page_no) const {
     // Todo:
     // 使用缓冲池获取指定页面，并生成page_handle返回给上层
     // if page_no is invalid, throw PageNotExistError exception
@@ -112,57 +194,141 @@ RmPageHandle RmFileHandle::fetch_page_handle(int page_no) const {
         throw PageNotExistError("", page_no);
     }
     PageId page_id = {fd_, page_no};
-    Page* page = buffer_pool_manager_->fetch_page(page_id);
-    if (page == nullptr) {
+    ReadPageGuard page_guard = buffer_pool_manager_->fetch_page_read(page_id);
+    if (page_guard.is_empty()) {
         throw PageNotExistError("", page_no);
     }
-    return RmPageHandle(&file_hdr_, page);
+    return page_guard;
 }
 
 /**
- * @description: 创建一个新的page handle
- * @return {RmPageHandle} 新的PageHandle
+ * @description: 获取指定页面并加写锁
+ * @param {int} page_no 页面号
+ * @return {WritePageGuard} 指定页面的guard，用于生成RmPageHandle
  */
-RmPageHandle RmFileHandle::create_new_page_handle() {
+WritePageGuard RmFileHandle::fetch_page_write(int page_no) const {
+    if (read_only_) {
+        throw InternalError("RmFileHandle::fetch_page_write Error: table is opened read-only.");
+    }
+    if (page_no < 0 || page_no >= file_hdr_.num_pages) {
+        throw PageNotExistError("", page_no);
+    }
+    PageId page_id = {fd_, page_no};
+    WritePageGuard page_guard = buffer_pool_manager_->fetch_page_write(page_id);
+    if (page_guard.is_empty()) {
+        throw PageNotExistError("", page_no);
+    }
+    return page_guard;
+}
+
+/**
+ * @description: 只读打开时获取指定页面在映射中的地址，页面只能读取；不加锁也不pin，映射在文件关闭之前一直有效
+ * @param {int} page_no 页面号
+ * @return {char*} 页面数据
+ */
+char* RmFileHandle::get_mapped_page(int page_no) const {
+    const char* data = nullptr;
+    if (page_no >= 0 && page_no < file_hdr_.num_pages) {
+        data = disk_manager_->get_mapped_page(fd_, page_no);
+    }
+    if (data == nullptr) {
+        throw PageNotExistError("", page_no);
+    }
+    return const_cast<char*>(data);
+}
+
+/**
+ * @description: 创建一个新的page并加写锁，调用时持有file_hdr_latch_
+ * @return {WritePageGuard} 新的页面
+ */
+WritePageGuard RmFileHandle::create_new_page() {
     // Todo:
     // 1.使用缓冲池来创建一个新page
     // 2.更新page handle中的相关信息
     // 3.更新file_hdr_
+    if (read_only_) {
+        throw InternalError("RmFileHandle::create_new_page Error: table is opened read-only.");
+    }
     PageId page_id = {fd_, INVALID_PAGE_ID};
-    Page* page = buffer_pool_manager_->new_page(&page_id);
-    if (page == nullptr) {
+    WritePageGuard page_guard = buffer_pool_manager_->new_page_write(&page_id);
+    if (page_guard.is_empty()) {
         throw PageNotExistError("", -1);
     }
-    RmPageHandle page_handle(&file_hdr_, page);
+    RmPageHandle page_handle(&file_hdr_, page_guard.get_page());
     page_handle.page_hdr->num_records = 0;
     page_handle.page_hdr->next_free_page_no = file_hdr_.first_free_page_no;
     Bitmap::init(page_handle.bitmap, file_hdr_.bitmap_size);
-    file_hdr_.num_pages++;
+    // 新页面可能重用了文件中间归还的页号
+    file_hdr_.num_pages = std::max(file_hdr_.num_pages, page_id.page_no + 1);
     file_hdr_.first_free_page_no = page_id.page_no;
-    return page_handle;
+    return page_guard;
 }
 
 /**
- * @brief 创建或获取一个空闲的page handle
+ * @description: 页面已经被release_empty_pages归还时重新占用它，初始化为空页面并放到空闲页链表头部，调用时持有file_hdr_latch_
+ * @return {WritePageGuard} 重新占用的页面；页面没有被归还时返回空的guard
+ * @param {int} page_no 页面号
+ */
+WritePageGuard RmFileHandle::reclaim_page(int page_no) {
+    if (page_no < file_hdr_.num_pages && !disk_manager_->is_page_free(fd_, page_no)) {
+        return WritePageGuard();
+    }
+    PageId page_id = {fd_, page_no};
+    WritePageGuard page_guard = buffer_pool_manager_->reclaim_page_write(page_id);
+    if (page_guard.is_empty()) {
+        throw PageNotExistError("", page_no);
+    }
+    RmPageHandle page_handle(&file_hdr_, page_guard.get_page());
+    page_handle.page_hdr->num_records = 0;
+    page_handle.page_hdr->next_free_page_no = file_hdr_.first_free_page_no;
+    Bitmap::init(page_handle.bitmap, file_hdr_.bitmap_size);
+    file_hdr_.num_pages = std::max(file_hdr_.num_pages, page_no + 1);
+    file_hdr_.first_free_page_no = page_no;
+    return page_guard;
+}
+
+/**
+ * @brief 创建或获取一个空闲的page并加写锁，调用时持有file_hdr_latch_
  *
- * @return RmPageHandle 返回生成的空闲page handle
- * @note pin the page, remember to unpin it outside!
+ * @return WritePageGuard 返回空闲页面的guard
  */
-RmPageHandle RmFileHandle::create_page_handle() {
+WritePageGuard RmFileHandle::fetch_free_page() {
     // Todo:
     // 1. 判断file_hdr_中是否还有空闲页
-    //     1.1 没有空闲页：使用缓冲池来创建一个新page；可直接调用create_new_page_handle()
+    //     1.1 没有空闲页：使用缓冲池来创建一个新page；可直接调用create_new_page()
     //     1.2 有空闲页：直接获取第一个空闲页
     // 2. 生成page handle并返回给上层
     if (file_hdr_.first_free_page_no == RM_NO_PAGE) {
-        return create_new_page_handle();
+        return create_new_page();
     } else {
-        return fetch_page_handle(file_hdr_.first_free_page_no);
+        return fetch_page_write(file_hdr_.first_free_page_no);
+    }
+}
+
+/**
+ * @description: 把被插满的页面从空闲页链表中摘除，页面不一定位于链表头部，调用时持有file_hdr_latch_
+ * @param {RmPageHandle&} page_handle 被插满的页面
+ */
+void RmFileHandle::unlink_full_page(RmPageHandle& page_handle) {
+    page_id_t page_no = page_handle.page->get_page_id().page_no;
+    if (file_hdr_.first_free_page_no == page_no) {
+        file_hdr_.first_free_page_no = page_handle.page_hdr->next_free_page_no;
+        return;
+    }
+    page_id_t prev_no = file_hdr_.first_free_page_no;
+    while (prev_no != RM_NO_PAGE) {
+        WritePageGuard prev_guard = fetch_page_write(prev_no);
+        RmPageHdr* prev_hdr = RmPageHandle(&file_hdr_, prev_guard.get_page()).page_hdr;
+        if (prev_hdr->next_free_page_no == page_no) {
+            prev_hdr->next_free_page_no = page_handle.page_hdr->next_free_page_no;
+            return;
+        }
+        prev_no = prev_hdr->next_free_page_no;
     }
 }
 
 /**
- * @description: 当一个页面从没有空闲空间的状态变为有空闲空间状态时，更新文件头和页头中空闲页面相关的元数据
+ * @description: 当一个页面从没有空闲空间的状态变为有空闲空间状态时，更新文件头和页头中空闲页面相关的元数据，调用时持有file_hdr_latch_
  */
 void RmFileHandle::release_page_handle(RmPageHandle&page_handle) {
     // Todo:
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <assert.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+#include "bitmap.h"
+#include "common/context.h"
+#include "rm_defs.h"
+
+// 删除记录产生的空页面达到这么多个、且不少于表中页面数的1/RM_EMPTY_PAGES_RATIO时，把空页面归还给文件
+static constexpr int RM_RELEASE_EMPTY_PAGES = 32;
+static constexpr int RM_EMPTY_PAGES_RATIO = 8;
+
+class RmManager;
+
+/* 对表数据文件中的页面进行封装，只是页面内容的视图，页面的pin和读写锁由ReadPageGuard/WritePageGuard持有 */
+struct RmPageHandle {
+    const RmFileHdr *file_hdr;  // 当前页面所在文件的文件头指针
+    Page *page;                 // 页面的实际数据，包括页面存储的数据、元信息等
+    RmPageHdr *page_hdr;        // page->data的第一部分，存储页面元信息，指针指向首地址，长度为sizeof(RmPageHdr)
+    char *bitmap;               // page->data的第二部分，存储页面的bitmap，指针指向首地址，长度为file_hdr->bitmap_size
+    char *slots;                // page->data的第三部分，存储表的记录，指针指向首地址，每个slot的长度为file_hdr->record_size
+
+    RmPageHandle(const RmFileHdr *fhdr_, Page *page_) : RmPageHandle(fhdr_, page_->get_data()) { page = page_; }
+
+    // 只读映射中的页面没有对应的Page，page为nullptr，页面内容不能修改
+    RmPageHandle(const RmFileHdr *fhdr_, char *data) : file_hdr(fhdr_), page(nullptr) {
+        page_hdr = reinterpret_cast<RmPageHdr *>(data + Page::OFFSET_PAGE_HDR);
+        bitmap = data + sizeof(RmPageHdr) + Page::OFFSET_PAGE_HDR;
+        slots = bitmap + file_hdr->bitmap_size;
+    }
+
+    // 返回指定slot_no的slot存储收地址
+    char *get_slot(int slot_no) const {
+        return slots + slot_no * file_hdr->record_size;  // slots的首地址 + slot个数 * 每个slot的大小(每个record的大小)
+    }
+};
+
+/* 每个RmFileHandle对应一个表的数据文件，里面有多个page，每个page的数据封装在RmPageHandle中 */
+class RmFileHandle {
+    friend class RmScan;
+    friend class RmManager;
+
+   private:
+    DiskManager *disk_manager_;
+    BufferPoolManager *buffer_pool_manager_;
+    int fd_;                    // 打开文件后产生的文件句柄
+    RmFileHdr file_hdr_;        // 文件头，维护当前表文件的元数据
+    bool read_only_;            // 只读打开：页面直接从DiskManager的只读映射中读取，不经过缓冲池，不能修改记录
+    std::mutex file_hdr_latch_; // 保护file_hdr_中的num_pages和空闲页链表；需要同时持有页面写锁时先加file_hdr_latch_再加页面写锁
+    std::atomic<int> num_empty_pages_{0};   // 上次归还之后因删除记录而变空的页面个数
+
+   public:
+    RmFileHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd, bool read_only = false)
+        : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager), fd_(fd), read_only_(read_only) {
+        // 注意：这里从磁盘中读出文件描述符为fd的文件的file_hdr，读到内存中
+        // 这里实际就是初始化file_hdr，只不过是从磁盘中读出进行初始化
+        // init file_hdr_
+        disk_manager_->read_page(fd, RM_FILE_HDR_PAGE, (char *)&file_hdr_, sizeof(file_hdr_));
+        // disk_manager管理的fd对应的文件中，设置从file_hdr_.num_pages开始分配page_no
+        disk_manager_->set_fd2pageno(fd, file_hdr_.num_pages);
+        if (read_only_) {
+            disk_manager_->map_file(fd);
+        }
+    }
+
+    RmFileHdr get_file_hdr() { return file_hdr_; }
+    int GetFd() { return fd_; }
+    bool is_read_only() const { return read_only_; }
+
+    /* 判断指定位置上是否已经存在一条记录，通过Bitmap来判断 */
+    bool is_record(const Rid &rid) const {
+        if (read_only_) {
+            RmPageHandle page_handle(&file_hdr_, get_mapped_page(rid.page_no));
+            return Bitmap::is_set(page_handle.bitmap, rid.slot_no);
+        }
+        ReadPageGuard page_guard = fetch_page_read(rid.page_no);
+        RmPageHandle page_handle(&file_hdr_, page_guard.get_page());
+        return Bitmap::is_set(page_handle.bitmap, rid.slot_no);  // page的slot_no位置上是否有record
+    }
+
+    std::unique_ptr<RmRecord> get_record(const Rid &rid, Context *context) const;
+
+    Rid insert_record(char *buf, Context *context);
+
+    void insert_record(const Rid &rid, char *buf);
+
+    void delete_record(const Rid &rid, Context *context);
+
+    void update_record(const Rid &rid, char *buf, Context *context);
+
+    int release_empty_pages();
+
+    ReadPageGuard fetch_page_read(int page_no) const;
+
+    WritePageGuard fetch_page_write(int page_no) const;
+
+    char *get_mapped_page(int page_no) const;
+
+   private:
+    WritePageGuard create_new_page();
+
+    WritePageGuard fetch_free_page();
+
+    WritePageGuard reclaim_page(int page_no);
+
+    void unlink_full_page(RmPageHandle &page_handle);
+
+    void release_page_handle(RmPageHandle &page_handle);
+
+    int release_empty_pages_locked();
+};
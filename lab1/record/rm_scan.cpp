@@ -1,4 +1,9 @@
 #include "rm_scan.h"
+
+#include <sys/mman.h>
+
+#include <algorithm>
+
 #include "rm_file_handle.h"
 
 /**
@@ -6,6 +11,8 @@
  * @param file_handle
  */
 RmScan::RmScan(const RmFileHandle *file_handle) : file_handle_(file_handle) {
+    size_t pool_size = file_handle_->buffer_pool_manager_->get_pool_size();
+    use_ring_ = static_cast<size_t>(file_handle_->file_hdr_.num_pages) > pool_size / RM_SCAN_RING_POOL_FRACTION;
     // Todo:
     // 初始化file_handle和rid（指向第一个存放了记录的位置）
     rid_.page_no = RM_FIRST_RECORD_PAGE;
@@ -19,12 +26,46 @@ RmScan::RmScan(const RmFileHandle *file_handle) : file_handle_(file_handle) {
 void RmScan::next() {
     // Todo:
     // 找到文件中下一个存放了记录的非空闲位置，用rid_来指向这个位置
-    while (rid_.page_no < file_handle_->file_hdr_.num_pages) {
-        RmPageHandle page_handle = file_handle_->fetch_page_handle(rid_.page_no);
+    DiskManager *disk_manager = file_handle_->disk_manager_;
+    int fd = file_handle_->fd_;
+    // 文件末尾归还的空页面会被截掉，扫描范围同时受文件已分配的页面个数限制
+    bool retried = false;
+    while (rid_.page_no < std::min(file_handle_->file_hdr_.num_pages, disk_manager->get_fd2pageno(fd))) {
+        if (rid_.slot_no == -1 && disk_manager->is_page_free(fd, rid_.page_no)) {
+            // 已经归还给文件的空页面不用读取
+            rid_.page_no++;
+            continue;
+        }
+        ReadPageGuard page_guard;
+        char *data;
+        if (file_handle_->read_only_) {
+            // 只读打开的表直接读取映射中的页面，没有复制也不加锁
+            advise_ahead();
+            data = file_handle_->get_mapped_page(rid_.page_no);
+        } else {
+            // 大表通过扫描私有的环形缓冲区读取页面，只复用环中的几个帧；小表按普通页面读入缓冲池
+            PageId page_id = {fd, rid_.page_no};
+            try {
+                page_guard = file_handle_->buffer_pool_manager_->fetch_page_read(
+                    page_id, use_ring_ ? &strategy_ : nullptr, use_ring_ ? PageClass::SCAN : PageClass::HEAP);
+            } catch (RMDBError &) {
+                // 页面可能在判断范围之后被归还并从文件末尾截掉（截掉的都是空页面），页号随后还可能又被分配出去；
+                // 按新的范围重新判断一次，仍然读取失败时才是真正的错误
+                if (retried) {
+                    throw;
+                }
+                retried = true;
+                continue;
+            }
+            if (page_guard.is_empty()) {
+                throw PageNotExistError("", rid_.page_no);
+            }
+            data = page_guard.get_page()->get_data();
+        }
+        RmPageHandle page_handle(&file_handle_->file_hdr_, data);
         rid_.slot_no = Bitmap::next_bit(true, page_handle.bitmap, 
                                          file_handle_->file_hdr_.num_records_per_page, 
                                          rid_.slot_no);
-        file_handle_->buffer_pool_manager_->unpin_page(page_handle.page->get_page_id(), false);
         if (rid_.slot_no < file_handle_->file_hdr_.num_records_per_page) {
             return;  
         }
@@ -35,6 +76,18 @@ void RmScan::next() {
     rid_.slot_no = -1;
 }
 
+/**
+ * @brief 只读映射默认按随机访问提示内核，扫描时提前用MADV_WILLNEED提示之后的页面，让内核异步读入
+ */
+void RmScan::advise_ahead() {
+    if (rid_.page_no + RM_SCAN_ADVISE_PAGES / 2 < advised_upto_) {
+        return;
+    }
+    int start = std::max(rid_.page_no, advised_upto_);
+    advised_upto_ = rid_.page_no + RM_SCAN_ADVISE_PAGES;
+    file_handle_->disk_manager_->advise_mapped(file_handle_->fd_, start, advised_upto_ - start, MADV_WILLNEED);
+}
+
 /**
  * @brief ​ 判断是否到达文件末尾
  */
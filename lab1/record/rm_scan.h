@@ -0,0 +1,31 @@
+#pragma once
+
+#include "rm_defs.h"
+#include "storage/buffer_access_strategy.h"
+
+// 只读映射的表上，扫描提前用MADV_WILLNEED提示之后的这么多个页面，剩余不足一半时追加下一批
+static constexpr int RM_SCAN_ADVISE_PAGES = 64;
+// 表的页面数超过缓冲池帧数的这么多分之一时，扫描才使用私有的环形缓冲区；小表整张留在缓冲池中不会冲掉多少热点页面
+static constexpr size_t RM_SCAN_RING_POOL_FRACTION = 4;
+
+class RmFileHandle;
+
+class RmScan : public RecScan {
+    const RmFileHandle *file_handle_;
+    Rid rid_;
+    BufferAccessStrategy strategy_;     // 大表扫描使用的私有环形缓冲区，避免冲掉缓冲池中的热点页面
+    bool use_ring_;                     // 是否通过strategy_读取页面并标记为PageClass::SCAN
+    int advised_upto_ = 0;              // 只读映射上已经提示过MADV_WILLNEED的页面范围的末尾
+
+   public:
+    RmScan(const RmFileHandle *file_handle);
+
+    void next() override;
+
+    bool is_end() const override;
+
+    Rid rid() const override;
+
+   private:
+    void advise_ahead();
+};
@@ -0,0 +1,268 @@
+#include "replacer/arc_replacer.h"
+
+void ARCReplacer::GhostList::push_front(int64_t key) {
+    keys.push_front(key);
+    index[key] = keys.begin();
+}
+
+void ARCReplacer::GhostList::erase(int64_t key) {
+    auto it = index.find(key);
+    if (it == index.end()) {
+        return;
+    }
+    keys.erase(it->second);
+    index.erase(it);
+}
+
+void ARCReplacer::GhostList::pop_back() {
+    if (keys.empty()) {
+        return;
+    }
+    index.erase(keys.back());
+    keys.pop_back();
+}
+
+/**
+ * @brief 构造函数，初始化 ARC 替换器
+ * @param num_pages 缓冲池的大小（帧的数量）
+ */
+ARCReplacer::ARCReplacer(size_t num_pages)
+    : frames_(num_pages),
+      p_(0),
+      max_size_(num_pages),
+      num_evictable_(0) {}
+
+ARCReplacer::~ARCReplacer() = default;
+
+/**
+ * @brief 把帧放到 T1 或 T2 的 MRU 端
+ */
+void ARCReplacer::attach(frame_id_t frame_id, ArcList list) {
+    ArcFrame &frame = frames_[frame_id];
+    std::list<frame_id_t> &target = list_of(list);
+    target.push_front(frame_id);
+    frame.list = list;
+    frame.pos = target.begin();
+}
+
+/**
+ * @brief 把帧从所在的常驻链表中摘下
+ */
+void ARCReplacer::detach(frame_id_t frame_id) {
+    ArcFrame &frame = frames_[frame_id];
+    if (frame.list == ArcList::NONE) {
+        return;
+    }
+    list_of(frame.list).erase(frame.pos);
+    frame.list = ArcList::NONE;
+}
+
+/**
+ * @brief 从指定链表的 LRU 端开始找第一个可淘汰的帧，把它的页面号记入对应的 ghost list
+ * @return 找到返回 true
+ */
+bool ARCReplacer::evict_from(ArcList list, frame_id_t *frame_id) {
+    std::list<frame_id_t> &source = list_of(list);
+    for (auto it = source.rbegin(); it != source.rend(); ++it) {
+        ArcFrame &frame = frames_[*it];
+        if (!frame.evictable) {
+            continue;
+        }
+        *frame_id = *it;
+        if (frame.page_key != -1) {
+            (list == ArcList::T1 ? b1_ : b2_).push_front(frame.page_key);
+        }
+        detach(*frame_id);
+        frame.page_key = -1;
+        frame.evictable = false;
+        num_evictable_--;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief 按 ARC 的 REPLACE 规则选择淘汰帧
+ *
+ * T1 超过目标大小 p 时从 T1 淘汰，否则从 T2 淘汰；
+ * 被固定的帧不能淘汰，首选链表中没有可淘汰的帧时再尝试另一个链表
+ *
+ * @param[out] frame_id 被淘汰的帧的 id
+ * @return 成功返回 true，否则返回 false
+ */
+bool ARCReplacer::victim(frame_id_t *frame_id) {
+    std::scoped_lock lock{latch_};
+
+    if (num_evictable_ == 0) {
+        return false;
+    }
+    if (t1_.size() > p_ || t2_.empty()) {
+        return evict_from(ArcList::T1, frame_id) || evict_from(ArcList::T2, frame_id);
+    }
+    return evict_from(ArcList::T2, frame_id) || evict_from(ArcList::T1, frame_id);
+}
+
+/**
+ * @brief 帧中装入了新页面
+ *
+ * 1. 页面在 B1 中：T1 太小，p 增加 max(|B2|/|B1|, 1)，页面放入 T2
+ * 2. 页面在 B2 中：T2 太小，p 减少 max(|B1|/|B2|, 1)，页面放入 T2
+ * 3. 否则放入 T1
+ * 4. 保证 |T1|+|B1| <= c 且 |T1|+|T2|+|B1|+|B2| <= 2c
+ *
+ * @param frame_id 装入页面的帧
+ * @param page_id 装入的页面
+ */
+void ARCReplacer::load(frame_id_t frame_id, const PageId &page_id) {
+    std::scoped_lock lock{latch_};
+
+    // 边界检查
+    if (frame_id < 0 || static_cast<size_t>(frame_id) >= max_size_) {
+        return;
+    }
+
+    ArcFrame &frame = frames_[frame_id];
+    detach(frame_id);
+    if (frame.evictable) {
+        frame.evictable = false;
+        num_evictable_--;
+    }
+    // PageId::Get()把fd左移16位与page_no拼接，page_no超过16位时不同页面会冲突，这里让fd和page_no各占32位
+    int64_t key = static_cast<int64_t>(page_id.fd) << 32 | static_cast<uint32_t>(page_id.page_no);
+    frame.page_key = key;
+    frame.loading = true;
+
+    if (b1_.contains(key)) {
+        size_t delta = std::max<size_t>(b2_.size() / b1_.size(), 1);
+        p_ = std::min(p_ + delta, max_size_);
+        b1_.erase(key);
+        attach(frame_id, ArcList::T2);
+    } else if (b2_.contains(key)) {
+        size_t delta = std::max<size_t>(b1_.size() / b2_.size(), 1);
+        p_ = p_ > delta ? p_ - delta : 0;
+        b2_.erase(key);
+        attach(frame_id, ArcList::T2);
+    } else {
+        attach(frame_id, ArcList::T1);
+    }
+
+    while (t1_.size() + b1_.size() > max_size_ && b1_.size() > 0) {
+        b1_.pop_back();
+    }
+    while (t1_.size() + t2_.size() + b1_.size() + b2_.size() > 2 * max_size_ && b2_.size() > 0) {
+        b2_.pop_back();
+    }
+}
+
+/**
+ * @brief 固定一个帧，使其不能被淘汰
+ *
+ * 装入之后的第一次 pin 属于装入本身；其余的 pin 都是命中，把帧移到 T2 的 MRU 端
+ *
+ * @param frame_id 要固定的帧 id
+ */
+void ARCReplacer::pin(frame_id_t frame_id) {
+    std::scoped_lock lock{latch_};
+
+    // 边界检查
+    if (frame_id < 0 || static_cast<size_t>(frame_id) >= max_size_) {
+        return;
+    }
+
+    ArcFrame &frame = frames_[frame_id];
+    if (frame.evictable) {
+        frame.evictable = false;
+        num_evictable_--;
+    }
+    if (frame.list == ArcList::NONE) {
+        // 没有经过 load 的帧，按第一次访问放入 T1
+        attach(frame_id, ArcList::T1);
+    } else if (frame.loading) {
+        frame.loading = false;
+    } else {
+        detach(frame_id);
+        attach(frame_id, ArcList::T2);
+    }
+}
+
+/**
+ * @brief 取消固定一个帧，使其可以被淘汰
+ * @param frame_id 要取消固定的帧 id
+ */
+void ARCReplacer::unpin(frame_id_t frame_id) {
+    std::scoped_lock lock{latch_};
+
+    // 边界检查
+    if (frame_id < 0 || static_cast<size_t>(frame_id) >= max_size_) {
+        return;
+    }
+
+    ArcFrame &frame = frames_[frame_id];
+    // 如果已经在 replacer 中，不重复添加
+    if (frame.evictable) {
+        return;
+    }
+    if (frame.list == ArcList::NONE) {
+        attach(frame_id, ArcList::T1);
+    }
+    frame.loading = false;
+    frame.evictable = true;
+    num_evictable_++;
+}
+
+/**
+ * @brief 按淘汰顺序列出接下来最先被淘汰的帧，不改变 replacer 的状态
+ *
+ * 模拟连续调用 victim：T1 的长度超过 p 时取 T1 中最久未用的可淘汰帧，否则取 T2 的，
+ * 每取出一帧对应链表的长度减一；忽略淘汰之后装入新页面对 p 和链表的影响
+ *
+ * @param max_frames 最多列出的帧数
+ * @param[out] frames 按淘汰顺序追加帧号
+ * @return 总是返回 true
+ */
+bool ARCReplacer::eviction_order(size_t max_frames, std::vector<frame_id_t> *frames) {
+    std::scoped_lock lock{latch_};
+
+    auto t1_it = t1_.rbegin();
+    auto t2_it = t2_.rbegin();
+    size_t t1_size = t1_.size();
+    size_t t2_size = t2_.size();
+    // 把迭代器移到链表中下一个可淘汰的帧
+    auto skip_pinned = [this](std::list<frame_id_t>::reverse_iterator &it, std::list<frame_id_t> &list) {
+        while (it != list.rend() && !frames_[*it].evictable) {
+            ++it;
+        }
+    };
+    for (size_t listed = 0; listed < max_frames; listed++) {
+        skip_pinned(t1_it, t1_);
+        skip_pinned(t2_it, t2_);
+        bool t1_first = t1_size > p_ || t2_size == 0;
+        if (t1_it != t1_.rend() && (t1_first || t2_it == t2_.rend())) {
+            frames->push_back(*t1_it++);
+            t1_size--;
+        } else if (t2_it != t2_.rend()) {
+            frames->push_back(*t2_it++);
+            t2_size--;
+        } else {
+            break;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 返回当前可以被淘汰的帧数量
+ * @return 在 replacer 中的帧数量
+ */
+size_t ARCReplacer::Size() {
+    std::scoped_lock lock{latch_};
+    return num_evictable_;
+}
+
+/**
+ * @brief 返回当前 T1 的目标大小 p
+ */
+size_t ARCReplacer::target_t1_size() {
+    std::scoped_lock lock{latch_};
+    return p_;
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <algorithm>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "common/config.h"
+#include "replacer/replacer.h"
+
+/**
+ * ARCReplacer 实现了 ARC (Adaptive Replacement Cache) 替换策略
+ *
+ * - T1: 最近只被访问过一次的常驻帧（偏向新近性）
+ * - T2: 被访问过至少两次的常驻帧（偏向频率）
+ * - B1/B2: 分别记录最近从 T1/T2 淘汰的页面号（ghost list，不占用帧）
+ * - p: T1 的目标大小
+ *
+ * 装入的页面命中 B1 说明 T1 太小，增大 p；命中 B2 说明 T2 太小，减小 p。
+ * 这样策略会在 OLTP 阶段（热点反复访问）和报表扫描阶段（大量只访问一次的页面）之间自动调整。
+ */
+class ARCReplacer : public Replacer {
+   public:
+    /**
+     * @brief 创建一个新的 ARCReplacer
+     * @param num_pages 最多需要管理的帧数量，也是 ARC 中的缓存容量 c
+     */
+    explicit ARCReplacer(size_t num_pages);
+
+    ~ARCReplacer();
+
+    /**
+     * @brief 按 ARC 的 REPLACE 规则选择一个淘汰帧，并把其页面号记入 ghost list
+     * @param[out] frame_id 被淘汰的帧的 id
+     * @return 如果成功找到淘汰帧返回 true，否则返回 false
+     */
+    bool victim(frame_id_t *frame_id) override;
+
+    /**
+     * @brief 固定一个帧，如果是命中则把该帧移到 T2
+     * @param frame_id 要固定的帧 id
+     */
+    void pin(frame_id_t frame_id) override;
+
+    /**
+     * @brief 取消固定一个帧（该帧可以被淘汰了）
+     * @param frame_id 要取消固定的帧 id
+     */
+    void unpin(frame_id_t frame_id) override;
+
+    /**
+     * @brief 帧中装入了新页面，根据 ghost list 调整 p 并决定放入 T1 还是 T2
+     * @param frame_id 装入页面的帧
+     * @param page_id 装入的页面
+     */
+    void load(frame_id_t frame_id, const PageId &page_id) override;
+
+    /**
+     * @brief 按淘汰顺序列出接下来最先被淘汰的帧，不改变 replacer 的状态
+     * @param max_frames 最多列出的帧数
+     * @param[out] frames 按淘汰顺序追加帧号
+     * @return 总是返回 true
+     */
+    bool eviction_order(size_t max_frames, std::vector<frame_id_t> *frames) override;
+
+    /**
+     * @brief 返回当前可以被淘汰的帧数量
+     */
+    size_t Size() override;
+
+    /**
+     * @brief 返回当前 T1 的目标大小 p，用于观察策略的自适应过程
+     */
+    size_t target_t1_size();
+
+   private:
+    enum class ArcList { NONE = 0, T1, T2 };
+
+    /**
+     * @brief 每个帧的状态
+     */
+    struct ArcFrame {
+        ArcList list;                            // 帧所在的常驻链表
+        std::list<frame_id_t>::iterator pos;     // 帧在链表中的位置
+        int64_t page_key;                        // 帧中页面的fd和page_no拼成的键，未知时为-1
+        bool evictable;                          // 是否在 replacer 中（可被淘汰）
+        bool loading;                            // 刚装入页面，下一次 pin 属于装入本身而不是命中
+
+        ArcFrame() : list(ArcList::NONE), page_key(-1), evictable(false), loading(false) {}
+    };
+
+    /**
+     * @brief ghost list，按 MRU 在 front 的顺序记录页面号
+     */
+    struct GhostList {
+        std::list<int64_t> keys;
+        std::unordered_map<int64_t, std::list<int64_t>::iterator> index;
+
+        bool contains(int64_t key) const { return index.count(key) > 0; }
+        size_t size() const { return keys.size(); }
+        void push_front(int64_t key);
+        void erase(int64_t key);
+        void pop_back();
+    };
+
+    void attach(frame_id_t frame_id, ArcList list);
+
+    void detach(frame_id_t frame_id);
+
+    bool evict_from(ArcList list, frame_id_t *frame_id);
+
+    std::list<frame_id_t> &list_of(ArcList list) { return list == ArcList::T1 ? t1_ : t2_; }
+
+    std::mutex latch_;                 // 互斥锁，保证线程安全
+    std::vector<ArcFrame> frames_;     // 所有帧的状态数组
+    std::list<frame_id_t> t1_;         // MRU 在 front
+    std::list<frame_id_t> t2_;         // MRU 在 front
+    GhostList b1_;                     // 从 T1 淘汰的页面
+    GhostList b2_;                     // 从 T2 淘汰的页面
+    size_t p_;                         // T1 的目标大小
+    size_t max_size_;                  // 缓存容量 c
+    size_t num_evictable_;             // 当前在 replacer 中的帧数量
+};
@@ -0,0 +1,171 @@
+#include "replacer/lock_free_clock_replacer.h"
+
+/**
+ * @brief 构造函数，初始化不加锁的 CLOCK 替换器
+ * @param num_pages 缓冲池的大小（帧的数量）
+ */
+LockFreeClockReplacer::LockFreeClockReplacer(size_t num_pages)
+    : frames_(num_pages),
+      clock_hand_(0),
+      max_size_(num_pages),
+      num_in_replacer_(0) {
+    for (auto &frame : frames_) {
+        frame.store(static_cast<uint8_t>(PageClass::HEAP) << CLASS_SHIFT, std::memory_order_relaxed);
+    }
+}
+
+LockFreeClockReplacer::~LockFreeClockReplacer() = default;
+
+/**
+ * @brief 使用 CLOCK 策略选择一个淘汰帧
+ *
+ * 算法流程：
+ * 1. 如果没有可淘汰的帧，返回 false
+ * 2. 用 fetch_add 领取时钟指针的下一个位置，多个线程同时淘汰时各自检查不同的帧：
+ *    - 跳过不在 replacer 中的帧
+ *    - 如果 ref=true，用 CAS 清除引用位，给"第二次机会"
+ *    - 如果 ref=false 但还有命数，用 CAS 把命数减一
+ *    - 如果 ref=false 且没有命数，用 CAS 把帧从 replacer 中摘下（保留页面类别），成功即淘汰该帧
+ * 3. 与 ClockReplacer 一样最多检查 2 + MAX_EXTRA_LIVES 圈；CAS 会因为并发的 pin/unpin 失败，
+ *    因此额外多给一圈，仍然找不到就返回 false
+ *
+ * @param[out] frame_id 被淘汰的帧的 id
+ * @return 成功返回 true，否则返回 false
+ */
+bool LockFreeClockReplacer::victim(frame_id_t *frame_id) {
+    size_t max_iterations = max_size_ * (3 + MAX_EXTRA_LIVES);
+
+    for (size_t i = 0; i < max_iterations; i++) {
+        if (num_in_replacer_.load(std::memory_order_acquire) == 0) {
+            return false;
+        }
+        size_t hand = clock_hand_.fetch_add(1, std::memory_order_relaxed) % max_size_;
+        std::atomic<uint8_t> &frame = frames_[hand];
+        uint8_t state = frame.load(std::memory_order_acquire);
+
+        if ((state & IN_REPLACER_BIT) == 0) {
+            continue;
+        }
+        if (state & REF_BIT) {
+            // 给"第二次机会"：CAS 失败说明帧刚被 pin/unpin 过，保持原样
+            frame.compare_exchange_strong(state, state & ~REF_BIT, std::memory_order_acq_rel);
+            continue;
+        }
+        if (state & LIVES_MASK) {
+            frame.compare_exchange_strong(state, state - (1 << LIVES_SHIFT), std::memory_order_acq_rel);
+            continue;
+        }
+        if (frame.compare_exchange_strong(state, state & CLASS_MASK, std::memory_order_acq_rel)) {
+            // 找到了！淘汰这个帧
+            num_in_replacer_.fetch_sub(1, std::memory_order_acq_rel);
+            *frame_id = static_cast<frame_id_t>(hand);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief 固定一个帧，使其不能被淘汰
+ *
+ * 一次 fetch_and 同时清除 in_replacer、ref 和命数，只有原来在 replacer 中时才减少计数
+ *
+ * @param frame_id 要固定的帧 id
+ */
+void LockFreeClockReplacer::pin(frame_id_t frame_id) {
+    // 边界检查
+    if (frame_id < 0 || static_cast<size_t>(frame_id) >= max_size_) {
+        return;
+    }
+
+    uint8_t old_state = frames_[frame_id].fetch_and(static_cast<uint8_t>(~(IN_REPLACER_BIT | REF_BIT | LIVES_MASK)),
+                                                    std::memory_order_acq_rel);
+    if (old_state & IN_REPLACER_BIT) {
+        num_in_replacer_.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
+
+/**
+ * @brief 取消固定一个帧，使其可以被淘汰
+ *
+ * 一次 fetch_or 同时设置 in_replacer、ref（刚被使用过，有"第一次机会"，扫描读入的页面除外）和页面类别的命数，
+ * 只有原来不在 replacer 中时才增加计数。帧已经在 replacer 中时按位或可能多给命数，只会让它晚一些被淘汰
+ *
+ * @param frame_id 要取消固定的帧 id
+ */
+void LockFreeClockReplacer::unpin(frame_id_t frame_id) {
+    // 边界检查
+    if (frame_id < 0 || static_cast<size_t>(frame_id) >= max_size_) {
+        return;
+    }
+
+    std::atomic<uint8_t> &frame = frames_[frame_id];
+    size_t page_class = (frame.load(std::memory_order_relaxed) & CLASS_MASK) >> CLASS_SHIFT;
+    uint8_t bits = IN_REPLACER_BIT | (PAGE_CLASS_EXTRA_LIVES[page_class] << LIVES_SHIFT);
+    if (page_class != static_cast<size_t>(PageClass::SCAN)) {
+        bits |= REF_BIT;
+    }
+    uint8_t old_state = frame.fetch_or(bits, std::memory_order_acq_rel);
+    if ((old_state & IN_REPLACER_BIT) == 0) {
+        num_in_replacer_.fetch_add(1, std::memory_order_acq_rel);
+    }
+}
+
+/**
+ * @brief 按淘汰顺序列出接下来最先被淘汰的帧，不改变 replacer 的状态
+ *
+ * 与 ClockReplacer 一样从指针处转一圈，按引用位加命数分组列出；各帧的状态只读取一次，
+ * 与并发的 pin/unpin/victim 之间没有同步，结果只是近似的淘汰顺序
+ *
+ * @param max_frames 最多列出的帧数
+ * @param[out] frames 按淘汰顺序追加帧号
+ * @return 总是返回 true
+ */
+bool LockFreeClockReplacer::eviction_order(size_t max_frames, std::vector<frame_id_t> *frames) {
+    if (max_size_ == 0) {
+        return true;
+    }
+    std::vector<std::vector<frame_id_t>> groups(2 + MAX_EXTRA_LIVES);
+    size_t start = clock_hand_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < max_size_ && groups[0].size() < max_frames; i++) {
+        size_t hand = (start + i) % max_size_;
+        uint8_t state = frames_[hand].load(std::memory_order_acquire);
+        if (state & IN_REPLACER_BIT) {
+            groups[(state & REF_BIT) + ((state & LIVES_MASK) >> LIVES_SHIFT)].push_back(static_cast<frame_id_t>(hand));
+        }
+    }
+    size_t listed = 0;
+    for (const auto &group : groups) {
+        for (frame_id_t frame_id : group) {
+            if (listed++ == max_frames) {
+                return true;
+            }
+            frames->push_back(frame_id);
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 返回当前可以被淘汰的帧数量
+ * @return 在 replacer 中的帧数量
+ */
+size_t LockFreeClockReplacer::Size() { return num_in_replacer_.load(std::memory_order_acquire); }
+
+/**
+ * @brief 记录帧中页面的类别，用 CAS 只替换类别位
+ * @param frame_id 帧 id
+ * @param page_class 页面的类别
+ */
+void LockFreeClockReplacer::set_page_class(frame_id_t frame_id, PageClass page_class) {
+    // 边界检查
+    if (frame_id < 0 || static_cast<size_t>(frame_id) >= max_size_) {
+        return;
+    }
+
+    std::atomic<uint8_t> &frame = frames_[frame_id];
+    uint8_t state = frame.load(std::memory_order_relaxed);
+    uint8_t class_bits = static_cast<uint8_t>(page_class) << CLASS_SHIFT;
+    while (!frame.compare_exchange_weak(state, (state & ~CLASS_MASK) | class_bits, std::memory_order_acq_rel)) {
+    }
+}
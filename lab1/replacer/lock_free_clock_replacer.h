@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "common/config.h"
+#include "replacer/replacer.h"
+
+/**
+ * LockFreeClockReplacer 是不加锁的 CLOCK 替换策略
+ *
+ * 淘汰规则与 ClockReplacer 相同（包括按页面类别给出的命数），区别在于每个帧的 ref/in_replacer 标志位、
+ * 剩余命数和页面类别放在同一个原子字节里：
+ * - pin/unpin 只对该字节做一次 fetch_and/fetch_or，是 wait-free 的
+ * - victim 用 fetch_add 领取时钟指针的下一个位置，用 CAS 清除引用位或摘下帧，
+ *   CAS 失败说明该帧同时被 pin/unpin 过，直接看下一个帧
+ *
+ * 缓冲池命中时的 pin/unpin 因此不再竞争 replacer 的互斥锁。
+ */
+class LockFreeClockReplacer : public Replacer {
+   public:
+    /**
+     * @brief 创建一个新的 LockFreeClockReplacer
+     * @param num_pages 最多需要管理的帧数量
+     */
+    explicit LockFreeClockReplacer(size_t num_pages);
+
+    ~LockFreeClockReplacer();
+
+    /**
+     * @brief 使用 CLOCK 策略选择一个淘汰帧
+     * @param[out] frame_id 被淘汰的帧的 id
+     * @return 如果成功找到淘汰帧返回 true，否则返回 false
+     */
+    bool victim(frame_id_t *frame_id) override;
+
+    /**
+     * @brief 固定一个帧（该帧正在使用，不能被淘汰）
+     * @param frame_id 要固定的帧 id
+     */
+    void pin(frame_id_t frame_id) override;
+
+    /**
+     * @brief 取消固定一个帧（该帧可以被淘汰了）
+     * @param frame_id 要取消固定的帧 id
+     */
+    void unpin(frame_id_t frame_id) override;
+
+    /**
+     * @brief 按淘汰顺序列出接下来最先被淘汰的帧，不改变 replacer 的状态
+     * @param max_frames 最多列出的帧数
+     * @param[out] frames 按淘汰顺序追加帧号
+     * @return 总是返回 true
+     */
+    bool eviction_order(size_t max_frames, std::vector<frame_id_t> *frames) override;
+
+    /**
+     * @brief 返回当前可以被淘汰的帧数量
+     */
+    size_t Size() override;
+
+    /**
+     * @brief 记录帧中页面的类别，下一次 unpin 时按类别设置引用位和命数
+     * @param frame_id 帧 id
+     * @param page_class 页面的类别
+     */
+    void set_page_class(frame_id_t frame_id, PageClass page_class) override;
+
+   private:
+    static constexpr uint8_t REF_BIT = 0x1;          // 引用位：最近是否被访问过
+    static constexpr uint8_t IN_REPLACER_BIT = 0x2;  // 是否在 replacer 中（可被淘汰）
+    static constexpr uint8_t LIVES_SHIFT = 2;        // 第2、3位：引用位清零之后还能躲过的扫描次数
+    static constexpr uint8_t LIVES_MASK = 0x3 << LIVES_SHIFT;
+    static constexpr uint8_t CLASS_SHIFT = 4;        // 第4、5位：帧中页面的类别
+    static constexpr uint8_t CLASS_MASK = 0x3 << CLASS_SHIFT;
+
+    std::vector<std::atomic<uint8_t>> frames_;  // 所有帧的状态
+    std::atomic<size_t> clock_hand_;             // 时钟指针，只增不减，取模后得到帧号
+    size_t max_size_;                            // 最大容量
+    std::atomic<size_t> num_in_replacer_;        // 当前在 replacer 中的帧数量
+};
@@ -0,0 +1,205 @@
+#include "replacer/lru_k_replacer.h"
+
+/**
+ * @brief 构造函数，初始化 LRU-K 替换器
+ * @param num_pages 缓冲池的大小（帧的数量）
+ * @param k 计算后向 K 距离时使用的 K 值，至少为 1
+ */
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k)
+    : frames_(num_pages),
+      current_timestamp_(0),
+      max_size_(num_pages),
+      k_(k == 0 ? 1 : k) {}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+/**
+ * @brief 记录一次访问，只保留最近 K 次的时间戳
+ */
+void LRUKReplacer::record_access(LRUKFrame &frame) {
+    frame.history.push_back(++current_timestamp_);
+    if (frame.history.size() > k_) {
+        frame.history.pop_front();
+    }
+}
+
+/**
+ * @brief 帧在有序集合中的排序键
+ *
+ * 访问满 K 次时 history.front() 就是倒数第 K 次访问的时间戳；
+ * 不足 K 次时 history.front() 是最早一次访问的时间戳。
+ */
+LRUKReplacer::LRUKKey LRUKReplacer::key_of(frame_id_t frame_id) const {
+    return {frames_[frame_id].history.front(), frame_id};
+}
+
+/**
+ * @brief 帧所在的有序集合
+ *
+ * SCAN 页面总是放入 less_k_frames_，索引页面总是放入 k_frames_，其余页面按访问次数是否满 K 次决定
+ */
+std::set<LRUKReplacer::LRUKKey> &LRUKReplacer::set_of(frame_id_t frame_id) {
+    const LRUKFrame &frame = frames_[frame_id];
+    if (frame.page_class == PageClass::SCAN) {
+        return less_k_frames_;
+    }
+    if (PAGE_CLASS_EXTRA_LIVES[static_cast<size_t>(frame.page_class)] > 0) {
+        return k_frames_;
+    }
+    return frame.history.size() < k_ ? less_k_frames_ : k_frames_;
+}
+
+/**
+ * @brief 选择后向 K 距离最大的帧淘汰
+ *
+ * 1. 访问不足 K 次的帧 K 距离为无穷大，优先从 less_k_frames_ 中淘汰最早被访问的帧
+ * 2. 否则从 k_frames_ 中淘汰倒数第 K 次访问最早的帧
+ * 3. 被淘汰帧的访问历史被清空，该帧装入新页面后重新计数
+ *
+ * @param[out] frame_id 被淘汰的帧的 id
+ * @return 成功返回 true，否则返回 false
+ */
+bool LRUKReplacer::victim(frame_id_t *frame_id) {
+    std::scoped_lock lock{latch_};
+
+    std::set<LRUKKey> *candidates = !less_k_frames_.empty() ? &less_k_frames_ : &k_frames_;
+    if (candidates->empty()) {
+        return false;
+    }
+    *frame_id = candidates->begin()->second;
+    candidates->erase(candidates->begin());
+
+    LRUKFrame &frame = frames_[*frame_id];
+    frame.history.clear();
+    frame.evictable = false;
+    return true;
+}
+
+/**
+ * @brief 固定一个帧，使其不能被淘汰
+ *
+ * BufferPoolManager 每次 fetch_page/new_page 都会调用 pin，因此在这里记录一次访问
+ *
+ * @param frame_id 要固定的帧 id
+ */
+void LRUKReplacer::pin(frame_id_t frame_id) {
+    std::scoped_lock lock{latch_};
+
+    // 边界检查
+    if (frame_id < 0 || static_cast<size_t>(frame_id) >= max_size_) {
+        return;
+    }
+
+    LRUKFrame &frame = frames_[frame_id];
+    if (frame.evictable) {
+        set_of(frame_id).erase(key_of(frame_id));
+        frame.evictable = false;
+    }
+    record_access(frame);
+}
+
+/**
+ * @brief 取消固定一个帧，使其可以被淘汰
+ * @param frame_id 要取消固定的帧 id
+ */
+void LRUKReplacer::unpin(frame_id_t frame_id) {
+    std::scoped_lock lock{latch_};
+
+    // 边界检查
+    if (frame_id < 0 || static_cast<size_t>(frame_id) >= max_size_) {
+        return;
+    }
+
+    LRUKFrame &frame = frames_[frame_id];
+    // 如果已经在 replacer 中，不重复添加
+    if (frame.evictable) {
+        return;
+    }
+    // 没有经过 pin 直接 unpin 的帧，视为刚被访问过一次
+    if (frame.history.empty()) {
+        record_access(frame);
+    }
+    frame.evictable = true;
+    set_of(frame_id).insert(key_of(frame_id));
+}
+
+/**
+ * @brief 帧中装入了新的页面，清空上一个页面留下的访问历史
+ *
+ * 通过 victim 淘汰的帧已经清空了历史，但 delete_page 释放的帧和环形缓冲区直接复用的帧
+ * 没有经过 victim，不清空的话新页面会继承旧页面的访问次数
+ *
+ * @param frame_id 装入页面的帧 id
+ */
+void LRUKReplacer::load(frame_id_t frame_id, const PageId &) {
+    std::scoped_lock lock{latch_};
+
+    // 边界检查
+    if (frame_id < 0 || static_cast<size_t>(frame_id) >= max_size_) {
+        return;
+    }
+
+    LRUKFrame &frame = frames_[frame_id];
+    if (frame.evictable) {
+        set_of(frame_id).erase(key_of(frame_id));
+        frame.evictable = false;
+    }
+    frame.history.clear();
+    frame.page_class = PageClass::HEAP;
+}
+
+/**
+ * @brief 记录帧中页面的类别，帧在 replacer 中时按新的类别移到对应的有序集合
+ * @param frame_id 页面所在的帧 id
+ * @param page_class 页面的类别
+ */
+void LRUKReplacer::set_page_class(frame_id_t frame_id, PageClass page_class) {
+    std::scoped_lock lock{latch_};
+
+    // 边界检查
+    if (frame_id < 0 || static_cast<size_t>(frame_id) >= max_size_) {
+        return;
+    }
+
+    LRUKFrame &frame = frames_[frame_id];
+    if (!frame.evictable) {
+        frame.page_class = page_class;
+        return;
+    }
+    set_of(frame_id).erase(key_of(frame_id));
+    frame.page_class = page_class;
+    set_of(frame_id).insert(key_of(frame_id));
+}
+
+/**
+ * @brief 按淘汰顺序列出接下来最先被淘汰的帧，不改变 replacer 的状态
+ *
+ * 与 victim 的顺序相同：先是 less_k_frames_ 中的帧，再是 k_frames_ 中的帧，各自按排序键从小到大
+ *
+ * @param max_frames 最多列出的帧数
+ * @param[out] frames 按淘汰顺序追加帧号
+ * @return 总是返回 true
+ */
+bool LRUKReplacer::eviction_order(size_t max_frames, std::vector<frame_id_t> *frames) {
+    std::scoped_lock lock{latch_};
+
+    size_t listed = 0;
+    for (const std::set<LRUKKey> *candidates : {&less_k_frames_, &k_frames_}) {
+        for (const LRUKKey &key : *candidates) {
+            if (listed++ == max_frames) {
+                return true;
+            }
+            frames->push_back(key.second);
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 返回当前可以被淘汰的帧数量
+ * @return 在 replacer 中的帧数量
+ */
+size_t LRUKReplacer::Size() {
+    std::scoped_lock lock{latch_};
+    return less_k_frames_.size() + k_frames_.size();
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <list>
+#include <mutex>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "replacer/replacer.h"
+
+// LRU-K 默认的 K 值
+static constexpr size_t LRUK_REPLACER_K = 2;
+
+/**
+ * LRUKReplacer 实现了 LRU-K 替换策略
+ *
+ * - 每个帧记录最近 K 次被访问（pin）的时间戳
+ * - 淘汰时选择"倒数第 K 次访问"最早的帧，即后向 K 距离最大的帧
+ * - 访问次数不足 K 次的帧后向 K 距离视为无穷大，优先淘汰，它们之间按最早一次访问的时间淘汰
+ *
+ * 一次全表扫描只会让每个页面被访问一次，这些页面的 K 距离都是无穷大，
+ * 会先于被反复访问的热点页面（如 B+ 树内部节点）被淘汰，因此不会冲掉热点数据。
+ *
+ * 页面类别（set_page_class）：PAGE_CLASS_EXTRA_LIVES 不为0的索引页面即使访问不足 K 次也按 K 距离有限排序，
+ * 不会和一次性访问的页面一起被优先淘汰；SCAN 页面即使访问满 K 次也留在优先淘汰的集合中。
+ */
+class LRUKReplacer : public Replacer {
+   public:
+    /**
+     * @brief 创建一个新的 LRUKReplacer
+     * @param num_pages 最多需要管理的帧数量
+     * @param k 计算后向 K 距离时使用的 K 值
+     */
+    explicit LRUKReplacer(size_t num_pages, size_t k = LRUK_REPLACER_K);
+
+    ~LRUKReplacer();
+
+    /**
+     * @brief 选择后向 K 距离最大的帧淘汰
+     * @param[out] frame_id 被淘汰的帧的 id
+     * @return 如果成功找到淘汰帧返回 true，否则返回 false
+     */
+    bool victim(frame_id_t *frame_id) override;
+
+    /**
+     * @brief 固定一个帧，并记录一次访问
+     * @param frame_id 要固定的帧 id
+     */
+    void pin(frame_id_t frame_id) override;
+
+    /**
+     * @brief 取消固定一个帧（该帧可以被淘汰了）
+     * @param frame_id 要取消固定的帧 id
+     */
+    void unpin(frame_id_t frame_id) override;
+
+    /**
+     * @brief 帧中装入了新的页面，清空上一个页面留下的访问历史
+     * @param frame_id 装入页面的帧 id
+     */
+    void load(frame_id_t frame_id, const PageId &page_id) override;
+
+    /**
+     * @brief 记录帧中页面的类别，决定帧可淘汰时放入哪个有序集合
+     * @param frame_id 页面所在的帧 id
+     * @param page_class 页面的类别
+     */
+    void set_page_class(frame_id_t frame_id, PageClass page_class) override;
+
+    /**
+     * @brief 按淘汰顺序列出接下来最先被淘汰的帧，不改变 replacer 的状态
+     * @param max_frames 最多列出的帧数
+     * @param[out] frames 按淘汰顺序追加帧号
+     * @return 总是返回 true
+     */
+    bool eviction_order(size_t max_frames, std::vector<frame_id_t> *frames) override;
+
+    /**
+     * @brief 返回当前可以被淘汰的帧数量
+     */
+    size_t Size() override;
+
+   private:
+    /**
+     * @brief 每个帧的访问历史
+     */
+    struct LRUKFrame {
+        std::list<size_t> history;  // 最近 K 次访问的时间戳，front 为最早的一次
+        bool evictable;             // 是否在 replacer 中（可被淘汰）
+        PageClass page_class;       // 帧中页面的类别
+
+        LRUKFrame() : evictable(false), page_class(PageClass::HEAP) {}
+    };
+
+    using LRUKKey = std::pair<size_t, frame_id_t>;  // (排序用的时间戳, 帧 id)
+
+    void record_access(LRUKFrame &frame);
+
+    LRUKKey key_of(frame_id_t frame_id) const;
+
+    std::set<LRUKKey> &set_of(frame_id_t frame_id);
+
+    std::mutex latch_;                 // 互斥锁，保证线程安全
+    std::vector<LRUKFrame> frames_;    // 所有帧的访问历史
+    std::set<LRUKKey> less_k_frames_;  // 可淘汰且访问不足 K 次的帧，按最早一次访问排序
+    std::set<LRUKKey> k_frames_;       // 可淘汰且访问满 K 次的帧，按倒数第 K 次访问排序
+    size_t current_timestamp_;         // 逻辑时钟，每次访问加一
+    size_t max_size_;                  // 最大容量
+    size_t k_;                         // K 值
+};
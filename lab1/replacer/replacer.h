@@ -0,0 +1,72 @@
+#pragma once
+
+#include <vector>
+
+#include "common/config.h"
+#include "storage/page.h"
+
+// CLOCK类策略中各类页面在引用位之外还能躲过的扫描次数，下标为PageClass
+static constexpr uint8_t PAGE_CLASS_EXTRA_LIVES[static_cast<size_t>(PageClass::NUM_CLASSES)] = {0, 0, 1, 3};
+static constexpr uint8_t MAX_EXTRA_LIVES = 3;
+
+/**
+ * Replacer is an abstract class that tracks page usage.
+ */
+class Replacer {
+   public:
+    Replacer() = default;
+    virtual ~Replacer() = default;
+
+    /**
+     * @description: 使用策略删除一个victim frame，并返回该frame的id
+     * @param {frame_id_t*} frame_id 被移除的frame的id，如果没有frame被移除返回nullptr
+     * @return {bool} 如果成功淘汰了一个页面则返回true，否则返回false
+     */
+    virtual bool victim(frame_id_t *frame_id) = 0;
+
+    /**
+     * @description: 固定指定的frame，即该页面无法被淘汰
+     * @param {frame_id_t} 需要固定的frame的id
+     */
+    virtual void pin(frame_id_t frame_id) = 0;
+
+    /**
+     * @description: 取消固定一个frame，代表该页面可以被淘汰
+     * @param {frame_id_t} frame_id 取消固定的frame的id
+     */
+    virtual void unpin(frame_id_t frame_id) = 0;
+
+    /**
+     * @description: 通知replacer帧中装入了新的页面，BufferPoolManager在随后的pin之前调用。
+     *              只按帧记录状态的策略不需要重写；ARC等需要按页面记录历史（ghost list）的策略重写此方法
+     * @param {frame_id_t} frame_id 装入页面的帧
+     * @param {PageId&} page_id 装入的页面
+     */
+    virtual void load(__attribute__((unused)) frame_id_t frame_id, __attribute__((unused)) const PageId &page_id) {}
+
+    /**
+     * @description: 通知replacer帧中页面的类别，BufferPoolManager在装入页面时和页面类别变化时调用，此时帧被固定。
+     *              不区分页面类别的策略不需要重写：目前CLOCK、CLOCK-LF和LRU-K使用页面类别，LRU和ARC忽略它
+     * @param {frame_id_t} frame_id 页面所在的帧
+     * @param {PageClass} page_class 页面的类别
+     */
+    virtual void set_page_class(__attribute__((unused)) frame_id_t frame_id,
+                                __attribute__((unused)) PageClass page_class) {}
+
+    /**
+     * @description: 按淘汰顺序列出接下来最先被淘汰的帧，不改变replacer的状态，供后台刷脏优先写回即将被淘汰的脏页。
+     *              列出的是此刻连续调用victim的顺序，之后的pin/unpin会改变它。不支持的策略不需要重写，返回false
+     * @param {size_t} max_frames 最多列出的帧数
+     * @param {vector<frame_id_t>*} frames 按淘汰顺序追加帧号
+     * @return {bool} 支持列出淘汰顺序则返回true
+     */
+    virtual bool eviction_order(__attribute__((unused)) size_t max_frames,
+                                __attribute__((unused)) std::vector<frame_id_t> *frames) {
+        return false;
+    }
+
+    /**
+     * @description: 获取当前replacer中可以被淘汰的页面数量
+     */
+    virtual size_t Size() = 0;
+};
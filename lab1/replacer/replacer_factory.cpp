@@ -0,0 +1,47 @@
+#include "replacer/replacer_factory.h"
+
+#include <algorithm>
+#include <cctype>
+
+#include "errors.h"
+#include "replacer/arc_replacer.h"
+#include "replacer/clock_replacer.h"
+#include "replacer/lock_free_clock_replacer.h"
+#include "replacer/lru_k_replacer.h"
+#include "replacer/lru_replacer.h"
+
+/**
+ * @brief 按名称创建置换策略
+ * @param replacer_type 置换策略名称
+ * @param num_pages 需要管理的帧数量
+ * @return 新创建的 Replacer，由调用者负责 delete
+ * @throws InternalError 名称不是支持的置换策略
+ */
+Replacer *create_replacer(const std::string &replacer_type, size_t num_pages) {
+    if (replacer_type == "LRU") {
+        return new LRUReplacer(num_pages);
+    }
+    if (replacer_type == "CLOCK") {
+        return new ClockReplacer(num_pages);
+    }
+    if (replacer_type == "CLOCK-LF") {
+        return new LockFreeClockReplacer(num_pages);
+    }
+    if (replacer_type == "ARC") {
+        return new ARCReplacer(num_pages);
+    }
+    if (replacer_type == "LRU-K") {
+        return new LRUKReplacer(num_pages, LRUK_REPLACER_K);
+    }
+    // "LRU-<k>"：直接指定K
+    const std::string prefix = "LRU-";
+    std::string k_str = replacer_type.substr(std::min(prefix.size(), replacer_type.size()));
+    if (replacer_type.compare(0, prefix.size(), prefix) == 0 && !k_str.empty() && k_str.size() <= 4 &&
+        std::all_of(k_str.begin(), k_str.end(), [](char c) { return isdigit(static_cast<unsigned char>(c)); })) {
+        size_t k = std::stoul(k_str);
+        if (k > 0) {
+            return new LRUKReplacer(num_pages, k);
+        }
+    }
+    throw InternalError("Unknown replacer type: " + replacer_type);
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <string_view>
+
+#include "replacer/replacer.h"
+
+/**
+ * 置换策略工厂：按名称在运行时创建 Replacer，不需要修改 config.h 重新编译
+ *
+ * 支持的名称：
+ * - "LRU"、"CLOCK"、"CLOCK-LF"（不加锁的 CLOCK）、"ARC"
+ * - "LRU-K"：K 取 LRUK_REPLACER_K；也可以直接写出 K，如 "LRU-3"
+ */
+
+// 所有支持的置换策略名称，基准测试按这个顺序逐个比较
+static constexpr std::array<std::string_view, 5> REPLACER_TYPES = {"LRU", "CLOCK", "CLOCK-LF", "LRU-K", "ARC"};
+
+/**
+ * @brief 按名称创建置换策略
+ * @param replacer_type 置换策略名称
+ * @param num_pages 需要管理的帧数量
+ * @return 新创建的 Replacer，由调用者负责 delete
+ * @throws InternalError 名称不是支持的置换策略
+ */
+Replacer *create_replacer(const std::string &replacer_type, size_t num_pages);
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "common/config.h"
+#include "page.h"
+
+// 顺序扫描默认使用的环形缓冲区大小（帧数），与PostgreSQL的bulk-read策略一样为256KB
+static constexpr size_t BULK_READ_RING_SIZE = (256 * 1024) / PAGE_SIZE;
+
+/**
+ * BufferAccessStrategy 是一次大范围扫描私有的环形缓冲区
+ *
+ * 传给 BufferPoolManager::fetch_page 后，未命中的页面不再从整个缓冲池中淘汰页面，
+ * 而是优先复用环中上一轮装入、现在已经没有被固定的帧，因此扫描大表只会占用环中的几个帧，
+ * 不会把点查和索引的热点页面挤出缓冲池。命中的页面不进入环，仍按正常方式访问。
+ *
+ * 帧属于缓冲池的各个分区，所以环也按分区划分，每个分区至少两个槽位。
+ * 一个 BufferAccessStrategy 只能被一个扫描（一个线程）使用。
+ */
+class BufferAccessStrategy {
+    friend class BufferPoolManager;
+    friend class BufferPoolInstance;
+
+   public:
+    explicit BufferAccessStrategy(size_t ring_size = BULK_READ_RING_SIZE) : ring_size_(ring_size) {}
+
+    size_t get_ring_size() const { return ring_size_; }
+
+   private:
+    /**
+     * @description: 环中的一个槽位，记录这一槽位上次使用的帧以及装入的页面
+     */
+    struct RingSlot {
+        frame_id_t frame_id = -1;
+        PageId page_id;
+    };
+
+    struct Ring {
+        std::vector<RingSlot> slots;
+        size_t current = 0;     // 下一次使用的槽位
+    };
+
+    /**
+     * @description: 按缓冲池的分区个数初始化各分区的环，由BufferPoolManager在第一次使用时调用
+     */
+    void init(size_t num_instances) {
+        size_t slots_per_instance = std::max<size_t>(2, ring_size_ / num_instances);
+        rings_.assign(num_instances, Ring());
+        for (auto &ring : rings_) {
+            ring.slots.resize(slots_per_instance);
+        }
+    }
+
+    /**
+     * @description: 前进到instance_index分区的环中的下一个槽位并返回
+     */
+    RingSlot *next_slot(size_t instance_index) {
+        Ring &ring = rings_[instance_index];
+        ring.current = (ring.current + 1) % ring.slots.size();
+        return &ring.slots[ring.current];
+    }
+
+    size_t ring_size_;
+    std::vector<Ring> rings_;   // 每个分区一个环，为空表示尚未初始化
+};
@@ -0,0 +1,1076 @@
+#include "buffer_pool_instance.h"
+
+/**
+ * @description: 等待帧上正在进行的磁盘读写完成，等待期间释放latch_
+ * @param {unique_lock<mutex>&} lock 已持有的latch_
+ * @param {Page*} page 目标帧
+ */
+void BufferPoolInstance::wait_for_io(std::unique_lock<std::mutex>& lock, Page* page) {
+    page->io_cv_.wait(lock, [page] { return !page->io_in_progress_; });
+}
+
+/**
+ * @description: 在page_table_中查找目标页所在的帧，若该帧正在进行磁盘读写，则只在这一帧上等待其完成
+ * @return {bool} 目标页在缓冲池中则返回true
+ * @param {unique_lock<mutex>&} lock 已持有的latch_
+ * @param {PageId} page_id 目标页
+ * @param {frame_id_t*} frame_id 返回目标页所在的帧
+ */
+bool BufferPoolInstance::find_frame(std::unique_lock<std::mutex>& lock, PageId page_id, frame_id_t* frame_id) {
+    bool found = page_table_.find(page_id, frame_id);
+    while (found && pages_[*frame_id].io_in_progress_) {
+        stats_->add(BufferStat::PIN_WAIT, page_id.fd);
+        wait_for_io(lock, &pages_[*frame_id]);
+        // 等待期间latch_被释放，页表可能已经变化，需要重新查找
+        found = page_table_.find(page_id, frame_id);
+    }
+    return found;
+}
+
+/**
+ * @description: 从free_list或replacer中得到可淘汰帧页的 *frame_id
+ *              若选中的帧正在被写回，会释放latch_等待写回完成，调用者需要重新确认页表
+ * @return {bool} true: 可替换帧查找成功 , false: 可替换帧查找失败
+ * @param {unique_lock<mutex>&} lock 已持有的latch_
+ * @param {frame_id_t*} frame_id 帧页id指针,返回成功找到的可替换帧id
+ */
+bool BufferPoolInstance::find_victim_page(std::unique_lock<std::mutex>& lock, frame_id_t* frame_id) {
+    // Todo:
+    // 1 使用BufferPoolInstance::free_list_判断缓冲池是否已满需要淘汰页面
+    // 1.1 未满获得frame
+    // 1.2 已满使用lru_replacer中的方法选择淘汰页面，并claim选中的帧
+    if (!free_list_.empty()) {
+        // 空闲帧一直处于claim状态
+        *frame_id = free_list_.front();
+        free_list_.pop_front();
+        return true;
+    }
+    while (replacer_->victim(frame_id)) {
+        if (static_cast<size_t>(*frame_id) >= pool_size_) {
+            // 缩容中超出范围的帧，已经移出了replacer，留给resize移出其中的页面
+            continue;
+        }
+        Page* page = &pages_[*frame_id];
+        // 该帧正在被写回，等写回完成
+        wait_for_io(lock, page);
+        // 无锁命中可能已经固定了该帧，claim失败时跳过它，它unpin到0时会重新回到replacer
+        if (claim_frame(page)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @description: 归还find_victim_page得到但没有使用的帧
+ * @param {frame_id_t} frame_id 要归还的帧
+ */
+void BufferPoolInstance::release_victim_page(frame_id_t frame_id) {
+    Page* page = &pages_[frame_id];
+    if (page->id_.page_no == INVALID_PAGE_ID) {
+        if (static_cast<size_t>(frame_id) < pool_size_) {
+            free_list_.push_front(frame_id);
+        }
+    } else {
+        // 先结束claim再放回replacer，否则replacer选中它时claim会失败
+        release_claim(page, 0);
+        replacer_->unpin(frame_id);
+    }
+}
+
+/**
+ * @description: 无锁地固定一个帧：原子地增加pin_count_，帧处于claim状态时撤销
+ *              成功后帧不会再被淘汰，但调用者还需要确认帧中是否是自己要的页面
+ * @return {bool} 固定成功则返回true
+ * @param {Page*} page 要固定的帧
+ */
+bool BufferPoolInstance::try_pin(Page* page) {
+    if (page->pin_count_.fetch_add(1, std::memory_order_acq_rel) >= 0) {
+        return true;
+    }
+    page->pin_count_.fetch_sub(1, std::memory_order_acq_rel);
+    return false;
+}
+
+/**
+ * @description: 无锁地取消固定一个帧，pin_count_减到0时放回replacer
+ * @return {bool} 帧没有被固定时返回false
+ * @param {frame_id_t} frame_id 要取消固定的帧
+ */
+bool BufferPoolInstance::release_pin(frame_id_t frame_id) {
+    Page* page = &pages_[frame_id];
+    int pin_count = page->pin_count_.load(std::memory_order_acquire);
+    do {
+        if (pin_count <= 0) {
+            return false;
+        }
+    } while (!page->pin_count_.compare_exchange_weak(pin_count, pin_count - 1, std::memory_order_acq_rel));
+    if (pin_count == 1) {
+        replacer_->unpin(frame_id);
+    }
+    return true;
+}
+
+/**
+ * @description: claim一个没有被固定的帧：把pin_count_从0改为负数，之后无锁命中不能再固定它。
+ *              淘汰、复用和删除帧之前都要先claim，调用时持有latch_
+ * @return {bool} 帧被固定时返回false
+ * @param {Page*} page 要claim的帧
+ */
+bool BufferPoolInstance::claim_frame(Page* page) {
+    int expected = 0;
+    return page->pin_count_.compare_exchange_strong(expected, Page::PIN_COUNT_CLAIMED, std::memory_order_acq_rel);
+}
+
+/**
+ * @description: 结束claim，帧的pin_count_变为pin_count。
+ *              用加法而不是直接赋值，claim期间无锁命中的线程对pin_count_的加一和撤销互相抵消
+ * @param {Page*} page 已经claim的帧
+ * @param {int} pin_count 结束claim后的pin_count_
+ */
+void BufferPoolInstance::release_claim(Page* page, int pin_count) {
+    page->pin_count_.fetch_add(pin_count - Page::PIN_COUNT_CLAIMED, std::memory_order_acq_rel);
+}
+
+/**
+ * @description: 检查环形缓冲区槽位中记录的帧能否被复用：帧中仍是上次装入的页面，且没有被固定、没有在进行磁盘读写。
+ *              可以复用时把该帧从replacer中取出
+ * @return {bool} 可以复用则返回true
+ * @param {RingSlot*} slot 环中的槽位
+ * @param {frame_id_t*} frame_id 返回可复用的帧
+ */
+bool BufferPoolInstance::find_ring_frame(BufferAccessStrategy::RingSlot* slot, frame_id_t* frame_id) {
+    if (slot->frame_id < 0 || static_cast<size_t>(slot->frame_id) >= pool_size_) {
+        return false;
+    }
+    frame_id_t frame_id_in_table;
+    if (!page_table_.find(slot->page_id, &frame_id_in_table) || frame_id_in_table != slot->frame_id) {
+        return false;
+    }
+    Page* page = &pages_[slot->frame_id];
+    if (page->pin_count_ > 0 || page->io_in_progress_) {
+        // 帧被其他线程使用，说明该页面不只被这次扫描访问，留在缓冲池中，改用普通的淘汰
+        return false;
+    }
+    if (page->prefetched_) {
+        // 预读装入的页面还没有被扫描到，复用它会浪费这次预读
+        return false;
+    }
+    if (!claim_frame(page)) {
+        // 检查之后被无锁命中固定了
+        return false;
+    }
+    replacer_->pin(slot->frame_id);
+    *frame_id = slot->frame_id;
+    return true;
+}
+
+/**
+ * @description: 更新页面数据, 如果为脏页则需写入磁盘，再更新为新页面，更新page元数据(data, is_dirty, page_id)和page table
+ *              调用时持有latch_；旧页面的写回和新页面的读入在释放latch_后进行，期间帧处于io_in_progress_状态，
+ *              请求新旧两个页面的线程都只在这一帧上等待，其他页面的访问不受影响
+ * @return {Page*} 固定好的新页面
+ * @param {unique_lock<mutex>&} lock 已持有的latch_
+ * @param {PageId} new_page_id 新的page_id
+ * @param {frame_id_t} new_frame_id 新的帧frame_id
+ * @param {LoadMode} mode 新页面的装入方式：读入、清零，或者由调用者读入（此时返回时帧仍处于io_in_progress_和claim状态）
+ * @param {PageClass} page_class 新页面的类别
+ */
+Page* BufferPoolInstance::update_page(std::unique_lock<std::mutex>& lock, PageId new_page_id, frame_id_t new_frame_id,
+                                      LoadMode mode, PageClass page_class) {
+    // Todo:
+    // 1 更新page table，标记为io_in_progress_，帧在整个读写期间保持claim状态
+    // 2 释放latch_，如果是脏页，写回磁盘
+    // 3 重置page的data或从磁盘读入新页面
+    // 4 重新获取latch_，删除旧页面的映射，结束claim（固定帧），结束io并唤醒等待者
+    Page* page = &pages_[new_frame_id];
+    PageId old_page_id = page->id_;
+    bool has_old_page = old_page_id.page_no != INVALID_PAGE_ID;
+    bool need_write_back = has_old_page && page->is_dirty_;
+
+    if (page->prefetched_) {
+        prefetch_wasted_++;
+        page->prefetched_ = false;
+    }
+
+    // 旧页面的映射保留到写回完成，这样请求旧页面的线程会等待写回，而不会从磁盘读到过期数据
+    page_table_.insert(new_page_id, new_frame_id);
+    page->id_ = new_page_id;
+    page->io_in_progress_ = true;
+    page->access_count_.store(1, std::memory_order_relaxed);
+    page->page_class_.store(page_class, std::memory_order_relaxed);
+    replacer_->load(new_frame_id, new_page_id);
+    replacer_->set_page_class(new_frame_id, page_class);
+    replacer_->pin(new_frame_id);
+    lock.unlock();
+
+    if (has_old_page) {
+        stats_->add(BufferStat::EVICTION, old_page_id.fd);
+    }
+    if (need_write_back) {
+        foreground_write_backs_++;
+        stats_->add(BufferStat::DIRTY_WRITE_BACK, old_page_id.fd);
+    }
+    bool written = false;
+    try {
+        if (need_write_back) {
+            disk_manager_->write_page(old_page_id.fd, old_page_id.page_no, page->get_data(), PAGE_SIZE);
+        }
+        written = true;
+        // 旧页面此时和磁盘一致，覆盖之前放入压缩缓存；旧页面的映射还在，请求它的线程会等到这里结束后再查压缩缓存
+        if (has_old_page) {
+            store_compressed(old_page_id, page->get_data());
+        }
+        if (mode == LoadMode::READ) {
+            read_page(new_page_id, page->get_data());
+        } else {
+            // 清零时页号可能被重新使用，压缩缓存中同一页号的旧内容已经过期；
+            // 由调用者从磁盘读入时压缩缓存中的副本也不再需要，删除它使两者保持互斥
+            compressed_cache_->erase(new_page_id);
+            if (mode == LoadMode::ZERO) {
+                page->reset_memory();
+            }
+        }
+    } catch (...) {
+        lock.lock();
+        page_table_.erase(new_page_id);
+        if (!written) {
+            // 写回失败，帧中仍是旧的脏页，放回replacer
+            page->id_ = old_page_id;
+            release_claim(page, 0);
+            replacer_->unpin(new_frame_id);
+        } else {
+            // 帧放回free_list_，保持claim状态
+            if (has_old_page) {
+                page_table_.erase(old_page_id);
+            }
+            if (need_write_back) {
+                remove_dirty_page(old_page_id);
+            }
+            page->id_.fd = -1;
+            page->id_.page_no = INVALID_PAGE_ID;
+            page->is_dirty_ = false;
+            free_frame(new_frame_id);
+        }
+        page->io_in_progress_ = false;
+        page->io_cv_.notify_all();
+        throw;
+    }
+
+    lock.lock();
+    if (has_old_page) {
+        page_table_.erase(old_page_id);
+    }
+    if (need_write_back) {
+        remove_dirty_page(old_page_id);
+    }
+    page->is_dirty_ = false;
+    if (mode == LoadMode::DEFERRED) {
+        return page;
+    }
+    page->io_in_progress_ = false;
+    release_claim(page, 1);
+    page->io_cv_.notify_all();
+    return page;
+}
+
+/**
+ * @description: 将帧中的页面写回磁盘，写回期间释放latch_，帧处于io_in_progress_状态。
+ *              写回时等待页面的读锁：淘汰、刷脏和缩容只写回没有被固定的页面，不会有人持有写锁；
+ *              flush_page写回的页面可能被固定，要求调用者自己没有持有它的写锁
+ * @param {unique_lock<mutex>&} lock 已持有的latch_
+ * @param {Page*} page 要写回的页面，不能处于io_in_progress_状态
+ */
+void BufferPoolInstance::write_back(std::unique_lock<std::mutex>& lock, Page* page) {
+    PageId page_id = page->id_;
+    page->io_in_progress_ = true;
+    if (page->is_dirty_) {
+        remove_dirty_page(page_id);
+    }
+    bool was_dirty = page->is_dirty_;
+    page->is_dirty_ = false;
+    lock.unlock();
+    try {
+        // 页面可能被固定并正在修改，持有读锁写出完整的页面；释放latch_之后才等待读写锁
+        std::shared_lock page_latch{page->rwlatch_};
+        disk_manager_->write_page(page_id.fd, page_id.page_no, page->get_data(), PAGE_SIZE);
+    } catch (...) {
+        lock.lock();
+        if (was_dirty) {
+            page->is_dirty_ = true;
+            add_dirty_page(page_id);
+        }
+        page->io_in_progress_ = false;
+        page->io_cv_.notify_all();
+        throw;
+    }
+    if (was_dirty) {
+        stats_->add(BufferStat::DIRTY_WRITE_BACK, page_id.fd);
+    }
+    lock.lock();
+    page->io_in_progress_ = false;
+    page->io_cv_.notify_all();
+}
+
+/**
+ * @description: 读入一个未命中的页面，启用了压缩缓存时先在其中查找，找不到再从磁盘读入。调用时不持有latch_
+ * @param {PageId} page_id 要读入的页面
+ * @param {char*} data 帧中的页面数据
+ */
+void BufferPoolInstance::read_page(PageId page_id, char* data) {
+    if (compressed_cache_->is_enabled()) {
+        if (compressed_cache_->lookup(page_id, disk_manager_->get_fd_generation(page_id.fd), data)) {
+            stats_->add(BufferStat::TIER_HIT, page_id.fd);
+            return;
+        }
+        stats_->add(BufferStat::TIER_MISS, page_id.fd);
+    }
+    disk_manager_->read_page(page_id.fd, page_id.page_no, data, PAGE_SIZE);
+}
+
+/**
+ * @description: 把移出缓冲池的干净页面放入压缩缓存，未启用时什么都不做
+ * @param {PageId} page_id 移出的页面
+ * @param {char*} data 页面数据，必须和磁盘上的内容一致
+ */
+void BufferPoolInstance::store_compressed(PageId page_id, const char* data) {
+    if (compressed_cache_->is_enabled()) {
+        compressed_cache_->insert(page_id, disk_manager_->get_fd_generation(page_id.fd), data);
+    }
+}
+
+/**
+ * @description: 从buffer pool获取需要的页。
+ *              如果页表中存在page_id（说明该page在缓冲池中），并且pin_count++。
+ *              如果页表不存在page_id（说明该page在磁盘中），则找缓冲池victim page，将其替换为磁盘中读取的page，pin_count置1。
+ *              指定了strategy时，未命中的页面优先复用strategy环中的帧，并把使用的帧记录到环中
+ * @return {Page*} 若获得了需要的页则将其返回，否则返回nullptr
+ * @param {PageId} page_id 需要获取的页的PageId
+ * @param {BufferAccessStrategy*} strategy 扫描私有的环形缓冲区，为nullptr时使用整个缓冲池
+ * @param {bool*} read_ahead_hint 不为nullptr时，若本次访问未命中或第一次命中预读的页面则置为true，用于检测顺序访问
+ * @param {PageClass} page_class 页面类别的提示，未命中时作为页面的类别，命中时只会提高页面原来的类别
+ */
+Page* BufferPoolInstance::fetch_page(PageId page_id, BufferAccessStrategy* strategy, bool* read_ahead_hint,
+                                     PageClass page_class) {
+    //Todo:
+    // 0.     不加latch_在page_table_中查找目标页，找到后原子地固定帧，确认帧中仍是目标页则直接返回
+    // 1.     加latch_从page_table_中搜寻目标页，若目标页正在读入则等待
+    // 1.1    若目标页有被page_table_记录，则将其所在frame固定(pin)，并返回目标页。
+    // 1.2    否则，若指定了strategy，尝试复用环中下一个槽位的帧
+    // 1.3    否则，尝试调用find_victim_page获得一个可用的frame，若失败则返回nullptr
+    // 2.     调用update_page，在latch_之外写回dirty page并读取目标页到frame
+    // 3.     返回目标页
+    frame_id_t frame_id;
+    if (page_table_.find(page_id, &frame_id)) {
+        Page* page = &pages_[frame_id];
+        // 固定成功后帧不会再被claim，id_不会再变化
+        if (try_pin(page)) {
+            if (page->id_ == page_id) {
+                replacer_->pin(frame_id);
+                stats_->add(BufferStat::HIT, page_id.fd);
+                page->access_count_.store(page->access_count_.load(std::memory_order_relaxed) + 1,
+                                          std::memory_order_relaxed);
+                raise_page_class(frame_id, page, page_class);
+                // 先读一次，只有预读的页面才需要原子交换
+                if (page->prefetched_.load(std::memory_order_relaxed) && page->prefetched_.exchange(false)) {
+                    prefetch_hits_++;
+                    if (read_ahead_hint != nullptr) {
+                        *read_ahead_hint = true;
+                    }
+                }
+                return page;
+            }
+            // 查找和固定之间该帧已经换成了其他页面
+            release_pin(frame_id);
+        }
+    }
+
+    std::unique_lock lock{latch_};
+    while (!find_frame(lock, page_id, &frame_id)) {
+        BufferAccessStrategy::RingSlot* slot = strategy != nullptr ? strategy->next_slot(instance_index_) : nullptr;
+        if (slot == nullptr || !find_ring_frame(slot, &frame_id)) {
+            if (!find_victim_page(lock, &frame_id)) {
+                return nullptr;
+            }
+            // find_victim_page可能释放过latch_，若期间其他线程已经读入了目标页，则归还这一帧后按命中处理
+            frame_id_t existing;
+            if (page_table_.find(page_id, &existing)) {
+                release_victim_page(frame_id);
+                continue;
+            }
+        }
+        if (slot != nullptr) {
+            slot->frame_id = frame_id;
+            slot->page_id = page_id;
+        }
+        stats_->add(BufferStat::MISS, page_id.fd);
+        if (read_ahead_hint != nullptr) {
+            *read_ahead_hint = true;
+        }
+        return update_page(lock, page_id, frame_id, LoadMode::READ, page_class);
+    }
+    Page* page = &pages_[frame_id];
+    page->pin_count_++;
+    replacer_->pin(frame_id);
+    stats_->add(BufferStat::HIT, page_id.fd);
+    page->access_count_.store(page->access_count_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    raise_page_class(frame_id, page, page_class);
+    if (page->prefetched_.exchange(false)) {
+        prefetch_hits_++;
+        if (read_ahead_hint != nullptr) {
+            *read_ahead_hint = true;
+        }
+    }
+
+    return page;
+}
+
+/**
+ * @description: 预读一个页面：页面不在缓冲池中时像fetch_page一样读入，但读入后不固定，并标记为prefetched_。
+ *              预读不等待可用帧，缓冲池中没有可淘汰的帧时直接放弃
+ * @return {bool} 页面已经在缓冲池中或成功读入则返回true
+ * @param {PageId} page_id 要预读的页面
+ * @param {BufferAccessStrategy*} strategy 大范围扫描的环形缓冲区，为nullptr时使用整个缓冲池
+ * @param {char*} copy_out 不为nullptr时复制一份页面数据，供链式预读取出下一个页号
+ */
+bool BufferPoolInstance::prefetch_page(PageId page_id, BufferAccessStrategy* strategy, char* copy_out) {
+    std::unique_lock lock{latch_};
+    frame_id_t frame_id;
+    while (!find_frame(lock, page_id, &frame_id)) {
+        BufferAccessStrategy::RingSlot* slot = strategy != nullptr ? strategy->next_slot(instance_index_) : nullptr;
+        if (slot == nullptr || !find_ring_frame(slot, &frame_id)) {
+            if (!find_victim_page(lock, &frame_id)) {
+                return false;
+            }
+            // find_victim_page可能释放过latch_，若期间其他线程已经读入了目标页，则归还这一帧
+            frame_id_t existing;
+            if (page_table_.find(page_id, &existing)) {
+                release_victim_page(frame_id);
+                continue;
+            }
+        }
+        if (slot != nullptr) {
+            slot->frame_id = frame_id;
+            slot->page_id = page_id;
+        }
+        Page* page = update_page(lock, page_id, frame_id, LoadMode::READ,
+                                 strategy != nullptr ? PageClass::SCAN : PageClass::HEAP);
+        page->prefetched_ = true;
+        page->access_count_.store(0, std::memory_order_relaxed);
+        release_pin(frame_id);
+        prefetch_reads_++;
+        break;
+    }
+    if (copy_out != nullptr) {
+        // 持有latch_时不能等待页面的读写锁，页面正被写锁住时放弃这次链式预读
+        Page* page = &pages_[frame_id];
+        if (!page->rwlatch_.try_lock_shared()) {
+            return false;
+        }
+        memcpy(copy_out, page->get_data(), PAGE_SIZE);
+        page->rwlatch_.unlock_shared();
+    }
+    return true;
+}
+
+/**
+ * @description: 取消固定pin_count>0的在缓冲池中的page
+ * @return {bool} 如果目标页的pin_count<=0则返回false，否则返回true
+ * @param {PageId} page_id 目标page的page_id
+ * @param {bool} is_dirty 若目标page应该被标记为dirty则为true，否则为false
+ */
+bool BufferPoolInstance::unpin_page(PageId page_id, bool is_dirty) {
+    // Todo:
+    // 1. 尝试在page_table_中搜寻page_id对应的页P，调用者固定着P，P的映射不会变化，不需要加latch_
+    // 1.1 无锁查找没有找到时加latch_再找一次，P在页表中不存在 return false
+    // 2 根据参数is_dirty，加latch_更改P的is_dirty_，必须在P仍被固定时完成
+    // 3.1 若pin_count_已经小于等于0，则返回false
+    // 3.2 若pin_count_大于0，则pin_count_自减一
+    // 3.2.1 若自减后等于0，则调用replacer_的Unpin
+    frame_id_t frame_id;
+    if (!page_table_.find(page_id, &frame_id) || !(pages_[frame_id].id_ == page_id)) {
+        // 无锁查找可能漏掉正在被挪动的项
+        std::unique_lock lock{latch_};
+        if (!page_table_.find(page_id, &frame_id)) {
+            return false;
+        }
+    }
+    Page* page = &pages_[frame_id];
+    if (is_dirty && !page->is_dirty_) {
+        std::unique_lock lock{latch_};
+        if (page->pin_count_ <= 0 || !(page->id_ == page_id)) {
+            return false;
+        }
+        if (!page->is_dirty_) {
+            page->is_dirty_ = true;
+            add_dirty_page(page_id);
+        }
+    }
+    return release_pin(frame_id);
+}
+
+/**
+ * @description: 将目标页写回磁盘，不考虑当前页面是否正在被使用；调用者不能持有该页面的写锁，见write_back
+ * @return {bool} 成功则返回true，否则返回false(只有page_table_中没有目标页时)
+ * @param {PageId} page_id 目标页的page_id，不能为INVALID_PAGE_ID
+ */
+bool BufferPoolInstance::flush_page(PageId page_id) {
+    // Todo:
+    // 0. lock latch
+    // 1. 查找页表,尝试获取目标页P
+    // 1.1 目标页P没有被page_table_记录 ，返回false
+    // 2. 无论P是否为脏都将其写回磁盘。
+    // 3. 更新P的is_dirty_
+    std::unique_lock lock{latch_};
+    frame_id_t frame_id;
+    if (!find_frame(lock, page_id, &frame_id)) {
+        return false;
+    }
+    write_back(lock, &pages_[frame_id]);
+    return true;
+}
+
+/**
+ * @description: 创建一个新的page，即从磁盘中移动一个新建的空page到缓冲池某个位置。
+ * @return {Page*} 返回新创建的page，若创建失败则返回nullptr
+ * @param {PageId*} page_id 新page的page_id，页号已由BufferPoolManager分配（分区由页号决定）
+ * @param {PageClass} page_class 新页面的类别
+ */
+Page* BufferPoolInstance::new_page(PageId* page_id, PageClass page_class) {
+    // 1.   获得一个可用的frame，若无法获得则返回nullptr
+    // 2.   调用update_page，在latch_之外将frame的数据写回磁盘并清零
+    // 3.   返回获得的page
+    std::unique_lock lock{latch_};
+    frame_id_t frame_id;
+    if (!find_victim_page(lock, &frame_id)) {
+        return nullptr;
+    }
+    return update_page(lock, *page_id, frame_id, LoadMode::ZERO, page_class);
+}
+
+/**
+ * @description: 从buffer_pool删除目标页
+ * @return {bool} 如果目标页不存在于buffer_pool或者成功被删除则返回true，若其存在于buffer_pool但无法删除则返回false
+ * @param {PageId} page_id 目标页
+ */
+bool BufferPoolInstance::delete_page(PageId page_id) {
+    // 1.   在page_table_中查找目标页，若不存在返回true
+    // 2.   若目标页的pin_count不为0，则返回false
+    // 3.   将目标页数据写回磁盘，从页表中删除目标页，重置其元数据，将其加入free_list_，返回true
+    // 页面不在缓冲池中时可能在压缩缓存中
+    compressed_cache_->erase(page_id);
+    std::unique_lock lock{latch_};
+    frame_id_t frame_id;
+    if (!find_frame(lock, page_id, &frame_id)) {
+        return true;
+    }
+    Page* page = &pages_[frame_id];
+    // claim之后无锁命中不能再固定该帧，删除后帧保持claim状态放入free_list_
+    if (!claim_frame(page)) {
+        return false;
+    }
+    if (page->prefetched_) {
+        prefetch_wasted_++;
+        page->prefetched_ = false;
+    }
+    if (page->is_dirty_) {
+        remove_dirty_page(page_id);
+    }
+    page_table_.erase(page_id);
+    replacer_->pin(frame_id);
+    page->reset_memory();
+    page->id_.page_no = INVALID_PAGE_ID;
+    page->id_.fd = -1;
+    page->is_dirty_ = false;
+    free_frame(frame_id);
+    return true;
+}
+
+/**
+ * @description: 修改页面的类别，用于页面读入之后才能确定类别的情况（如B+树结点读出之后才知道是否为叶子）
+ * @param {Page*} page 本分区中被固定的页面
+ * @param {PageClass} page_class 页面的类别
+ */
+void BufferPoolInstance::set_page_class(Page* page, PageClass page_class) {
+    if (page->page_class_.exchange(page_class, std::memory_order_relaxed) != page_class) {
+        replacer_->set_page_class(static_cast<frame_id_t>(page - pages_), page_class);
+    }
+}
+
+/**
+ * @description: 命中时按提示提高页面的类别，提示不高于页面原来的类别时什么也不做，
+ *              避免扫描把常用的页面降级
+ * @param {frame_id_t} frame_id 页面所在的帧
+ * @param {Page*} page 本分区中被固定的页面
+ * @param {PageClass} page_class 页面类别的提示
+ */
+void BufferPoolInstance::raise_page_class(frame_id_t frame_id, Page* page, PageClass page_class) {
+    if (page_class > page->page_class_.load(std::memory_order_relaxed)) {
+        page->page_class_.store(page_class, std::memory_order_relaxed);
+        replacer_->set_page_class(frame_id, page_class);
+    }
+}
+
+/**
+ * @description: 将目标页标记为脏页，并记录到所属文件的脏页集合中
+ * @param {Page*} page 本分区中被固定的页面
+ */
+void BufferPoolInstance::mark_dirty(Page* page) {
+    std::unique_lock lock{latch_};
+    if (!page->is_dirty_) {
+        page->is_dirty_ = true;
+        add_dirty_page(page->id_);
+    }
+}
+
+/**
+ * @description: 取出本分区中属于fd的脏页的页号
+ * @param {int} fd 文件句柄
+ * @param {vector<page_id_t>*} page_nos 脏页的页号追加到其中
+ */
+void BufferPoolInstance::collect_dirty_pages(int fd, std::vector<page_id_t>* page_nos) {
+    std::unique_lock lock{latch_};
+    auto it = dirty_pages_.find(fd);
+    if (it != dirty_pages_.end()) {
+        page_nos->insert(page_nos->end(), it->second.begin(), it->second.end());
+    }
+}
+
+/**
+ * @description: 取出本分区中所有装有页面的帧中的页面及其访问次数
+ * @param {vector<pair<uint32_t, PageId>>*} pages (访问次数, 页面)追加到其中
+ */
+void BufferPoolInstance::collect_resident_pages(std::vector<std::pair<uint32_t, PageId>>* pages) {
+    std::unique_lock lock{latch_};
+    for (size_t i = 0; i < allocated_frames_; i++) {
+        Page* page = &pages_[i];
+        if (page->id_.page_no != INVALID_PAGE_ID) {
+            pages->emplace_back(page->access_count_.load(std::memory_order_relaxed), page->id_);
+        }
+    }
+}
+
+/**
+ * @description: 开始批量写回中的一个脏页：标记为io_in_progress_、加读锁并清除脏标记。
+ *              写回由调用者在latch_之外完成，完成后必须调用end_flush。
+ *              调用者可能同时持有多个页面的io_in_progress_，因此这里既不等待该帧上的读写，也不等待页面的读写锁，
+ *              遇到这两种情况时设置*busy，由调用者之后单独写回
+ * @return {char*} 页面数据；页面不在缓冲池中、已经不是脏页或*busy时返回nullptr
+ * @param {PageId} page_id 要写回的页面
+ * @param {bool*} busy 页面正在读写或被写锁住时设为true
+ */
+char* BufferPoolInstance::begin_flush(PageId page_id, bool* busy) {
+    std::unique_lock lock{latch_};
+    frame_id_t frame_id;
+    if (!page_table_.find(page_id, &frame_id)) {
+        return nullptr;
+    }
+    Page* page = &pages_[frame_id];
+    if (page->io_in_progress_) {
+        *busy = true;
+        return nullptr;
+    }
+    if (!page->is_dirty_) {
+        return nullptr;
+    }
+    if (!page->rwlatch_.try_lock_shared()) {
+        *busy = true;
+        return nullptr;
+    }
+    page->io_in_progress_ = true;
+    page->is_dirty_ = false;
+    remove_dirty_page(page_id);
+    return page->get_data();
+}
+
+/**
+ * @description: 结束begin_flush开始的写回，释放读锁，写回失败时恢复脏标记
+ * @param {PageId} page_id 写回的页面
+ * @param {bool} written 是否成功写入磁盘
+ */
+void BufferPoolInstance::end_flush(PageId page_id, bool written) {
+    std::unique_lock lock{latch_};
+    // 帧处于io_in_progress_状态时不会被淘汰或删除，页表项一定存在；这里不能用find_frame等待自己的io
+    frame_id_t frame_id = -1;
+    bool found = page_table_.find(page_id, &frame_id);
+    assert(found);
+    (void)found;
+    Page* page = &pages_[frame_id];
+    page->rwlatch_.unlock_shared();
+    if (!written) {
+        page->is_dirty_ = true;
+        add_dirty_page(page_id);
+    } else {
+        stats_->add(BufferStat::DIRTY_WRITE_BACK, page_id.fd);
+    }
+    page->io_in_progress_ = false;
+    page->io_cv_.notify_all();
+}
+
+/**
+ * @description: 开始批量预读中的一个页面：像prefetch_page一样为页面找到一个帧并装入页表，但不读入数据，
+ *              帧保持io_in_progress_和claim状态。数据由调用者在latch_之外读入，之后必须调用end_prefetch。
+ *              调用者可能同时持有多个帧的io_in_progress_，这些帧都已经移出replacer，不会被这里选为淘汰的帧
+ * @return {char*} 要读入的帧的页面数据；页面已经在缓冲池中（或正在读入）、或者没有可用的帧时返回nullptr
+ * @param {PageId} page_id 要预读的页面
+ * @param {BufferAccessStrategy*} strategy 大范围扫描的环形缓冲区，为nullptr时使用整个缓冲池
+ * @param {bool*} no_frame 没有可用的帧时设为true
+ */
+char* BufferPoolInstance::begin_prefetch(PageId page_id, BufferAccessStrategy* strategy, bool* no_frame) {
+    std::unique_lock lock{latch_};
+    frame_id_t frame_id;
+    if (page_table_.find(page_id, &frame_id)) {
+        return nullptr;
+    }
+    BufferAccessStrategy::RingSlot* slot = strategy != nullptr ? strategy->next_slot(instance_index_) : nullptr;
+    if (slot == nullptr || !find_ring_frame(slot, &frame_id)) {
+        if (!find_victim_page(lock, &frame_id)) {
+            *no_frame = true;
+            return nullptr;
+        }
+        // find_victim_page可能释放过latch_，若期间其他线程已经读入了目标页，则归还这一帧
+        frame_id_t existing;
+        if (page_table_.find(page_id, &existing)) {
+            release_victim_page(frame_id);
+            return nullptr;
+        }
+    }
+    if (slot != nullptr) {
+        slot->frame_id = frame_id;
+        slot->page_id = page_id;
+    }
+    Page* page = update_page(lock, page_id, frame_id, LoadMode::DEFERRED,
+                             strategy != nullptr ? PageClass::SCAN : PageClass::HEAP);
+    return page->get_data();
+}
+
+/**
+ * @description: 结束begin_prefetch开始的预读：读入成功时页面标记为prefetched_并放回replacer，
+ *              失败时页面移出页表，帧放回free_list_，等待该页面的线程之后会自己读取
+ * @param {PageId} page_id 预读的页面
+ * @param {bool} read 是否成功读入
+ */
+void BufferPoolInstance::end_prefetch(PageId page_id, bool read) {
+    std::unique_lock lock{latch_};
+    // 帧处于io_in_progress_状态时不会被淘汰或删除，页表项一定存在
+    frame_id_t frame_id = -1;
+    bool found = page_table_.find(page_id, &frame_id);
+    assert(found);
+    (void)found;
+    Page* page = &pages_[frame_id];
+    page->io_in_progress_ = false;
+    if (read) {
+        page->prefetched_ = true;
+        page->access_count_.store(0, std::memory_order_relaxed);
+        // 和prefetch_page一样先结束claim并固定，再取消固定，期间被无锁命中固定时不会放回replacer
+        release_claim(page, 1);
+        release_pin(frame_id);
+        prefetch_reads_++;
+    } else {
+        page_table_.erase(page_id);
+        page->id_.fd = -1;
+        page->id_.page_no = INVALID_PAGE_ID;
+        free_frame(frame_id);
+    }
+    page->io_cv_.notify_all();
+}
+
+/**
+ * @description: 把一个空闲帧（已claim、不在页表中）放回free_list_，缩容中超出范围的帧不放回，由resize释放
+ * @param {frame_id_t} frame_id 空闲帧
+ */
+void BufferPoolInstance::free_frame(frame_id_t frame_id) {
+    if (static_cast<size_t>(frame_id) < pool_size_) {
+        free_list_.push_back(frame_id);
+    }
+}
+
+/**
+ * @description: 把页面加入所属文件的脏页集合，调用时持有latch_
+ */
+void BufferPoolInstance::add_dirty_page(PageId page_id) {
+    if (dirty_pages_[page_id.fd].insert(page_id.page_no).second) {
+        num_dirty_pages_++;
+    }
+}
+
+/**
+ * @description: 把页面从所属文件的脏页集合中删除，调用时持有latch_
+ */
+void BufferPoolInstance::remove_dirty_page(PageId page_id) {
+    auto it = dirty_pages_.find(page_id.fd);
+    if (it == dirty_pages_.end()) {
+        return;
+    }
+    num_dirty_pages_ -= it->second.erase(page_id.page_no);
+    if (it->second.empty()) {
+        dirty_pages_.erase(it);
+    }
+}
+
+/**
+ * @description: 后台刷脏的一轮清理，由PageCleaner调用
+ *              脏页比例超过max_dirty_ratio，或者干净的可淘汰帧比例低于min_clean_ratio时，写回未固定的脏页，最多写回max_pages_per_round页。
+ *              先按replacer的淘汰顺序写回即将被淘汰的脏页，使前台淘汰时拿到干净的帧；淘汰顺序只看前面
+ *              max(min_clean_ratio * pool_size_, max_pages_per_round)个帧，其中的脏页不够时（或者策略不支持列出淘汰顺序），
+ *              再遍历各文件的脏页集合补足，同一文件内按页号顺序写回。
+ *              脏页数和replacer中的帧数都是直接维护的计数，判断是否需要写回不用扫描整个分区；
+ *              干净的可淘汰帧取空闲帧数加上replacer中的帧数再减去全部脏页数，是一个下界。
+ *              latch_内只遍历脏页集合，比扫描所有帧少得多，写回时write_back释放latch_
+ * @return {size_t} 本轮写回的页数
+ * @param {PageCleanerConfig&} config 刷脏参数
+ */
+size_t BufferPoolInstance::clean_pages(const PageCleanerConfig& config) {
+    std::unique_lock lock{latch_};
+    size_t num_dirty = num_dirty_pages_;
+    size_t num_candidates = free_list_.size() + replacer_->Size();
+    size_t num_clean_candidates = num_candidates > num_dirty ? num_candidates - num_dirty : 0;
+    if (num_dirty == 0 || (num_dirty <= config.max_dirty_ratio * pool_size_ &&
+                           num_clean_candidates >= config.min_clean_ratio * pool_size_)) {
+        return 0;
+    }
+
+    // 先选出本轮要写回的页面，write_back会释放latch_，期间脏页集合可能变化
+    std::vector<PageId> victims;
+    // 被固定的页面可能正在被修改，写回也会马上变脏，留给之后的轮次
+    auto can_clean = [this](frame_id_t frame_id) {
+        const Page* page = &pages_[frame_id];
+        return page->is_dirty_ && page->pin_count_ == 0 && !page->io_in_progress_;
+    };
+    std::vector<frame_id_t> eviction_order;
+    replacer_->eviction_order(
+        std::max(static_cast<size_t>(config.min_clean_ratio * pool_size_), config.max_pages_per_round),
+        &eviction_order);
+    for (auto it = eviction_order.begin(); it != eviction_order.end() && victims.size() < config.max_pages_per_round;
+         ++it) {
+        if (can_clean(*it)) {
+            victims.push_back(pages_[*it].id_);
+        }
+    }
+    // 按淘汰顺序选出的页面不超过max_pages_per_round个，补足时直接在其中查重
+    auto num_ordered = static_cast<std::vector<PageId>::difference_type>(victims.size());
+    for (auto it = dirty_pages_.begin(); it != dirty_pages_.end() && victims.size() < config.max_pages_per_round; ++it) {
+        int fd = it->first;
+        for (page_id_t page_no : it->second) {
+            if (victims.size() >= config.max_pages_per_round) {
+                break;
+            }
+            PageId page_id = {fd, page_no};
+            frame_id_t frame_id;
+            if (page_table_.find(page_id, &frame_id) && can_clean(frame_id) &&
+                std::find(victims.begin(), victims.begin() + num_ordered, page_id) == victims.begin() + num_ordered) {
+                victims.push_back(page_id);
+            }
+        }
+    }
+
+    size_t cleaned = 0;
+    for (PageId page_id : victims) {
+        // 前一个页面写回期间这个页面可能已经被固定、写回或淘汰，重新检查
+        frame_id_t frame_id;
+        if (!page_table_.find(page_id, &frame_id)) {
+            continue;
+        }
+        Page* page = &pages_[frame_id];
+        if (!(page->id_ == page_id) || !page->is_dirty_ || page->pin_count_ > 0 || page->io_in_progress_) {
+            continue;
+        }
+        write_back(lock, page);
+        pages_cleaned_++;
+        cleaned++;
+    }
+    return cleaned;
+}
+
+/**
+ * @description: 为帧号[first_frame, first_frame + num_frames)申请一块页面数据并清零，把各帧的data_指向其中。
+ *              这些帧还不在free_list_中，其他线程不会访问它们的数据，不需要持有latch_。
+ *              不小于FRAME_HUGE_PAGE_SIZE的块用匿名映射申请并按它对齐，提示内核使用透明大页，减少大缓冲池的TLB缺失；
+ *              内核不支持透明大页时提示不起作用，仍然是普通页面
+ * @return {FrameChunk} 申请的内存块
+ * @param {frame_id_t} first_frame 第一个帧
+ * @param {size_t} num_frames 帧的个数
+ */
+FrameChunk BufferPoolInstance::allocate_chunk(frame_id_t first_frame, size_t num_frames) {
+    FrameChunk chunk{first_frame, num_frames, nullptr, false};
+    if (num_frames == 0) {
+        return chunk;
+    }
+    size_t bytes = num_frames * PAGE_SIZE;
+    if (bytes >= FRAME_HUGE_PAGE_SIZE) {
+        // 多映射一个大页的长度，截掉首尾不对齐的部分
+        size_t map_bytes = bytes + FRAME_HUGE_PAGE_SIZE;
+        void* addr = mmap(nullptr, map_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (addr == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        char* raw = static_cast<char*>(addr);
+        char* aligned = raw + (FRAME_HUGE_PAGE_SIZE - reinterpret_cast<uintptr_t>(raw) % FRAME_HUGE_PAGE_SIZE) %
+                                  FRAME_HUGE_PAGE_SIZE;
+        if (aligned > raw) {
+            munmap(raw, aligned - raw);
+        }
+        if (aligned + bytes < raw + map_bytes) {
+            munmap(aligned + bytes, raw + map_bytes - (aligned + bytes));
+        }
+        madvise(aligned, bytes, MADV_HUGEPAGE);
+        // 匿名映射的内容已经是0
+        chunk.data = aligned;
+        chunk.mapped = true;
+    } else {
+        chunk.data = static_cast<char*>(std::aligned_alloc(PAGE_SIZE, bytes));
+        if (chunk.data == nullptr) {
+            throw std::bad_alloc();
+        }
+        memset(chunk.data, 0, bytes);
+    }
+    for (size_t i = 0; i < num_frames; i++) {
+        pages_[first_frame + i].data_ = chunk.data + i * PAGE_SIZE;
+    }
+    return chunk;
+}
+
+/**
+ * @description: 释放allocate_chunk申请的页面数据
+ */
+void BufferPoolInstance::free_chunk(const FrameChunk& chunk) {
+    if (chunk.mapped) {
+        munmap(chunk.data, chunk.num_frames * PAGE_SIZE);
+    } else {
+        std::free(chunk.data);
+    }
+}
+
+/**
+ * @description: 缩容时移出超出范围的一个帧中的页面：脏页先写回，没有被固定时claim该帧，从页表和replacer中移除。
+ *              移出后帧保持claim状态，不在free_list_中。写回时会释放latch_
+ * @return {bool} 帧已经空出来则返回true；页面被固定或正在读写时返回false，由调用者之后再试
+ * @param {unique_lock<mutex>&} lock 已持有的latch_
+ * @param {frame_id_t} frame_id 超出pool_size_的帧
+ */
+bool BufferPoolInstance::drain_frame(std::unique_lock<std::mutex>& lock, frame_id_t frame_id) {
+    Page* page = &pages_[frame_id];
+    if (page->io_in_progress_) {
+        return false;
+    }
+    if (page->id_.page_no == INVALID_PAGE_ID) {
+        // 空闲帧，已经不在free_list_中
+        return true;
+    }
+    if (page->pin_count_ > 0) {
+        return false;
+    }
+    if (page->is_dirty_) {
+        write_back(lock, page);
+        // 写回期间页面可能又被固定
+        if (page->is_dirty_ || page->io_in_progress_) {
+            return false;
+        }
+    }
+    if (!claim_frame(page)) {
+        return false;
+    }
+    PageId page_id = page->id_;
+    if (page->prefetched_) {
+        prefetch_wasted_++;
+        page->prefetched_ = false;
+    }
+    page_table_.erase(page_id);
+    replacer_->pin(frame_id);
+    // 缩容很少发生，移出的页面直接在latch_内放入压缩缓存
+    store_compressed(page_id, page->get_data());
+    page->id_.fd = -1;
+    page->id_.page_no = INVALID_PAGE_ID;
+    stats_->add(BufferStat::EVICTION, page_id.fd);
+    return true;
+}
+
+/**
+ * @description: 在运行时调整本分区的帧数，调用期间其他线程可以照常访问缓冲池。
+ *              扩容时新增的帧放入free_list_，超出已分配范围的部分申请一块新的内存；
+ *              缩容时等到超出范围的帧全部空出来才返回；到deadline时仍有页面被固定，就只缩掉最后一个
+ *              没空出来的帧之后的尾部，其余已经空出来的帧放回free_list_。完全空出来的内存块被释放。
+ *              同一个分区上的resize不能并发调用
+ * @return {bool} 缩容超时没有缩到new_pool_size时返回false
+ * @param {size_t} new_pool_size 新的帧数，限制在[1, max_pool_size_]内
+ * @param {time_point} deadline 缩容时等待页面解除固定的截止时间
+ */
+bool BufferPoolInstance::resize(size_t new_pool_size, std::chrono::steady_clock::time_point deadline) {
+    // Todo:
+    // 1 扩容：在latch_之外申请超出已分配范围的帧的内存，再加latch_把新增的帧放入free_list_
+    // 2 缩容：加latch_缩小pool_size_，从free_list_中取出超出范围的空闲帧，之后这些帧不会再装入新页面
+    // 3 逐轮移出超出范围的帧中的页面，被固定的页面等到下一轮，超时则把pool_size_恢复到最后一个没空出来的帧之后
+    // 4 从末尾释放完全空出来的内存块
+    new_pool_size = std::min(std::max<size_t>(new_pool_size, 1), max_pool_size_);
+    std::unique_lock lock{latch_};
+    size_t old_pool_size = pool_size_;
+    if (new_pool_size >= old_pool_size) {
+        if (new_pool_size > allocated_frames_) {
+            frame_id_t first_frame = static_cast<frame_id_t>(allocated_frames_);
+            lock.unlock();
+            FrameChunk chunk = allocate_chunk(first_frame, new_pool_size - first_frame);
+            lock.lock();
+            chunks_.push_back(chunk);
+            allocated_frames_ = new_pool_size;
+        }
+        // 上次缩容留下的帧已经空出来并处于claim状态，和新申请的帧一样直接放入free_list_
+        for (size_t i = old_pool_size; i < new_pool_size; i++) {
+            free_list_.push_back(static_cast<frame_id_t>(i));
+        }
+        pool_size_ = new_pool_size;
+        return true;
+    }
+
+    pool_size_ = new_pool_size;
+    free_list_.remove_if([new_pool_size](frame_id_t frame_id) {
+        return static_cast<size_t>(frame_id) >= new_pool_size;
+    });
+    size_t kept_pool_size;
+    while (true) {
+        // 最后一个没空出来的帧之后的帧都已经空出来
+        kept_pool_size = new_pool_size;
+        for (size_t i = new_pool_size; i < allocated_frames_; i++) {
+            if (!drain_frame(lock, static_cast<frame_id_t>(i))) {
+                kept_pool_size = i + 1;
+            }
+        }
+        if (kept_pool_size == new_pool_size || std::chrono::steady_clock::now() >= deadline) {
+            break;
+        }
+        lock.unlock();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        lock.lock();
+    }
+    bool drained = kept_pool_size == new_pool_size;
+    if (!drained) {
+        // 超时：[new_pool_size, kept_pool_size)重新可用。已经空出来的帧放回free_list_；
+        // 没空出来的帧在超出范围期间可能被find_victim_page从replacer中取出并跳过，未被固定的重新放回replacer
+        pool_size_ = kept_pool_size;
+        for (size_t i = new_pool_size; i < kept_pool_size; i++) {
+            frame_id_t frame_id = static_cast<frame_id_t>(i);
+            Page* page = &pages_[frame_id];
+            if (page->id_.page_no == INVALID_PAGE_ID && !page->io_in_progress_) {
+                free_list_.push_back(frame_id);
+            } else if (page->pin_count_ == 0 && !page->io_in_progress_) {
+                replacer_->unpin(frame_id);
+            }
+        }
+        new_pool_size = kept_pool_size;
+    }
+
+    std::vector<FrameChunk> released;
+    while (!chunks_.empty() && static_cast<size_t>(chunks_.back().first_frame) >= new_pool_size) {
+        FrameChunk& chunk = chunks_.back();
+        for (size_t i = 0; i < chunk.num_frames; i++) {
+            pages_[chunk.first_frame + i].data_ = nullptr;
+        }
+        allocated_frames_ = chunk.first_frame;
+        released.push_back(chunk);
+        chunks_.pop_back();
+    }
+    lock.unlock();
+    for (const FrameChunk& chunk : released) {
+        free_chunk(chunk);
+    }
+    return drained;
+}
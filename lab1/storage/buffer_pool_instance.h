@@ -0,0 +1,235 @@
+#pragma once
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <new>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "disk_manager.h"
+#include "buffer_access_strategy.h"
+#include "buffer_stats.h"
+#include "compressed_page_cache.h"
+#include "errors.h"
+#include "page.h"
+#include "page_cleaner.h"
+#include "page_table.h"
+#include "replacer/replacer.h"
+#include "replacer/replacer_factory.h"
+
+// 页面数据不小于这个大小的内存块用匿名映射申请，按它对齐并提示内核使用透明大页
+static constexpr size_t FRAME_HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+/**
+ * FrameChunk 是分区中一段连续帧的页面数据，扩容时整块申请，缩容时整块释放
+ */
+struct FrameChunk {
+    frame_id_t first_frame;     // 第一个帧的帧号
+    size_t num_frames;          // 帧的个数
+    char *data;                 // num_frames * PAGE_SIZE字节，至少按PAGE_SIZE对齐，可以直接作为O_DIRECT读写的缓冲区
+    bool mapped;                // data是否由mmap申请（按FRAME_HUGE_PAGE_SIZE对齐），否则由aligned_alloc申请
+};
+
+/**
+ * BufferPoolInstance 是缓冲池的一个分区
+ *
+ * 每个分区拥有独立的帧数组、page_table_、free_list_、replacer 和 latch_，
+ * 不同分区之间互不加锁；BufferPoolManager 按 PageId 的哈希值把页面路由到某个分区。
+ * 分区内部的 frame_id 只在本分区内有效。
+ *
+ * 磁盘读写不在 latch_ 内进行：正在读写的帧被标记为 io_in_progress_，
+ * 访问该帧的线程在帧自己的条件变量上等待，访问其他页面的线程不受影响。
+ *
+ * 命中不加 latch_：fetch_page 在 page_table_ 中无锁查找，原子地增加 pin_count_ 后确认帧中仍是目标页面；
+ * 只有未命中、帧正被淘汰或读入时才加 latch_ 走原来的路径。
+ * 淘汰、删除帧之前要先用 CAS 把 pin_count_ 从0改为负数（claim），
+ * 被 claim 的帧和空闲帧的 pin_count_ 都是负数，无锁命中的线程看到负数就撤销自己的加一。
+ *
+ * 分区可以在运行时扩容和缩容：帧号空间在构造时按 max_pool_size_ 确定，Page 对象、page_table_ 和 replacer
+ * 都按它创建，不再变化；页面数据按 FrameChunk 分块申请，帧号为 [0, pool_size_) 的帧可以装入页面。
+ * 缩容时超出范围的帧不再装入新页面，已有的页面没有被固定后写回并移出，全部空出来的内存块才释放，
+ * 其间其他页面的访问照常进行。
+ *
+ * 启用了压缩缓存时，淘汰的干净页面压缩后放入 BufferPoolManager 持有的 CompressedPageCache，
+ * 未命中时先在其中查找，找不到才读磁盘；放入和查找都在 latch_ 之外、帧处于 io_in_progress_ 状态时进行。
+ */
+class BufferPoolInstance {
+   private:
+    // update_page装入新页面的方式
+    enum class LoadMode {
+        READ,       // 从压缩缓存或磁盘读入
+        ZERO,       // new_page创建的页面，清零
+        DEFERRED,   // 由调用者在latch_之外读入，读完后调用end_prefetch
+    };
+
+    std::atomic<size_t> pool_size_;     // 本分区可容纳页面的个数，即可用帧的个数，由latch_保护修改
+    size_t max_pool_size_;  // 本分区最多的帧数，即帧号空间的大小
+    size_t instance_index_; // 本分区在BufferPoolManager中的下标
+    Page *pages_;           // 本分区的Page对象数组，长度为max_pool_size_，在构造函数中申请内存空间，在析构函数中释放
+    std::vector<FrameChunk> chunks_;    // 页面数据的内存块，按帧号顺序覆盖[0, allocated_frames_)，由latch_保护
+    size_t allocated_frames_ = 0;       // 已经分配了页面数据的帧数，缩容过程中可能大于pool_size_
+    PageTable page_table_;  // 帧号和页面号的映射哈希表，用于根据页面的PageId定位该页面的帧编号，查找不加锁
+    std::list<frame_id_t> free_list_;   // 空闲帧编号的链表
+    std::unordered_map<int, std::set<page_id_t>> dirty_pages_;  // fd -> 本分区中该文件的脏页页号，与Page::is_dirty_保持一致
+    size_t num_dirty_pages_ = 0;        // dirty_pages_中页号的总数，由latch_保护
+    DiskManager *disk_manager_;
+    Replacer *replacer_;    // 本分区的置换策略
+    BufferStats *stats_;    // 所有分区共用的事件统计，由BufferPoolManager持有
+    CompressedPageCache *compressed_cache_;     // 所有分区共用的压缩二级缓存，由BufferPoolManager持有
+    std::mutex latch_;      // 用于本分区共享数据结构的并发控制
+    std::atomic<uint64_t> pages_cleaned_{0};        // 后台刷脏写回的页数
+    std::atomic<uint64_t> foreground_write_backs_{0};  // 前台淘汰脏页时同步写回的页数
+    std::atomic<uint64_t> prefetch_reads_{0};       // 预读从磁盘读入的页数
+    std::atomic<uint64_t> prefetch_hits_{0};        // 预读的页面在被淘汰前被fetch_page访问到的次数
+    std::atomic<uint64_t> prefetch_wasted_{0};      // 预读的页面没有被访问就被淘汰或删除的次数
+
+   public:
+    /**
+     * @param max_pool_size 运行时最多扩容到的帧数，小于pool_size时取pool_size
+     */
+    BufferPoolInstance(size_t pool_size, size_t max_pool_size, size_t instance_index, DiskManager *disk_manager,
+                       BufferStats *stats, CompressedPageCache *compressed_cache,
+                       const std::string &replacer_type = REPLACER_TYPE)
+        : pool_size_(pool_size),
+          max_pool_size_(std::max(pool_size, max_pool_size)),
+          instance_index_(instance_index),
+          page_table_(max_pool_size_),
+          disk_manager_(disk_manager),
+          stats_(stats),
+          compressed_cache_(compressed_cache) {
+        // 置换策略在运行时按名称创建，名称不支持时抛出InternalError，因此在申请帧数组之前创建
+        replacer_ = create_replacer(replacer_type, max_pool_size_);
+        // Page对象按最大帧数一次申请，页面数据只为初始的pool_size_个帧申请一块
+        pages_ = new Page[max_pool_size_];
+        // 初始化时，所有的page都在free_list_中，空闲帧和还没有分配内存的帧都处于claim状态
+        for (size_t i = 0; i < max_pool_size_; ++i) {
+            pages_[i].pin_count_ = Page::PIN_COUNT_CLAIMED;
+        }
+        try {
+            chunks_.push_back(allocate_chunk(0, pool_size_));
+        } catch (...) {
+            delete[] pages_;
+            delete replacer_;
+            throw;
+        }
+        allocated_frames_ = pool_size_;
+        for (size_t i = 0; i < pool_size_; ++i) {
+            free_list_.emplace_back(static_cast<frame_id_t>(i));  // static_cast转换数据类型
+        }
+    }
+
+    ~BufferPoolInstance() {
+        for (auto &chunk : chunks_) {
+            free_chunk(chunk);
+        }
+        delete[] pages_;
+        delete replacer_;
+    }
+
+    size_t get_pool_size() const { return pool_size_; }
+
+    size_t get_max_pool_size() const { return max_pool_size_; }
+
+    size_t get_instance_index() const { return instance_index_; }
+
+    uint64_t get_pages_cleaned() const { return pages_cleaned_.load(); }
+
+    uint64_t get_foreground_write_backs() const { return foreground_write_backs_.load(); }
+
+    uint64_t get_prefetch_reads() const { return prefetch_reads_.load(); }
+
+    uint64_t get_prefetch_hits() const { return prefetch_hits_.load(); }
+
+    uint64_t get_prefetch_wasted() const { return prefetch_wasted_.load(); }
+
+   public:
+    Page* fetch_page(PageId page_id, BufferAccessStrategy* strategy = nullptr, bool* read_ahead_hint = nullptr,
+                     PageClass page_class = PageClass::HEAP);
+
+    bool prefetch_page(PageId page_id, BufferAccessStrategy* strategy, char* copy_out);
+
+    bool unpin_page(PageId page_id, bool is_dirty);
+
+    bool flush_page(PageId page_id);
+
+    Page* new_page(PageId* page_id, PageClass page_class = PageClass::HEAP);
+
+    bool delete_page(PageId page_id);
+
+    void mark_dirty(Page* page);
+
+    void set_page_class(Page* page, PageClass page_class);
+
+    void collect_dirty_pages(int fd, std::vector<page_id_t>* page_nos);
+
+    void collect_resident_pages(std::vector<std::pair<uint32_t, PageId>>* pages);
+
+    char* begin_flush(PageId page_id, bool* busy);
+
+    void end_flush(PageId page_id, bool written);
+
+    char* begin_prefetch(PageId page_id, BufferAccessStrategy* strategy, bool* no_frame);
+
+    void end_prefetch(PageId page_id, bool read);
+
+    size_t clean_pages(const PageCleanerConfig& config);
+
+    bool resize(size_t new_pool_size, std::chrono::steady_clock::time_point deadline);
+
+   private:
+    FrameChunk allocate_chunk(frame_id_t first_frame, size_t num_frames);
+
+    static void free_chunk(const FrameChunk& chunk);
+
+    bool drain_frame(std::unique_lock<std::mutex>& lock, frame_id_t frame_id);
+
+    void free_frame(frame_id_t frame_id);
+
+    void wait_for_io(std::unique_lock<std::mutex>& lock, Page* page);
+
+    bool find_frame(std::unique_lock<std::mutex>& lock, PageId page_id, frame_id_t* frame_id);
+
+    bool find_victim_page(std::unique_lock<std::mutex>& lock, frame_id_t* frame_id);
+
+    void release_victim_page(frame_id_t frame_id);
+
+    bool try_pin(Page* page);
+
+    bool release_pin(frame_id_t frame_id);
+
+    bool claim_frame(Page* page);
+
+    void release_claim(Page* page, int pin_count);
+
+    bool find_ring_frame(BufferAccessStrategy::RingSlot* slot, frame_id_t* frame_id);
+
+    Page* update_page(std::unique_lock<std::mutex>& lock, PageId new_page_id, frame_id_t new_frame_id,
+                      LoadMode mode, PageClass page_class);
+
+
+    void raise_page_class(frame_id_t frame_id, Page* page, PageClass page_class);
+
+    void write_back(std::unique_lock<std::mutex>& lock, Page* page);
+
+    void read_page(PageId page_id, char* data);
+
+    void store_compressed(PageId page_id, const char* data);
+
+    void add_dirty_page(PageId page_id);
+
+    void remove_dirty_page(PageId page_id);
+};
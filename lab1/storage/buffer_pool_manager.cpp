@@ -1,85 +1,71 @@
 #include "buffer_pool_manager.h"
 
 /**
- * @description: 从free_list或replacer中得到可淘汰帧页的 *frame_id
- * @return {bool} true: 可替换帧查找成功 , false: 可替换帧查找失败
- * @param {frame_id_t*} frame_id 帧页id指针,返回成功找到的可替换帧id
+ * @description: 从buffer pool获取需要的页，由page_id所属的分区完成
+ * @return {Page*} 若获得了需要的页则将其返回，否则返回nullptr
+ * @param {PageId} page_id 需要获取的页的PageId
+ * @param {BufferAccessStrategy*} strategy 大范围扫描私有的环形缓冲区，为nullptr时使用整个缓冲池
+ * @param {PageClass} page_class 页面类别的提示，replacer据此决定淘汰的先后，见PageClass
  */
-bool BufferPoolManager::find_victim_page(frame_id_t* frame_id) {
-    // Todo:
-    // 1 使用BufferPoolManager::free_list_判断缓冲池是否已满需要淘汰页面
-    // 1.1 未满获得frame
-    // 1.2 已满使用lru_replacer中的方法选择淘汰页面
-    if (!free_list_.empty()) {
-        *frame_id = free_list_.front();
-        free_list_.pop_front();
-        return true;
+Page* BufferPoolManager::fetch_page(PageId page_id, BufferAccessStrategy *strategy, PageClass page_class) {
+    if (strategy != nullptr && strategy->rings_.size() != num_instances_) {
+        strategy->init(num_instances_);
     }
-    return replacer_->victim(frame_id);
+    // 只有未命中和第一次命中预读页面的访问才需要交给预读检测顺序访问
+    bool read_ahead_hint = false;
+    Page* page = get_instance(page_id)->fetch_page(page_id, strategy, read_ahead_ != nullptr ? &read_ahead_hint : nullptr,
+                                                   page_class);
+    if (read_ahead_hint) {
+        read_ahead_->on_access(page_id, strategy != nullptr);
+    }
+    return page;
 }
 
 /**
- * @description: 更新页面数据, 如果为脏页则需写入磁盘，再更新为新页面，更新page元数据(data, is_dirty, page_id)和page table
- * @param {Page*} page 写回页指针
- * @param {PageId} new_page_id 新的page_id
- * @param {frame_id_t} new_frame_id 新的帧frame_id
+ * @description: 获取页面并加读锁，返回的guard析构时自动释放读锁并unpin
+ * @return {ReadPageGuard} 获取失败时返回空的guard
+ * @param {PageId} page_id 需要获取的页的PageId
+ * @param {BufferAccessStrategy*} strategy 大范围扫描私有的环形缓冲区，为nullptr时使用整个缓冲池
+ * @param {PageClass} page_class 页面类别的提示
  */
-void BufferPoolManager::update_page(Page *page, PageId new_page_id, frame_id_t new_frame_id) {
-    // Todo:
-    // 1 如果是脏页，写回磁盘，并且把dirty置为false
-    // 2 更新page table
-    // 3 重置page的data，更新page id
-    if (page->is_dirty() && page->get_page_id().page_no != INVALID_PAGE_ID) {
-        disk_manager_->write_page(page->get_page_id().fd, page->get_page_id().page_no, 
-                                  page->get_data(), PAGE_SIZE);
-        page->is_dirty_ = false;
-    }
-    if (page->get_page_id().page_no != INVALID_PAGE_ID) {
-        page_table_.erase(page->get_page_id());
-    }
-    page->reset_memory();
-    page->id_ = new_page_id;
-    if (new_page_id.page_no != INVALID_PAGE_ID) {
-        page_table_[new_page_id] = new_frame_id;
+ReadPageGuard BufferPoolManager::fetch_page_read(PageId page_id, BufferAccessStrategy *strategy, PageClass page_class) {
+    Page* page = fetch_page(page_id, strategy, page_class);
+    if (page == nullptr) {
+        return ReadPageGuard();
     }
+    // 页面已经被固定，等待读写锁时不持有任何分区的latch_
+    page->rwlatch_.lock_shared();
+    return ReadPageGuard(this, page);
 }
 
 /**
- * @description: 从buffer pool获取需要的页。
- *              如果页表中存在page_id（说明该page在缓冲池中），并且pin_count++。
- *              如果页表不存在page_id（说明该page在磁盘中），则找缓冲池victim page，将其替换为磁盘中读取的page，pin_count置1。
- * @return {Page*} 若获得了需要的页则将其返回，否则返回nullptr
+ * @description: 获取页面并加写锁，返回的guard析构时自动释放写锁并以脏页的方式unpin
+ * @return {WritePageGuard} 获取失败时返回空的guard
  * @param {PageId} page_id 需要获取的页的PageId
+ * @param {PageClass} page_class 页面类别的提示
  */
-Page* BufferPoolManager::fetch_page(PageId page_id) {
-    //Todo:
-    // 1.     从page_table_中搜寻目标页
-    // 1.1    若目标页有被page_table_记录，则将其所在frame固定(pin)，并返回目标页。
-    // 1.2    否则，尝试调用find_victim_page获得一个可用的frame，若失败则返回nullptr
-    // 2.     若获得的可用frame存储的为dirty page，则须调用updata_page将page写回到磁盘
-    // 3.     调用disk_manager_的read_page读取目标页到frame
-    // 4.     固定目标页，更新pin_count_
-    // 5.     返回目标页
-    std::scoped_lock lock{latch_};
-    auto it = page_table_.find(page_id);
-    if (it != page_table_.end()) {
-        frame_id_t frame_id = it->second;
-        Page* page = &pages_[frame_id];
-        replacer_->pin(frame_id);
-        page->pin_count_++;
-        
-        return page;
-    }
-    frame_id_t frame_id;
-    if (!find_victim_page(&frame_id)) {
-        return nullptr;
-    }
-    Page* page = &pages_[frame_id];
-    update_page(page, page_id, frame_id);
-    disk_manager_->read_page(page_id.fd, page_id.page_no, page->get_data(), PAGE_SIZE);
-    replacer_->pin(frame_id);
-    page->pin_count_ = 1;
-    return page;
+WritePageGuard BufferPoolManager::fetch_page_write(PageId page_id, PageClass page_class) {
+    Page* page = fetch_page(page_id, nullptr, page_class);
+    if (page == nullptr) {
+        return WritePageGuard();
+    }
+    page->rwlatch_.lock();
+    return WritePageGuard(this, page);
+}
+
+/**
+ * @description: 创建一个新的page并加写锁，页号的分配同new_page
+ * @return {WritePageGuard} 创建失败时返回空的guard
+ * @param {PageId*} page_id 当成功创建一个新的page时存储其page_id
+ * @param {PageClass} page_class 新页面的类别
+ */
+WritePageGuard BufferPoolManager::new_page_write(PageId* page_id, PageClass page_class) {
+    Page* page = new_page(page_id, page_class);
+    if (page == nullptr) {
+        return WritePageGuard();
+    }
+    page->rwlatch_.lock();
+    return WritePageGuard(this, page);
 }
 
 /**
@@ -89,134 +75,467 @@ Page* BufferPoolManager::fetch_page(PageId page_id) {
  * @param {bool} is_dirty 若目标page应该被标记为dirty则为true，否则为false
  */
 bool BufferPoolManager::unpin_page(PageId page_id, bool is_dirty) {
-    // Todo:
-    // 0. lock latch
-    // 1. 尝试在page_table_中搜寻page_id对应的页P
-    // 1.1 P在页表中不存在 return false
-    // 1.2 P在页表中存在，获取其pin_count_
-    // 2.1 若pin_count_已经等于0，则返回false
-    // 2.2 若pin_count_大于0，则pin_count_自减一
-    // 2.2.1 若自减后等于0，则调用replacer_的Unpin
-    // 3 根据参数is_dirty，更改P的is_dirty_
-    std::scoped_lock lock{latch_};
-    auto it = page_table_.find(page_id);
-    if (it == page_table_.end()) {
-        return false;
-    }
-    frame_id_t frame_id = it->second;
-    Page* page = &pages_[frame_id];
-    if (page->pin_count_ <= 0) {
-        return false;
-    }
-    page->pin_count_--;
-    if (page->pin_count_ == 0) {
-        replacer_->unpin(frame_id);
-    }
-    if (is_dirty) {
-        page->is_dirty_ = true;
-    }
-    return true;
+    return get_instance(page_id)->unpin_page(page_id, is_dirty);
 }
 
 /**
- * @description: 将目标页写回磁盘，不考虑当前页面是否正在被使用
+ * @description: 将目标页写回磁盘，不考虑当前页面是否正在被使用。
+ *              写回时持有页面的读锁，页面被写锁住时等到写锁释放；调用者自己不能持有该页面的WritePageGuard，否则会死锁
  * @return {bool} 成功则返回true，否则返回false(只有page_table_中没有目标页时)
  * @param {PageId} page_id 目标页的page_id，不能为INVALID_PAGE_ID
  */
 bool BufferPoolManager::flush_page(PageId page_id) {
-    // Todo:
-    // 0. lock latch
-    // 1. 查找页表,尝试获取目标页P
-    // 1.1 目标页P没有被page_table_记录 ，返回false
-    // 2. 无论P是否为脏都将其写回磁盘。
-    // 3. 更新P的is_dirty_
-    std::scoped_lock lock{latch_};
-    auto it = page_table_.find(page_id);
-    if (it == page_table_.end()) {
-        return false;
-    }
-    frame_id_t frame_id = it->second;
-    Page* page = &pages_[frame_id];
-    disk_manager_->write_page(page_id.fd, page_id.page_no, page->get_data(), PAGE_SIZE);
-    page->is_dirty_ = false;
-    return true;
+    return get_instance(page_id)->flush_page(page_id);
 }
 
 /**
  * @description: 创建一个新的page，即从磁盘中移动一个新建的空page到缓冲池某个位置。
+ *              先在fd对应的文件中分配页号（优先重用文件的空闲页面），再由页号所属的分区获取帧；
+ *              分区无可用帧时把本次分配的页号归还给文件
  * @return {Page*} 返回新创建的page，若创建失败则返回nullptr
  * @param {PageId*} page_id 当成功创建一个新的page时存储其page_id
+ * @param {PageClass} page_class 新页面的类别
  */
-Page* BufferPoolManager::new_page(PageId* page_id) {
-    // 1.   获得一个可用的frame，若无法获得则返回nullptr
-    // 2.   在fd对应的文件分配一个新的page_id
-    // 3.   将frame的数据写回磁盘
-    // 4.   固定frame，更新pin_count_
-    // 5.   返回获得的page
-    std::scoped_lock lock{latch_};
-    frame_id_t frame_id;
-    if (!find_victim_page(&frame_id)) {
-        return nullptr;
-    }
-    Page* page = &pages_[frame_id];
-    if (page->is_dirty() && page->get_page_id().page_no != INVALID_PAGE_ID) {
-        disk_manager_->write_page(page->get_page_id().fd, page->get_page_id().page_no,
-                                  page->get_data(), PAGE_SIZE);
-        page->is_dirty_ = false;
-    }
-    if (page->get_page_id().page_no != INVALID_PAGE_ID) {
-        page_table_.erase(page->get_page_id());
-    }
+Page* BufferPoolManager::new_page(PageId* page_id, PageClass page_class) {
+    std::scoped_lock lock{alloc_latch_[page_id->fd % BUFFER_POOL_INSTANCES]};
+    page_id_t num_pages = disk_manager_->get_fd2pageno(page_id->fd);
     page_id->page_no = disk_manager_->allocate_page(page_id->fd);
-    page->reset_memory();
-    page->id_ = *page_id;
-    page_table_[*page_id] = frame_id;
-    replacer_->pin(frame_id);
-    page->pin_count_ = 1;
+    BufferPoolInstance* instance = get_instance(*page_id);
+    // 页号小于分配前的页面个数说明重用了空闲页面，预读可能已经把它的旧内容读进了缓冲池
+    bool reused = page_id->page_no < num_pages;
+    Page* page = reused && !instance->delete_page(*page_id) ? nullptr : instance->new_page(page_id, page_class);
+    if (page == nullptr) {
+        // 同一个fd的分配和归还被alloc_latch_串行化，归还的页号下次分配时重用
+        disk_manager_->deallocate_page(page_id->fd, page_id->page_no);
+        page_id->page_no = INVALID_PAGE_ID;
+    }
     return page;
 }
 
 /**
- * @description: 从buffer_pool删除目标页
- * @return {bool} 如果目标页不存在于buffer_pool或者成功被删除则返回true，若其存在于buffer_pool但无法删除则返回false
+ * @description: 释放不再使用的页面：从缓冲池中删除（脏页直接丢弃），再把页号归还给文件的空闲页面列表，
+ *              之后new_page可以重用该页号，文件末尾的空闲页面会被截掉
+ * @return {bool} 页面正被固定、无法删除时返回false，页号不归还
  * @param {PageId} page_id 目标页
  */
-bool BufferPoolManager::delete_page(PageId page_id) {
-    // 1.   在page_table_中查找目标页，若不存在返回true
-    // 2.   若目标页的pin_count不为0，则返回false
-    // 3.   将目标页数据写回磁盘，从页表中删除目标页，重置其元数据，将其加入free_list_，返回true
-    std::scoped_lock lock{latch_};
-    auto it = page_table_.find(page_id);
-    if (it == page_table_.end()) {
-        return true;
-    }
-    frame_id_t frame_id = it->second;
-    Page* page = &pages_[frame_id];
-    if (page->pin_count_ > 0) {
+bool BufferPoolManager::free_page(PageId page_id) {
+    std::scoped_lock lock{alloc_latch_[page_id.fd % BUFFER_POOL_INSTANCES]};
+    if (!get_instance(page_id)->delete_page(page_id)) {
         return false;
     }
-    page_table_.erase(page_id);
-    replacer_->pin(frame_id);
-    page->reset_memory();
-    page->id_.page_no = INVALID_PAGE_ID;
-    page->id_.fd = -1;
-    page->is_dirty_ = false;
-    page->pin_count_ = 0;
-    free_list_.push_back(frame_id);
+    disk_manager_->deallocate_page(page_id.fd, page_id.page_no);
     return true;
 }
 
 /**
- * @description: 将buffer_pool中的所有页写回到磁盘
+ * @description: 重新占用一个已经用free_page归还的页号，在缓冲池中为它创建一个清零的页面并加写锁，
+ *              页号的占用见DiskManager::reclaim_page
+ * @return {WritePageGuard} 页号正在使用或者没有可用的帧时返回空的guard
+ * @param {PageId} page_id 要占用的页面
+ * @param {PageClass} page_class 页面的类别
+ */
+WritePageGuard BufferPoolManager::reclaim_page_write(PageId page_id, PageClass page_class) {
+    Page* page = nullptr;
+    {
+        std::scoped_lock lock{alloc_latch_[page_id.fd % BUFFER_POOL_INSTANCES]};
+        if (!disk_manager_->reclaim_page(page_id.fd, page_id.page_no)) {
+            return WritePageGuard();
+        }
+        BufferPoolInstance* instance = get_instance(page_id);
+        // 预读可能已经把归还后的旧内容读进了缓冲池
+        if (instance->delete_page(page_id)) {
+            page = instance->new_page(&page_id, page_class);
+        }
+        if (page == nullptr) {
+            disk_manager_->deallocate_page(page_id.fd, page_id.page_no);
+            return WritePageGuard();
+        }
+    }
+    page->rwlatch_.lock();
+    return WritePageGuard(this, page);
+}
+
+/**
+ * @description: 从buffer_pool删除目标页
+ * @return {bool} 如果目标页不存在于buffer_pool或者成功被删除则返回true，若其存在于buffer_pool但无法删除则返回false
+ * @param {PageId} page_id 目标页
+ */
+bool BufferPoolManager::delete_page(PageId page_id) {
+    return get_instance(page_id)->delete_page(page_id);
+}
+
+/**
+ * @description: 将buffer_pool中属于fd的所有脏页写回到磁盘
+ *              只写回各分区脏页集合中记录的页面，按页号排序后每次处理FLUSH_BATCH_PAGES个，
+ *              页号连续的脏页合并为一次向量写。
+ *              被写锁住的页面最后由flush_page等到写锁释放再写回，调用者不能持有fd中任何页面的WritePageGuard
  * @param {int} fd 文件句柄
  */
 void BufferPoolManager::flush_all_pages(int fd) {
-    std::scoped_lock lock{latch_};
-    for (size_t i = 0; i < pool_size_; i++) {
-        Page* page = &pages_[i];
-        if (page->get_page_id().fd == fd && page->get_page_id().page_no != INVALID_PAGE_ID) {
-            disk_manager_->write_page(fd, page->get_page_id().page_no, page->get_data(), PAGE_SIZE);
-            page->is_dirty_ = false;
+    // Todo:
+    // 1 从所有分区收集fd的脏页页号并排序
+    // 2 分批标记页面为io_in_progress_，取得页面数据
+    // 3 页号连续的页面合并为一次write_pages
+    // 4 结束io，写入失败的页面恢复脏标记
+    // 5 正在读写或被写锁住的页面不在批量写回中等待，最后逐个用flush_page写回
+    std::vector<page_id_t> page_nos;
+    for (auto instance : instances_) {
+        instance->collect_dirty_pages(fd, &page_nos);
+    }
+    std::sort(page_nos.begin(), page_nos.end());
+
+    std::vector<page_id_t> batch_page_nos;
+    std::vector<const char*> batch_data;
+    std::vector<page_id_t> busy_page_nos;
+    for (size_t begin = 0; begin < page_nos.size(); begin += FLUSH_BATCH_PAGES) {
+        size_t end = std::min(begin + FLUSH_BATCH_PAGES, page_nos.size());
+        batch_page_nos.clear();
+        batch_data.clear();
+        for (size_t i = begin; i < end; i++) {
+            PageId page_id = {fd, page_nos[i]};
+            // 收集之后页面可能已经被写回或淘汰，此时begin_flush返回nullptr
+            bool busy = false;
+            char* data = get_instance(page_id)->begin_flush(page_id, &busy);
+            if (busy) {
+                busy_page_nos.push_back(page_nos[i]);
+            } else if (data != nullptr) {
+                batch_page_nos.push_back(page_nos[i]);
+                batch_data.push_back(data);
+            }
+        }
+
+        size_t written = 0;
+        try {
+            while (written < batch_page_nos.size()) {
+                size_t run = 1;
+                while (written + run < batch_page_nos.size() &&
+                       batch_page_nos[written + run] == batch_page_nos[written] + static_cast<page_id_t>(run)) {
+                    run++;
+                }
+                disk_manager_->write_pages(fd, batch_page_nos[written], &batch_data[written], static_cast<int>(run));
+                written += run;
+            }
+        } catch (...) {
+            for (size_t i = 0; i < batch_page_nos.size(); i++) {
+                PageId page_id = {fd, batch_page_nos[i]};
+                get_instance(page_id)->end_flush(page_id, i < written);
+            }
+            throw;
+        }
+        for (auto page_no : batch_page_nos) {
+            PageId page_id = {fd, page_no};
+            get_instance(page_id)->end_flush(page_id, true);
+        }
+    }
+    // 这些页面写回时只持有自己的io_in_progress_，可以等待页面的读写锁
+    for (auto page_no : busy_page_nos) {
+        flush_page(PageId{fd, page_no});
+    }
+}
+
+/**
+ * @description: 启动后台刷脏线程，已经启动时先停止旧线程再按新参数启动
+ * @param {PageCleanerConfig&} config 刷脏参数
+ */
+void BufferPoolManager::start_page_cleaner(const PageCleanerConfig &config) {
+    stop_page_cleaner();
+    page_cleaner_ = new PageCleaner(this, config);
+}
+
+/**
+ * @description: 停止后台刷脏线程，未启动时什么也不做
+ */
+void BufferPoolManager::stop_page_cleaner() {
+    delete page_cleaner_;
+    page_cleaner_ = nullptr;
+}
+
+/**
+ * @description: 对所有分区做一轮后台刷脏
+ * @return {size_t} 本轮写回的页数
+ * @param {PageCleanerConfig&} config 刷脏参数
+ */
+size_t BufferPoolManager::clean_pages(const PageCleanerConfig &config) {
+    size_t cleaned = 0;
+    for (auto instance : instances_) {
+        cleaned += instance->clean_pages(config);
+    }
+    return cleaned;
+}
+
+/**
+ * @description: 在运行时调整缓冲池的帧数，按构造时的方式平均分配到各个分区，分区个数不变。
+ *              扩容时新增的帧作为新的内存块加入各分区；缩容时超出范围的帧等页面不再被固定后写回并移出，
+ *              内存块完全空出来才释放。超过timeout仍有页面被固定时，各分区只缩掉已经空出来的尾部，
+ *              pool_size_为各分区实际的帧数之和。期间其他线程照常访问缓冲池
+ * @return {bool} new_pool_size小于分区个数或大于max_pool_size_，或者缩容超时没有完全缩到new_pool_size时返回false
+ * @param {size_t} new_pool_size 新的帧数
+ * @param {milliseconds} timeout 缩容时等待页面解除固定的最长时间，所有分区共用
+ */
+bool BufferPoolManager::resize(size_t new_pool_size, std::chrono::milliseconds timeout) {
+    if (new_pool_size < num_instances_ || new_pool_size > max_pool_size_) {
+        return false;
+    }
+    std::scoped_lock lock{resize_latch_};
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    bool resized = true;
+    size_t pool_size = 0;
+    for (size_t i = 0; i < num_instances_; ++i) {
+        if (!instances_[i]->resize(instance_share(new_pool_size, i), deadline)) {
+            resized = false;
+        }
+        pool_size += instances_[i]->get_pool_size();
+    }
+    pool_size_ = pool_size;
+    return resized;
+}
+
+/**
+ * @description: 取出缓冲池中的所有页面，按页面装入后被访问的次数从高到低排列
+ * @return {vector<PageId>} 缓冲池中的页面，结果不是某一时刻的快照
+ */
+std::vector<PageId> BufferPoolManager::get_resident_pages() {
+    std::vector<std::pair<uint32_t, PageId>> pages;
+    for (auto instance : instances_) {
+        instance->collect_resident_pages(&pages);
+    }
+    std::stable_sort(pages.begin(), pages.end(),
+                     [](const auto &x, const auto &y) { return x.first > y.first; });
+    std::vector<PageId> page_ids;
+    page_ids.reserve(pages.size());
+    for (auto &entry : pages) {
+        page_ids.push_back(entry.second);
+    }
+    return page_ids;
+}
+
+/**
+ * @description: 启动预热线程：读取预热列表，在后台把列表中的页面读入缓冲池，之后周期性地导出预热列表。
+ *              已经启动时先停止旧线程
+ * @param {string&} file_name 预热列表文件，不存在时只做周期性导出
+ * @param {WarmUpConfig&} config 预热参数
+ */
+void BufferPoolManager::start_warm_up(const std::string &file_name, const WarmUpConfig &config) {
+    stop_warm_up();
+    warmer_ = new BufferPoolWarmer(this, disk_manager_, file_name, config);
+}
+
+/**
+ * @description: 停止预热线程，没有读完的页面不再读入，未启动时什么也不做
+ */
+void BufferPoolManager::stop_warm_up() {
+    delete warmer_;
+    warmer_ = nullptr;
+}
+
+/**
+ * @description: 把缓冲池中的页面按热度导出到预热列表，需要在关闭数据文件之前调用
+ * @return {bool} 写出成功则返回true
+ * @param {string&} file_name 预热列表文件
+ * @param {size_t} max_pages 最多导出的页面数
+ */
+bool BufferPoolManager::dump_resident_pages(const std::string &file_name, size_t max_pages) {
+    return BufferPoolWarmer::dump_resident_pages(this, disk_manager_, file_name, max_pages);
+}
+
+/**
+ * @description: 预热列表中要读入的页面数，预热线程未启动时返回0
+ */
+size_t BufferPoolManager::get_warm_up_pages_to_load() const {
+    return warmer_ != nullptr ? warmer_->get_pages_to_load() : 0;
+}
+
+/**
+ * @description: 预热线程已经处理的页面数，和get_warm_up_pages_to_load一起表示预热进度
+ */
+size_t BufferPoolManager::get_warm_up_pages_loaded() const {
+    return warmer_ != nullptr ? warmer_->get_pages_loaded() : 0;
+}
+
+/**
+ * @description: 后台刷脏线程累计写回的页数
+ */
+uint64_t BufferPoolManager::get_pages_cleaned() const {
+    uint64_t total = 0;
+    for (auto instance : instances_) {
+        total += instance->get_pages_cleaned();
+    }
+    return total;
+}
+
+/**
+ * @description: 前台淘汰脏页时仍然同步写回的页数
+ */
+uint64_t BufferPoolManager::get_foreground_write_backs() const {
+    uint64_t total = 0;
+    for (auto instance : instances_) {
+        total += instance->get_foreground_write_backs();
+    }
+    return total;
+}
+
+/**
+ * @description: fetch_page命中缓冲池的次数
+ */
+uint64_t BufferPoolManager::get_fetch_hits() const { return stats_.get(BufferStat::HIT); }
+
+/**
+ * @description: fetch_page未命中、需要从压缩缓存或磁盘读入页面的次数
+ */
+uint64_t BufferPoolManager::get_fetch_misses() const { return stats_.get(BufferStat::MISS); }
+
+/**
+ * @description: 未命中的页面在压缩缓存中找到的次数
+ */
+uint64_t BufferPoolManager::get_tier_hits() const { return stats_.get(BufferStat::TIER_HIT); }
+
+/**
+ * @description: 启用压缩缓存时，未命中的页面也不在压缩缓存中、需要读磁盘的次数
+ */
+uint64_t BufferPoolManager::get_tier_misses() const { return stats_.get(BufferStat::TIER_MISS); }
+
+/**
+ * @description: 启动预读线程，已经启动时先停止旧线程再按新参数启动。调用时不能有其他线程正在访问缓冲池
+ * @param {ReadAheadConfig&} config 预读参数
+ */
+void BufferPoolManager::start_read_ahead(const ReadAheadConfig &config) {
+    stop_read_ahead();
+    read_ahead_ = new ReadAhead(this, disk_manager_, config);
+}
+
+/**
+ * @description: 停止预读线程，未启动时什么也不做。调用时不能有其他线程正在访问缓冲池
+ */
+void BufferPoolManager::stop_read_ahead() {
+    delete read_ahead_;
+    read_ahead_ = nullptr;
+}
+
+/**
+ * @description: 把目标页读入缓冲池但不固定，由预读线程调用
+ * @return {bool} 页面已经在缓冲池中或成功读入则返回true
+ * @param {PageId} page_id 要预读的页面
+ * @param {BufferAccessStrategy*} strategy 大范围扫描的环形缓冲区，为nullptr时使用整个缓冲池
+ * @param {char*} copy_out 不为nullptr时复制一份页面数据
+ */
+bool BufferPoolManager::prefetch_page(PageId page_id, BufferAccessStrategy *strategy, char *copy_out) {
+    if (strategy != nullptr && strategy->rings_.size() != num_instances_) {
+        strategy->init(num_instances_);
+    }
+    return get_instance(page_id)->prefetch_page(page_id, strategy, copy_out);
+}
+
+/**
+ * @description: 把页号连续的多个页面读入缓冲池但不固定，由预读线程和预热线程调用。
+ *              已经在缓冲池中的页面跳过，其余页面先在各自的分区中占好帧，页号连续的一段合并为一次read_pages，
+ *              每次最多PREFETCH_BATCH_PAGES个页面，1000个页面的顺序预读只需要十几次系统调用
+ * @return {size_t} 从start开始处理完（已经在缓冲池中或成功读入）的页面数，缓冲池中没有可淘汰的帧时小于count
+ * @param {PageId} start 第一个要预读的页面
+ * @param {size_t} count 页面个数
+ * @param {BufferAccessStrategy*} strategy 大范围扫描的环形缓冲区，为nullptr时使用整个缓冲池
+ */
+size_t BufferPoolManager::prefetch_pages(PageId start, size_t count, BufferAccessStrategy *strategy) {
+    if (strategy != nullptr && strategy->rings_.size() != num_instances_) {
+        strategy->init(num_instances_);
+    }
+    // 当前一段已经占好帧、还没有读入的页面
+    page_id_t run_start = INVALID_PAGE_ID;
+    std::vector<char *> run_data;
+    run_data.reserve(PREFETCH_BATCH_PAGES);
+    // 读入当前一段并结束这些页面的预读，读入失败时这些页面全部放弃，之后由fetch_page重新读取
+    auto read_run = [&]() {
+        if (run_data.empty()) {
+            return;
+        }
+        std::exception_ptr error;
+        try {
+            disk_manager_->read_pages(start.fd, run_start, run_data.data(), static_cast<int>(run_data.size()));
+        } catch (...) {
+            error = std::current_exception();
+        }
+        for (size_t i = 0; i < run_data.size(); i++) {
+            PageId page_id = {start.fd, run_start + static_cast<page_id_t>(i)};
+            get_instance(page_id)->end_prefetch(page_id, error == nullptr);
+        }
+        run_data.clear();
+        if (error != nullptr) {
+            std::rethrow_exception(error);
+        }
+    };
+
+    size_t done = 0;
+    for (; done < count; done++) {
+        PageId page_id = {start.fd, start.page_no + static_cast<page_id_t>(done)};
+        bool no_frame = false;
+        char *data = nullptr;
+        try {
+            data = get_instance(page_id)->begin_prefetch(page_id, strategy, &no_frame);
+        } catch (...) {
+            // 淘汰的脏页写回失败，已经占好帧的页面照常读入
+            read_run();
+            throw;
+        }
+        if (data == nullptr) {
+            // 已经在缓冲池中的页面把连续的一段断开
+            read_run();
+            if (no_frame) {
+                break;
+            }
+            continue;
+        }
+        if (run_data.empty()) {
+            run_start = page_id.page_no;
         }
+        run_data.push_back(data);
+        if (run_data.size() >= PREFETCH_BATCH_PAGES) {
+            read_run();
+        }
+    }
+    read_run();
+    return done;
+}
+
+/**
+ * @description: 沿页面链表预读，预读线程未启动时什么也不做
+ * @param {PageId} start 链表中第一个要预读的页面
+ * @param {size_t} count 最多预读的页面数
+ * @param {NextPageFn} next_of 从页面数据中取出下一个页面的页号
+ */
+void BufferPoolManager::read_ahead_chain(PageId start, size_t count, NextPageFn next_of) {
+    if (read_ahead_ != nullptr) {
+        read_ahead_->read_ahead_chain(start, count, std::move(next_of));
+    }
+}
+
+/**
+ * @description: 预读从磁盘读入的页数
+ */
+uint64_t BufferPoolManager::get_prefetch_reads() const {
+    uint64_t total = 0;
+    for (auto instance : instances_) {
+        total += instance->get_prefetch_reads();
     }
-}
\ No newline at end of file
+    return total;
+}
+
+/**
+ * @description: 预读的页面在被淘汰前被访问到的次数
+ */
+uint64_t BufferPoolManager::get_prefetch_hits() const {
+    uint64_t total = 0;
+    for (auto instance : instances_) {
+        total += instance->get_prefetch_hits();
+    }
+    return total;
+}
+
+/**
+ * @description: 预读的页面没有被访问就被淘汰的次数
+ */
+uint64_t BufferPoolManager::get_prefetch_wasted() const {
+    uint64_t total = 0;
+    for (auto instance : instances_) {
+        total += instance->get_prefetch_wasted();
+    }
+    return total;
+}
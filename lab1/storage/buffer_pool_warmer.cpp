@@ -0,0 +1,207 @@
+#include "buffer_pool_warmer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <unordered_map>
+#include <utility>
+
+#include "buffer_pool_manager.h"
+
+/**
+ * @description: 读取预热列表并启动后台线程，先分批读入列表中的页面，之后周期性地导出预热列表
+ * @param {BufferPoolManager*} buffer_pool_manager 要预热的缓冲池
+ * @param {DiskManager*} disk_manager 用于把文件路径换成当前的fd
+ * @param {string&} file_name 预热列表文件，不存在时不读入任何页面
+ * @param {WarmUpConfig&} config 预热参数
+ */
+BufferPoolWarmer::BufferPoolWarmer(BufferPoolManager *buffer_pool_manager, DiskManager *disk_manager,
+                                   const std::string &file_name, const WarmUpConfig &config)
+    : buffer_pool_manager_(buffer_pool_manager),
+      disk_manager_(disk_manager),
+      file_name_(file_name),
+      config_(config),
+      stop_(false) {
+    read_list();
+    thread_ = std::thread(&BufferPoolWarmer::run, this);
+}
+
+/**
+ * @description: 通知后台线程停止并等待其退出，没有读完的页面不再读入
+ */
+BufferPoolWarmer::~BufferPoolWarmer() {
+    {
+        std::scoped_lock lock{latch_};
+        stop_ = true;
+    }
+    stop_cv_.notify_all();
+    thread_.join();
+}
+
+/**
+ * @description: 读取预热列表，只保留属于已经打开的文件、页号仍在文件范围内的页面，
+ *              最多保留min(max_pages, 缓冲池帧数)个
+ */
+void BufferPoolWarmer::read_list() {
+    std::ifstream in(file_name_);
+    if (!in) {
+        return;
+    }
+    size_t limit = std::min(config_.max_pages, buffer_pool_manager_->get_pool_size());
+    std::unordered_map<std::string, int> fds;   // 文件路径 -> fd，-1表示文件没有打开
+    std::string line;
+    while (pages_.size() < limit && std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        // 页号在最后一个空格之后
+        size_t pos = line.rfind(' ');
+        if (pos == std::string::npos) {
+            continue;
+        }
+        std::string path = line.substr(0, pos);
+        page_id_t page_no = atoi(line.c_str() + pos + 1);
+        auto it = fds.find(path);
+        if (it == fds.end()) {
+            it = fds.emplace(path, disk_manager_->find_file_fd(path)).first;
+        }
+        int fd = it->second;
+        if (fd < 0 || page_no < 0 || page_no >= disk_manager_->get_fd2pageno(fd)) {
+            continue;
+        }
+        pages_.push_back({fd, page_no});
+    }
+}
+
+/**
+ * @description: 后台线程主循环，读入预热列表中的页面，之后每隔dump_interval_ms导出一次预热列表
+ */
+void BufferPoolWarmer::run() {
+    load_pages();
+    loading_done_ = true;
+    if (config_.dump_interval_ms <= 0) {
+        return;
+    }
+    std::unique_lock lock{latch_};
+    while (!stop_) {
+        stop_cv_.wait_for(lock, std::chrono::milliseconds(config_.dump_interval_ms), [this] { return stop_; });
+        if (stop_) {
+            break;
+        }
+        lock.unlock();
+        dump_resident_pages(buffer_pool_manager_, disk_manager_, file_name_, config_.max_pages);
+        lock.lock();
+    }
+}
+
+/**
+ * @description: 从最热的页面开始，每batch_pages个页面一批，批内按(fd, page_no)排序，
+ *              页号连续的一段用一次prefetch_pages批量读入。收到停止请求或缓冲池中没有可淘汰的帧时提前结束
+ */
+void BufferPoolWarmer::load_pages() {
+    size_t batch_pages = std::max<size_t>(1, config_.batch_pages);
+    for (size_t begin = 0; begin < pages_.size(); begin += batch_pages) {
+        {
+            std::scoped_lock lock{latch_};
+            if (stop_) {
+                return;
+            }
+        }
+        size_t end = std::min(pages_.size(), begin + batch_pages);
+        std::vector<PageId> batch(pages_.begin() + begin, pages_.begin() + end);
+        std::sort(batch.begin(), batch.end(), [](const PageId &x, const PageId &y) {
+            return x.fd != y.fd ? x.fd < y.fd : x.page_no < y.page_no;
+        });
+        batch.erase(std::unique(batch.begin(), batch.end()), batch.end());
+        for (size_t run_begin = 0; run_begin < batch.size();) {
+            size_t run_end = run_begin + 1;
+            while (run_end < batch.size() && batch[run_end].fd == batch[run_begin].fd &&
+                   batch[run_end].page_no == batch[run_end - 1].page_no + 1) {
+                run_end++;
+            }
+            if (!load_run(batch.data() + run_begin, run_end - run_begin)) {
+                return;
+            }
+            run_begin = run_end;
+        }
+    }
+}
+
+/**
+ * @description: 预读页号连续的一段页面。批量读入失败时（例如文件在预热期间被截短）逐个页面重试，跳过读取失败的页面
+ * @return {bool} 缓冲池中没有可淘汰的帧时返回false
+ * @param {PageId*} pages 页号连续的页面
+ * @param {size_t} count 页面个数
+ */
+bool BufferPoolWarmer::load_run(const PageId *pages, size_t count) {
+    try {
+        size_t loaded = buffer_pool_manager_->prefetch_pages(pages[0], count);
+        pages_loaded_ += loaded;
+        return loaded == count;
+    } catch (...) {
+    }
+    for (size_t i = 0; i < count; i++) {
+        bool loaded = false;
+        try {
+            loaded = buffer_pool_manager_->prefetch_page(pages[i]);
+        } catch (...) {
+            // 文件在预热期间被删除或读取失败，跳过这个页面
+            loaded = true;
+        }
+        if (!loaded) {
+            return false;
+        }
+        pages_loaded_++;
+    }
+    return true;
+}
+
+/**
+ * @description: 导出预热列表：取出缓冲池中所有页面，按访问次数从高到低排列，最多写出max_pages个。
+ *              先写入临时文件再改名，导出中途失败不会破坏上一次的列表
+ * @return {bool} 写出成功则返回true
+ * @param {BufferPoolManager*} buffer_pool_manager 缓冲池
+ * @param {DiskManager*} disk_manager 用于把fd换成文件路径，已经关闭的文件中的页面被跳过
+ * @param {string&} file_name 预热列表文件
+ * @param {size_t} max_pages 最多写出的页面数
+ */
+bool BufferPoolWarmer::dump_resident_pages(BufferPoolManager *buffer_pool_manager, DiskManager *disk_manager,
+                                           const std::string &file_name, size_t max_pages) {
+    std::vector<PageId> pages = buffer_pool_manager->get_resident_pages();
+    std::string tmp_name = file_name + ".tmp";
+    std::ofstream out(tmp_name, std::ios::trunc);
+    if (!out) {
+        return false;
+    }
+    out << "# buffer pool warm-up list: <file path> <page_no>, hottest first\n";
+    std::unordered_map<int, std::string> paths;     // fd -> 文件路径，空串表示文件已经关闭
+    size_t written = 0;
+    for (const PageId &page_id : pages) {
+        if (written >= max_pages) {
+            break;
+        }
+        auto it = paths.find(page_id.fd);
+        if (it == paths.end()) {
+            std::string path;
+            try {
+                path = disk_manager->get_file_name(page_id.fd);
+            } catch (...) {
+                // 文件已经关闭，缓冲池中残留的页面不导出
+            }
+            it = paths.emplace(page_id.fd, path).first;
+        }
+        if (it->second.empty()) {
+            continue;
+        }
+        out << it->second << ' ' << page_id.page_no << '\n';
+        written++;
+    }
+    out.close();
+    if (!out) {
+        std::remove(tmp_name.c_str());
+        return false;
+    }
+    return std::rename(tmp_name.c_str(), file_name.c_str()) == 0;
+}
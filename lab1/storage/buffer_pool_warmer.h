@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "page.h"
+
+class BufferPoolManager;
+class DiskManager;
+
+// 预热列表文件的名称，放在数据库目录下
+static const std::string WARM_UP_FILE_NAME = "buffer_pool.warmup";
+
+/**
+ * 缓冲池预热的参数
+ */
+struct WarmUpConfig {
+    size_t max_pages = 65536;       // 最多重新读入的页面数，同时也是导出的页面数上限；实际还不超过缓冲池的帧数
+    size_t batch_pages = 64;        // 每批读入的页面数，同一批中的页面按(fd, page_no)排序后依次读入
+    int dump_interval_ms = 60000;   // 周期性导出预热列表的间隔，小于等于0时只在关闭数据库时导出
+};
+
+/**
+ * BufferPoolWarmer 在数据库重启后把上次常驻缓冲池的页面重新读入
+ *
+ * 预热列表是一个文本文件，每行一个页面 "文件路径 页号"，按热度（页面装入后被访问的次数）从高到低排列，
+ * 以 # 开头的行被忽略。关闭数据库时和运行期间每隔 dump_interval_ms 导出一次；
+ * 打开数据库时在调用线程中读取列表并把文件路径换成当前的 fd，之后由后台线程从最热的页面开始分批预读，
+ * 读入的页面不固定，和普通预读一样标记为 prefetched_。
+ * 读入的页数不超过缓冲池的帧数，避免后读入的页面把更热的页面淘汰。
+ */
+class BufferPoolWarmer {
+   public:
+    BufferPoolWarmer(BufferPoolManager *buffer_pool_manager, DiskManager *disk_manager, const std::string &file_name,
+                     const WarmUpConfig &config);
+
+    ~BufferPoolWarmer();
+
+    size_t get_pages_to_load() const { return pages_.size(); }
+
+    size_t get_pages_loaded() const { return pages_loaded_.load(); }
+
+    bool is_loading_done() const { return loading_done_.load(); }
+
+    const WarmUpConfig &get_config() const { return config_; }
+
+    static bool dump_resident_pages(BufferPoolManager *buffer_pool_manager, DiskManager *disk_manager,
+                                    const std::string &file_name, size_t max_pages);
+
+   private:
+    void read_list();
+
+    void run();
+
+    void load_pages();
+
+    bool load_run(const PageId *pages, size_t count);
+
+    BufferPoolManager *buffer_pool_manager_;
+    DiskManager *disk_manager_;
+    std::string file_name_;
+    WarmUpConfig config_;
+    std::vector<PageId> pages_;             // 要读入的页面，按热度从高到低排列
+    std::atomic<size_t> pages_loaded_{0};   // 已经处理的页面数，包括读入失败而跳过的页面
+    std::atomic<bool> loading_done_{false};
+    std::mutex latch_;                      // 保护stop_
+    std::condition_variable stop_cv_;       // 用于在等待间隔时及时响应停止请求
+    bool stop_;
+    std::thread thread_;
+};
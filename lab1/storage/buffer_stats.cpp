@@ -0,0 +1,143 @@
+#include "buffer_stats.h"
+
+/**
+ * @description: 返回当前线程使用的统计分片下标，线程第一次调用时按到达顺序轮流分配
+ */
+size_t stats_shard_index() {
+    static std::atomic<size_t> next_shard{0};
+    thread_local size_t shard = next_shard.fetch_add(1, std::memory_order_relaxed) % STATS_SHARDS;
+    return shard;
+}
+
+BufferStats::BufferStats() : shards_(new Shard[STATS_SHARDS]) { reset(); }
+
+/**
+ * @description: 获取某类事件的全局计数
+ * @param {BufferStat} stat 事件类型
+ */
+uint64_t BufferStats::get(BufferStat stat) const {
+    uint64_t total = 0;
+    for (size_t i = 0; i < STATS_SHARDS; i++) {
+        for (int slot = 0; slot <= STATS_MAX_FD; slot++) {
+            total += shards_[i].counters[slot][static_cast<size_t>(stat)].load(std::memory_order_relaxed);
+        }
+    }
+    return total;
+}
+
+/**
+ * @description: 获取某个文件上某类事件的计数
+ * @param {BufferStat} stat 事件类型
+ * @param {int} fd 文件句柄，不在[0, STATS_MAX_FD)中时返回所有这类文件的合计
+ */
+uint64_t BufferStats::get(BufferStat stat, int fd) const {
+    int slot = fd >= 0 && fd < STATS_MAX_FD ? fd : STATS_MAX_FD;
+    uint64_t total = 0;
+    for (size_t i = 0; i < STATS_SHARDS; i++) {
+        total += shards_[i].counters[slot][static_cast<size_t>(stat)].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+/**
+ * @description: 返回有过任何事件的文件句柄，按fd从小到大排列
+ */
+std::vector<int> BufferStats::get_active_fds() const {
+    std::vector<int> fds;
+    for (int fd = 0; fd < STATS_MAX_FD; fd++) {
+        for (size_t stat = 0; stat < static_cast<size_t>(BufferStat::NUM_STATS); stat++) {
+            if (get(static_cast<BufferStat>(stat), fd) != 0) {
+                fds.push_back(fd);
+                break;
+            }
+        }
+    }
+    return fds;
+}
+
+/**
+ * @description: 所有计数清零，和记录事件并发调用时，并发记录的事件可能被保留也可能被清除
+ */
+void BufferStats::reset() {
+    for (size_t i = 0; i < STATS_SHARDS; i++) {
+        for (auto &slot : shards_[i].counters) {
+            for (auto &counter : slot) {
+                counter.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
+LatencyHistogram::LatencyHistogram() : shards_(new Shard[STATS_SHARDS]) { reset(); }
+
+/**
+ * @description: 记录的延迟总个数
+ */
+uint64_t LatencyHistogram::get_count() const {
+    uint64_t total = 0;
+    for (size_t bucket = 0; bucket < NUM_BUCKETS; bucket++) {
+        total += get_bucket(bucket);
+    }
+    return total;
+}
+
+/**
+ * @description: 某个桶中的延迟个数
+ * @param {size_t} bucket 桶的下标
+ */
+uint64_t LatencyHistogram::get_bucket(size_t bucket) const {
+    uint64_t total = 0;
+    for (size_t i = 0; i < STATS_SHARDS; i++) {
+        total += shards_[i].buckets[bucket].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+/**
+ * @description: 所有延迟之和（纳秒），除以get_count()得到平均延迟
+ */
+uint64_t LatencyHistogram::get_total_ns() const {
+    uint64_t total = 0;
+    for (size_t i = 0; i < STATS_SHARDS; i++) {
+        total += shards_[i].total_ns.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+/**
+ * @description: 估计延迟的百分位数，返回该百分位数所在桶的上界
+ * @return {uint64_t} 上界（微秒），没有记录时返回0
+ * @param {double} percentile 百分位，如0.99
+ */
+uint64_t LatencyHistogram::get_percentile_us(double percentile) const {
+    uint64_t counts[NUM_BUCKETS];
+    uint64_t total = 0;
+    for (size_t bucket = 0; bucket < NUM_BUCKETS; bucket++) {
+        counts[bucket] = get_bucket(bucket);
+        total += counts[bucket];
+    }
+    if (total == 0) {
+        return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(percentile * total);
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < NUM_BUCKETS; bucket++) {
+        seen += counts[bucket];
+        if (seen > rank) {
+            return 1ULL << bucket;
+        }
+    }
+    return 1ULL << (NUM_BUCKETS - 1);
+}
+
+/**
+ * @description: 清空直方图
+ */
+void LatencyHistogram::reset() {
+    for (size_t i = 0; i < STATS_SHARDS; i++) {
+        for (auto &bucket : shards_[i].buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        shards_[i].total_ns.store(0, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// 统计计数分片的个数，线程按到达顺序轮流分配到各个分片，同一分片很少被多个线程同时写
+static constexpr size_t STATS_SHARDS = 16;
+// 单独统计的最大文件句柄，更大的fd只计入全局统计
+static constexpr int STATS_MAX_FD = 1024;
+
+/**
+ * @description: 返回当前线程使用的统计分片下标，线程第一次调用时分配
+ */
+size_t stats_shard_index();
+
+/**
+ * 缓冲池统计的事件类型
+ */
+enum class BufferStat {
+    HIT = 0,            // fetch_page命中
+    MISS,               // fetch_page未命中，需要从压缩缓存或磁盘读入
+    EVICTION,           // 淘汰了一个装有页面的帧
+    DIRTY_WRITE_BACK,   // 写回了一个脏页（淘汰、刷脏、flush）
+    PIN_WAIT,           // fetch_page/unpin_page需要等待帧上其他线程的磁盘读写
+    TIER_HIT,           // 未命中的页面在压缩缓存中找到，不需要读磁盘
+    TIER_MISS,          // 启用压缩缓存时，未命中的页面也不在压缩缓存中
+    NUM_STATS
+};
+
+/**
+ * BufferStats 记录缓冲池按文件和全局的事件计数
+ *
+ * 计数按线程分片，每个线程只增加自己分片中的计数器，读取时把所有分片相加，
+ * 因此记录一次事件只是一次不竞争的原子加法，不会成为并发访问的瓶颈；读取的结果不是某一时刻的快照。
+ * 每个分片只按文件记录，全局计数由所有文件的计数相加得到。
+ */
+class BufferStats {
+   public:
+    BufferStats();
+
+    void add(BufferStat stat, int fd, uint64_t count = 1) {
+        Shard &shard = shards_[stats_shard_index()];
+        int slot = fd >= 0 && fd < STATS_MAX_FD ? fd : STATS_MAX_FD;
+        shard.counters[slot][static_cast<size_t>(stat)].fetch_add(count, std::memory_order_relaxed);
+    }
+
+    uint64_t get(BufferStat stat) const;
+
+    uint64_t get(BufferStat stat, int fd) const;
+
+    std::vector<int> get_active_fds() const;
+
+    void reset();
+
+   private:
+    struct alignas(64) Shard {
+        // 最后一项记录fd不在[0, STATS_MAX_FD)中的事件
+        std::atomic<uint64_t> counters[STATS_MAX_FD + 1][static_cast<size_t>(BufferStat::NUM_STATS)];
+    };
+
+    std::unique_ptr<Shard[]> shards_;
+};
+
+/**
+ * LatencyHistogram 按2的幂划分区间记录延迟的分布，同样按线程分片
+ *
+ * 第0个桶记录小于1微秒的延迟，第i个桶记录[2^(i-1), 2^i)微秒的延迟，最后一个桶记录更长的延迟
+ */
+class LatencyHistogram {
+   public:
+    static constexpr size_t NUM_BUCKETS = 24;
+
+    LatencyHistogram();
+
+    void record(uint64_t latency_ns) {
+        uint64_t us = latency_ns / 1000;
+        size_t bucket = 0;
+        while (us > 0 && bucket < NUM_BUCKETS - 1) {
+            us >>= 1;
+            bucket++;
+        }
+        Shard &shard = shards_[stats_shard_index()];
+        shard.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+        shard.total_ns.fetch_add(latency_ns, std::memory_order_relaxed);
+    }
+
+    uint64_t get_count() const;
+
+    uint64_t get_bucket(size_t bucket) const;
+
+    uint64_t get_total_ns() const;
+
+    uint64_t get_percentile_us(double percentile) const;
+
+    void reset();
+
+   private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> buckets[NUM_BUCKETS];
+        std::atomic<uint64_t> total_ns;
+    };
+
+    std::unique_ptr<Shard[]> shards_;
+};
@@ -0,0 +1,334 @@
+#include "compressed_page_cache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+namespace {
+
+// 最短的匹配长度，也是哈希的字节数
+constexpr size_t MIN_MATCH = 4;
+// 最后一个匹配至少在页尾之前这么多字节开始，最后的字节总是作为字面量，和LZ4的块格式一致
+constexpr size_t MATCH_SAFE_DISTANCE = 12;
+constexpr size_t LAST_LITERALS = 5;
+constexpr int HASH_BITS = 12;
+
+inline uint32_t read32(const char *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint32_t hash32(uint32_t v) { return (v * 2654435761U) >> (32 - HASH_BITS); }
+
+// 写出一个长度的扩展部分：超过15的部分按每字节255累加，最后一个字节小于255
+inline bool write_length(char *&op, const char *op_end, size_t len) {
+    while (len >= 255) {
+        if (op >= op_end) {
+            return false;
+        }
+        *op++ = static_cast<char>(255);
+        len -= 255;
+    }
+    if (op >= op_end) {
+        return false;
+    }
+    *op++ = static_cast<char>(len);
+    return true;
+}
+
+// 写出一个序列：若干字面量，以及其后的匹配（match_len为0表示没有匹配，只在最后一个序列中出现）
+bool write_sequence(char *&op, const char *op_end, const char *literals, size_t literal_len, size_t offset,
+                    size_t match_len) {
+    if (op >= op_end) {
+        return false;
+    }
+    char *token = op++;
+    uint8_t t = static_cast<uint8_t>(std::min<size_t>(literal_len, 15) << 4);
+    if (literal_len >= 15 && !write_length(op, op_end, literal_len - 15)) {
+        return false;
+    }
+    if (static_cast<size_t>(op_end - op) < literal_len) {
+        return false;
+    }
+    memcpy(op, literals, literal_len);
+    op += literal_len;
+    if (match_len > 0) {
+        if (op_end - op < 2) {
+            return false;
+        }
+        *op++ = static_cast<char>(offset & 0xff);
+        *op++ = static_cast<char>(offset >> 8);
+        size_t len = match_len - MIN_MATCH;
+        t |= static_cast<uint8_t>(std::min<size_t>(len, 15));
+        if (len >= 15 && !write_length(op, op_end, len - 15)) {
+            return false;
+        }
+    }
+    *token = static_cast<char>(t);
+    return true;
+}
+
+// 读出一个长度的扩展部分
+inline bool read_length(const uint8_t *&ip, const uint8_t *ip_end, size_t *len) {
+    uint8_t b;
+    do {
+        if (ip >= ip_end) {
+            return false;
+        }
+        b = *ip++;
+        *len += b;
+    } while (b == 255);
+    return true;
+}
+
+}  // namespace
+
+/**
+ * @description: 按LZ4的块格式压缩一个页面：每个序列由token、字面量、2字节的偏移和匹配长度组成，
+ *              用4字节的哈希表找最近一次出现的相同4字节作为匹配。连续的零由偏移为1的重叠匹配表示，
+ *              补零的页面压缩得很小。压缩结果可以用LZ4的解压函数解压
+ * @return {size_t} 压缩后的字节数，超过dst_capacity时返回0
+ * @param {char*} src PAGE_SIZE字节的页面
+ * @param {char*} dst 压缩结果
+ * @param {size_t} dst_capacity dst的大小
+ */
+size_t compress_page(const char *src, char *dst, size_t dst_capacity) {
+    int table[1 << HASH_BITS];
+    std::fill(std::begin(table), std::end(table), -1);
+    const size_t n = PAGE_SIZE;
+    const size_t match_limit = n - MATCH_SAFE_DISTANCE;
+    char *op = dst;
+    const char *op_end = dst + dst_capacity;
+    size_t anchor = 0;
+    size_t ip = 0;
+    while (ip < match_limit) {
+        uint32_t seq = read32(src + ip);
+        uint32_t h = hash32(seq);
+        int ref = table[h];
+        table[h] = static_cast<int>(ip);
+        if (ref < 0 || ip - ref > 0xffff || read32(src + ref) != seq) {
+            // 长时间没有匹配时加快步长，不可压缩的数据不会逐字节查找
+            ip += 1 + ((ip - anchor) >> 6);
+            continue;
+        }
+        size_t match_len = MIN_MATCH;
+        while (ip + match_len < n - LAST_LITERALS && src[ref + match_len] == src[ip + match_len]) {
+            match_len++;
+        }
+        if (!write_sequence(op, op_end, src + anchor, ip - anchor, ip - ref, match_len)) {
+            return 0;
+        }
+        ip += match_len;
+        anchor = ip;
+    }
+    if (!write_sequence(op, op_end, src + anchor, n - anchor, 0, 0)) {
+        return 0;
+    }
+    return op - dst;
+}
+
+/**
+ * @description: 解压compress_page的结果
+ * @return {bool} 数据完整且正好解压出PAGE_SIZE字节则返回true
+ * @param {char*} src 压缩后的数据
+ * @param {size_t} src_size 压缩后的字节数
+ * @param {char*} dst PAGE_SIZE字节的页面
+ */
+bool decompress_page(const char *src, size_t src_size, char *dst) {
+    const uint8_t *ip = reinterpret_cast<const uint8_t *>(src);
+    const uint8_t *ip_end = ip + src_size;
+    char *op = dst;
+    char *op_end = dst + PAGE_SIZE;
+    while (ip < ip_end) {
+        uint8_t token = *ip++;
+        size_t literal_len = token >> 4;
+        if (literal_len == 15 && !read_length(ip, ip_end, &literal_len)) {
+            return false;
+        }
+        if (static_cast<size_t>(ip_end - ip) < literal_len || static_cast<size_t>(op_end - op) < literal_len) {
+            return false;
+        }
+        memcpy(op, ip, literal_len);
+        ip += literal_len;
+        op += literal_len;
+        if (ip == ip_end) {
+            // 最后一个序列只有字面量
+            break;
+        }
+        if (ip_end - ip < 2) {
+            return false;
+        }
+        size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        size_t match_len = token & 0xf;
+        if (match_len == 15 && !read_length(ip, ip_end, &match_len)) {
+            return false;
+        }
+        match_len += MIN_MATCH;
+        if (offset == 0 || offset > static_cast<size_t>(op - dst) || static_cast<size_t>(op_end - op) < match_len) {
+            return false;
+        }
+        // 匹配可能和正在写出的部分重叠，逐字节复制
+        const char *ref = op - offset;
+        for (size_t i = 0; i < match_len; i++) {
+            op[i] = ref[i];
+        }
+        op += match_len;
+    }
+    return op == op_end;
+}
+
+CompressedPageCache::CompressedPageCache(size_t capacity_bytes)
+    : capacity_(capacity_bytes), shards_(new Shard[COMPRESSED_CACHE_SHARDS]) {}
+
+/**
+ * @description: 调整内存预算，缩小时立即丢弃超出预算的页面，设为0时清空并停用
+ * @param {size_t} capacity_bytes 新的内存预算（字节）
+ */
+void CompressedPageCache::set_capacity(size_t capacity_bytes) {
+    capacity_ = capacity_bytes;
+    for (size_t i = 0; i < COMPRESSED_CACHE_SHARDS; i++) {
+        std::scoped_lock lock{shards_[i].latch};
+        shrink(shards_[i], capacity_bytes / COMPRESSED_CACHE_SHARDS);
+    }
+}
+
+/**
+ * @description: 放入一个从缓冲池淘汰的干净页面，已经存在时替换。压缩在分片的锁之外进行，
+ *              压缩后超过MAX_COMPRESSED_PAGE_SIZE的页面不放入
+ * @param {PageId} page_id 页面
+ * @param {uint32_t} generation 页面所在文件当前的generation
+ * @param {char*} data PAGE_SIZE字节的页面数据
+ */
+void CompressedPageCache::insert(PageId page_id, uint32_t generation, const char *data) {
+    if (!is_enabled()) {
+        return;
+    }
+    char buf[MAX_COMPRESSED_PAGE_SIZE];
+    size_t size = compress_page(data, buf, sizeof(buf));
+    Shard &shard = get_shard(page_id);
+    if (size == 0) {
+        rejects_++;
+        // 旧的内容已经过期
+        erase(page_id);
+        return;
+    }
+    Entry entry{page_id, generation, static_cast<uint32_t>(size), std::unique_ptr<char[]>(new char[size])};
+    memcpy(entry.data.get(), buf, size);
+
+    std::scoped_lock lock{shard.latch};
+    auto it = shard.map.find(page_id);
+    if (it != shard.map.end()) {
+        remove(shard, it->second);
+    }
+    shard.lru.push_front(std::move(entry));
+    shard.map[page_id] = shard.lru.begin();
+    shard.bytes_used += size + COMPRESSED_ENTRY_OVERHEAD;
+    shard.num_pages++;
+    inserts_++;
+    shrink(shard, get_capacity() / COMPRESSED_CACHE_SHARDS);
+}
+
+/**
+ * @description: 查找页面，找到后解压到data中并从缓存中删除（页面回到缓冲池）
+ * @return {bool} 找到且generation一致则返回true
+ * @param {PageId} page_id 页面
+ * @param {uint32_t} generation 页面所在文件当前的generation，不一致说明fd已经被其他文件重用
+ * @param {char*} data 解压的目标，PAGE_SIZE字节
+ */
+bool CompressedPageCache::lookup(PageId page_id, uint32_t generation, char *data) {
+    if (!is_enabled()) {
+        return false;
+    }
+    Shard &shard = get_shard(page_id);
+    Entry entry;
+    {
+        std::scoped_lock lock{shard.latch};
+        auto it = shard.map.find(page_id);
+        if (it == shard.map.end()) {
+            return false;
+        }
+        entry = std::move(*it->second);
+        remove(shard, it->second);
+    }
+    // 解压在锁之外进行
+    return entry.generation == generation && decompress_page(entry.data.get(), entry.size, data);
+}
+
+/**
+ * @description: 删除页面，页面不在缓存中时什么都不做
+ * @param {PageId} page_id 页面
+ */
+void CompressedPageCache::erase(PageId page_id) {
+    // 停用时缓存一定是空的：set_capacity(0)清空所有分片，并发的insert放入之后也会按0的预算丢弃
+    if (!is_enabled()) {
+        return;
+    }
+    Shard &shard = get_shard(page_id);
+    std::scoped_lock lock{shard.latch};
+    auto it = shard.map.find(page_id);
+    if (it != shard.map.end()) {
+        remove(shard, it->second);
+    }
+}
+
+/**
+ * @description: 删除所有页面
+ */
+void CompressedPageCache::clear() {
+    for (size_t i = 0; i < COMPRESSED_CACHE_SHARDS; i++) {
+        std::scoped_lock lock{shards_[i].latch};
+        shrink(shards_[i], 0);
+    }
+}
+
+/**
+ * @description: 缓存中的页面个数
+ */
+size_t CompressedPageCache::get_num_pages() const {
+    size_t total = 0;
+    for (size_t i = 0; i < COMPRESSED_CACHE_SHARDS; i++) {
+        std::scoped_lock lock{shards_[i].latch};
+        total += shards_[i].num_pages;
+    }
+    return total;
+}
+
+/**
+ * @description: 占用的内存（字节），包括每个页面COMPRESSED_ENTRY_OVERHEAD的额外开销
+ */
+size_t CompressedPageCache::get_bytes_used() const {
+    size_t total = 0;
+    for (size_t i = 0; i < COMPRESSED_CACHE_SHARDS; i++) {
+        std::scoped_lock lock{shards_[i].latch};
+        total += shards_[i].bytes_used;
+    }
+    return total;
+}
+
+CompressedPageCache::Shard &CompressedPageCache::get_shard(PageId page_id) {
+    // 缓冲池按PageIdHash的低位选择分区，这里先打散，避免同一分区的页面都落在同一个分片上
+    uint64_t h = static_cast<uint64_t>(PageIdHash()(page_id)) * 0x9E3779B97F4A7C15ULL;
+    return shards_[(h >> 32) % COMPRESSED_CACHE_SHARDS];
+}
+
+/**
+ * @description: 从分片中删除一个页面，调用时持有分片的latch
+ */
+void CompressedPageCache::remove(Shard &shard, std::list<Entry>::iterator it) {
+    shard.bytes_used -= it->size + COMPRESSED_ENTRY_OVERHEAD;
+    shard.num_pages--;
+    shard.map.erase(it->page_id);
+    shard.lru.erase(it);
+}
+
+/**
+ * @description: 从LRU链表尾部丢弃页面，直到分片占用的内存不超过limit，调用时持有分片的latch
+ */
+void CompressedPageCache::shrink(Shard &shard, size_t limit) {
+    while (shard.bytes_used > limit && !shard.lru.empty()) {
+        remove(shard, std::prev(shard.lru.end()));
+        evictions_++;
+    }
+}
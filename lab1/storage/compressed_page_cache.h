@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "page.h"
+
+// 压缩后超过这个大小的页面不放入压缩缓存，压缩率太低时省下的内存不值得解压的开销
+static constexpr size_t MAX_COMPRESSED_PAGE_SIZE = PAGE_SIZE * 3 / 4;
+// 每个压缩页面在哈希表和链表中的额外开销估计，和压缩后的数据一起计入内存预算
+static constexpr size_t COMPRESSED_ENTRY_OVERHEAD = 64;
+// 压缩缓存的分片个数，每个分片有独立的锁、LRU链表和1/COMPRESSED_CACHE_SHARDS的内存预算
+static constexpr size_t COMPRESSED_CACHE_SHARDS = 16;
+
+size_t compress_page(const char *src, char *dst, size_t dst_capacity);
+
+bool decompress_page(const char *src, size_t src_size, char *dst);
+
+/**
+ * CompressedPageCache 是缓冲池之下的压缩二级缓存
+ *
+ * 从缓冲池淘汰的干净页面（包括淘汰时刚写回的脏页）压缩后放入这里，缓冲池未命中时先在这里查找，
+ * 找到就解压到帧中，不再调用 DiskManager::read_page。二级缓存和缓冲池是互斥的：
+ * 页面解压回缓冲池时从这里删除，因此这里的页面一定和磁盘上的内容一致，不需要写回。
+ * new_page、delete_page 也会删除这里的同一页面，避免之后读到页号被重新使用之前的内容。
+ *
+ * 页面按 LZ4 的块格式压缩（见 compress_page），CHAR(n) 列补零的表页面通常能压缩到几分之一；
+ * 压缩后仍大于 MAX_COMPRESSED_PAGE_SIZE 的页面不放入。
+ * 内存预算按压缩后的大小加上 COMPRESSED_ENTRY_OVERHEAD 计算，超出预算时按 LRU 丢弃；预算为0时不启用。
+ * 每个页面记录放入时文件的 generation（见 DiskManager::get_fd_generation），文件关闭后 fd 被其他文件重用时不会命中旧页面。
+ */
+class CompressedPageCache {
+   public:
+    explicit CompressedPageCache(size_t capacity_bytes = 0);
+
+    void set_capacity(size_t capacity_bytes);
+
+    size_t get_capacity() const { return capacity_.load(std::memory_order_relaxed); }
+
+    bool is_enabled() const { return get_capacity() > 0; }
+
+    void insert(PageId page_id, uint32_t generation, const char *data);
+
+    bool lookup(PageId page_id, uint32_t generation, char *data);
+
+    void erase(PageId page_id);
+
+    void clear();
+
+    size_t get_num_pages() const;
+
+    size_t get_bytes_used() const;
+
+    uint64_t get_inserts() const { return inserts_.load(); }
+
+    uint64_t get_rejects() const { return rejects_.load(); }
+
+    uint64_t get_evictions() const { return evictions_.load(); }
+
+   private:
+    struct Entry {
+        PageId page_id;
+        uint32_t generation;            // 放入时文件的generation
+        uint32_t size;                  // 压缩后的字节数
+        std::unique_ptr<char[]> data;   // 压缩后的页面数据
+    };
+
+    struct Shard {
+        mutable std::mutex latch;       // 保护本分片的lru和map
+        std::list<Entry> lru;           // 最近放入的页面在表头，超出预算时从表尾丢弃
+        std::unordered_map<PageId, std::list<Entry>::iterator, PageIdHash> map;
+        size_t bytes_used = 0;          // 本分片占用的内存，按压缩后大小加COMPRESSED_ENTRY_OVERHEAD计算
+        size_t num_pages = 0;
+    };
+
+    Shard &get_shard(PageId page_id);
+
+    void remove(Shard &shard, std::list<Entry>::iterator it);
+
+    void shrink(Shard &shard, size_t limit);
+
+    std::atomic<size_t> capacity_;              // 所有分片的内存预算之和
+    std::unique_ptr<Shard[]> shards_;
+    std::atomic<uint64_t> inserts_{0};          // 放入的页面数
+    std::atomic<uint64_t> rejects_{0};          // 压缩率太低而没有放入的页面数
+    std::atomic<uint64_t> evictions_{0};        // 超出预算或清空时被丢弃的页面数
+};
@@ -3,13 +3,40 @@
 #include <assert.h>    // for assert
 #include <string.h>    // for memset
 #include <sys/stat.h>  // for stat
-#include <unistd.h>    // for lseek
+#include <unistd.h>    // for pread/pwrite
 
 #include "defs.h"
 #include <fcntl.h>
 #include <errno.h>
+#include <limits.h>    // for IOV_MAX
+#include <linux/falloc.h>  // for FALLOC_FL_KEEP_SIZE
+#include <sys/mman.h>  // for mmap/madvise
+#include <sys/uio.h>   // for pwritev
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iterator>
+#include <vector>
 DiskManager::DiskManager() { memset(fd2pageno_, 0, MAX_FD * (sizeof(std::atomic<page_id_t>) / sizeof(char))); }
 
+/**
+ * @description: 先销毁LogWriter，它在退出前写完并持久化缓冲区中剩余的日志，之后才能关闭日志文件的句柄
+ */
+DiskManager::~DiskManager() {
+    log_writer_ptr_.store(nullptr, std::memory_order_release);
+    log_writer_.reset();
+    if (log_fd_ != -1) {
+        close(log_fd_);
+    }
+}
+
+// 从start到现在经过的纳秒数
+static uint64_t elapsed_ns(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
 /**
  * @description: 将数据写入文件的指定磁盘页面中
  * @param {int} fd 磁盘文件的文件句柄
@@ -19,13 +46,16 @@ DiskManager::DiskManager() { memset(fd2pageno_, 0, MAX_FD * (sizeof(std::atomic<
  */
 void DiskManager::write_page(int fd, page_id_t page_no, const char *offset, int num_bytes) {
     // Todo:
-    // 1.lseek()定位到文件头，通过(fd,page_no)可以定位指定页面及其在磁盘文件中的偏移量
-    long offset_bytes = static_cast<long>(page_no) * PAGE_SIZE;
-    if (lseek(fd, offset_bytes, SEEK_SET) == -1) {
-        throw InternalError("DiskManager::write_page Error: lseek failed.");
+    // 1.通过(fd,page_no)可以定位指定页面及其在磁盘文件中的偏移量
+    // 2.调用pwrite()函数，直接在指定偏移量写入，不修改共享的文件偏移量，多个线程可以同时读写同一个文件
+    off_t offset_bytes = static_cast<off_t>(page_no) * PAGE_SIZE;
+    if (needs_bounce(fd, offset, num_bytes)) {
+        write_page_bounced(fd, offset_bytes, offset, num_bytes);
+        return;
     }
-    // 2.调用write()函数
-    ssize_t bytes_written = write(fd, offset, num_bytes);
+    auto start = std::chrono::steady_clock::now();
+    ssize_t bytes_written = pwrite(fd, offset, num_bytes, offset_bytes);
+    write_latency_.record(elapsed_ns(start));
     // 注意write返回值与num_bytes不等时 throw InternalError("DiskManager::write_page Error");
     if (bytes_written != num_bytes) {
         throw InternalError("DiskManager::write_page Error: Incomplete write or write failed.");
@@ -41,13 +71,16 @@ void DiskManager::write_page(int fd, page_id_t page_no, const char *offset, int
  */
 void DiskManager::read_page(int fd, page_id_t page_no, char *offset, int num_bytes) {
     // Todo:
-    // 1.lseek()定位到文件头，通过(fd,page_no)可以定位指定页面及其在磁盘文件中的偏移量
-    long offset_bytes = static_cast<long>(page_no) * PAGE_SIZE;
-    if (lseek(fd, offset_bytes, SEEK_SET) == -1) {
-        throw InternalError("DiskManager::read_page Error: lseek failed.");
+    // 1.通过(fd,page_no)可以定位指定页面及其在磁盘文件中的偏移量
+    // 2.调用pread()函数，同write_page，不依赖共享的文件偏移量
+    off_t offset_bytes = static_cast<off_t>(page_no) * PAGE_SIZE;
+    if (needs_bounce(fd, offset, num_bytes)) {
+        read_page_bounced(fd, offset_bytes, offset, num_bytes);
+        return;
     }
-    // 2.调用read()函数
-    ssize_t bytes_read = read(fd, offset, num_bytes);
+    auto start = std::chrono::steady_clock::now();
+    ssize_t bytes_read = pread(fd, offset, num_bytes, offset_bytes);
+    read_latency_.record(elapsed_ns(start));
     // 注意read返回值与num_bytes不等时，throw InternalError("DiskManager::read_page Error");
     if (bytes_read != num_bytes) {
         throw InternalError("DiskManager::read_page Error: Incomplete read or read failed.");
@@ -55,17 +88,400 @@ void DiskManager::read_page(int fd, page_id_t page_no, char *offset, int num_byt
 }
 
 /**
- * @description: 分配一个新的页号
+ * @description: O_DIRECT打开的文件要求缓冲区地址和读写长度都按页面对齐，缓冲池的帧满足这个要求；
+ *              文件头等不对齐的读写经过一个对齐的临时缓冲区（见read_page_bounced/write_page_bounced）
+ * @return {bool} 需要经过临时缓冲区时返回true
+ */
+bool DiskManager::needs_bounce(int fd, const char *buf, int num_bytes) const {
+    return direct_io_fds_[fd].load(std::memory_order_relaxed) &&
+           (reinterpret_cast<uintptr_t>(buf) % PAGE_SIZE != 0 || num_bytes % PAGE_SIZE != 0);
+}
+
+/**
+ * @description: 按页面对齐的长度读入临时缓冲区，再复制出num_bytes字节
+ */
+void DiskManager::read_page_bounced(int fd, off_t offset_bytes, char *buf, int num_bytes) {
+    size_t len = (static_cast<size_t>(num_bytes) + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE;
+    std::unique_ptr<char, decltype(&std::free)> bounce(static_cast<char *>(std::aligned_alloc(PAGE_SIZE, len)),
+                                                       &std::free);
+    if (bounce == nullptr) {
+        throw std::bad_alloc();
+    }
+    auto start = std::chrono::steady_clock::now();
+    ssize_t bytes_read = pread(fd, bounce.get(), len, offset_bytes);
+    read_latency_.record(elapsed_ns(start));
+    // 文件末尾的页面可能不完整，只要读到了需要的部分即可
+    if (bytes_read < num_bytes) {
+        throw InternalError("DiskManager::read_page Error: Incomplete read or read failed.");
+    }
+    memcpy(buf, bounce.get(), num_bytes);
+}
+
+/**
+ * @description: 长度不是页面的整数倍时先读出所在的页面，改写前num_bytes字节后整页写回，页面原有的其余部分不变
+ */
+void DiskManager::write_page_bounced(int fd, off_t offset_bytes, const char *buf, int num_bytes) {
+    size_t len = (static_cast<size_t>(num_bytes) + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE;
+    std::unique_ptr<char, decltype(&std::free)> bounce(static_cast<char *>(std::aligned_alloc(PAGE_SIZE, len)),
+                                                       &std::free);
+    if (bounce == nullptr) {
+        throw std::bad_alloc();
+    }
+    if (len != static_cast<size_t>(num_bytes)) {
+        // 超出文件末尾的部分读不到，按0填充；读取失败时不能把0当作页面原有的内容写回
+        ssize_t bytes_read = pread(fd, bounce.get(), len, offset_bytes);
+        if (bytes_read < 0) {
+            throw UnixError();
+        }
+        memset(bounce.get() + bytes_read, 0, len - bytes_read);
+    }
+    memcpy(bounce.get(), buf, num_bytes);
+    auto start = std::chrono::steady_clock::now();
+    ssize_t bytes_written = pwrite(fd, bounce.get(), len, offset_bytes);
+    write_latency_.record(elapsed_ns(start));
+    if (bytes_written != static_cast<ssize_t>(len)) {
+        throw InternalError("DiskManager::write_page Error: Incomplete write or write failed.");
+    }
+}
+
+/**
+ * @description: 把页号连续的多个页面用一次pwritev写入文件，页面数据在内存中不需要连续
+ * @param {int} fd 磁盘文件的文件句柄
+ * @param {page_id_t} start_page_no 第一个页面的页号，第i个页面写入start_page_no + i
+ * @param {char**} pages 各个页面的数据，每个页面PAGE_SIZE字节
+ * @param {int} num_pages 页面个数
+ */
+void DiskManager::write_pages(int fd, page_id_t start_page_no, const char *const *pages, int num_pages) {
+    if (!is_aligned(fd, pages, num_pages)) {
+        for (int i = 0; i < num_pages; i++) {
+            write_page(fd, start_page_no + i, pages[i], PAGE_SIZE);
+        }
+        return;
+    }
+    int done = 0;
+    while (done < num_pages) {
+        int batch = std::min(num_pages - done, IOV_MAX);
+        std::vector<struct iovec> iov(batch);
+        for (int i = 0; i < batch; i++) {
+            iov[i].iov_base = const_cast<char *>(pages[done + i]);
+            iov[i].iov_len = PAGE_SIZE;
+        }
+        off_t offset_bytes = static_cast<off_t>(start_page_no + done) * PAGE_SIZE;
+        auto start = std::chrono::steady_clock::now();
+        ssize_t bytes_written = pwritev(fd, iov.data(), batch, offset_bytes);
+        write_latency_.record(elapsed_ns(start));
+        if (bytes_written < 0) {
+            throw InternalError("DiskManager::write_pages Error: write failed.");
+        }
+        // 只写入了一部分时，从第一个没有完整写入的页面重新写（重写一个页面的前半部分没有影响）
+        int written_pages = bytes_written / PAGE_SIZE;
+        if (written_pages == 0) {
+            write_page(fd, start_page_no + done, pages[done], PAGE_SIZE);
+            written_pages = 1;
+        }
+        done += written_pages;
+    }
+}
+
+/**
+ * @description: 把页号连续的多个页面用一次preadv读入，页面数据在内存中不需要连续
+ * @param {int} fd 磁盘文件的文件句柄
+ * @param {page_id_t} start_page_no 第一个页面的页号，第i个页面从start_page_no + i读入
+ * @param {char**} pages 各个页面的缓冲区，每个页面PAGE_SIZE字节
+ * @param {int} num_pages 页面个数
+ */
+void DiskManager::read_pages(int fd, page_id_t start_page_no, char *const *pages, int num_pages) {
+    if (!is_aligned(fd, pages, num_pages)) {
+        for (int i = 0; i < num_pages; i++) {
+            read_page(fd, start_page_no + i, pages[i], PAGE_SIZE);
+        }
+        return;
+    }
+    int done = 0;
+    while (done < num_pages) {
+        int batch = std::min(num_pages - done, IOV_MAX);
+        std::vector<struct iovec> iov(batch);
+        for (int i = 0; i < batch; i++) {
+            iov[i].iov_base = pages[done + i];
+            iov[i].iov_len = PAGE_SIZE;
+        }
+        off_t offset_bytes = static_cast<off_t>(start_page_no + done) * PAGE_SIZE;
+        auto start = std::chrono::steady_clock::now();
+        ssize_t bytes_read = preadv(fd, iov.data(), batch, offset_bytes);
+        read_latency_.record(elapsed_ns(start));
+        if (bytes_read < 0) {
+            throw InternalError("DiskManager::read_pages Error: read failed.");
+        }
+        // 只读入了一部分时，从第一个没有完整读入的页面重新读；读到文件末尾时由read_page报错
+        int read_pages = bytes_read / PAGE_SIZE;
+        if (read_pages == 0) {
+            read_page(fd, start_page_no + done, pages[done], PAGE_SIZE);
+            read_pages = 1;
+        }
+        done += read_pages;
+    }
+}
+
+/**
+ * @description: 向量读写的各个页面缓冲区是否都满足O_DIRECT的对齐要求，不满足时逐页经过临时缓冲区读写
+ * @return {bool} 文件不是O_DIRECT打开或所有缓冲区都按页面对齐时返回true
+ */
+bool DiskManager::is_aligned(int fd, const char *const *pages, int num_pages) const {
+    if (!direct_io_fds_[fd].load(std::memory_order_relaxed)) {
+        return true;
+    }
+    for (int i = 0; i < num_pages; i++) {
+        if (reinterpret_cast<uintptr_t>(pages[i]) % PAGE_SIZE != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @description: 创建一个异步读写页面的队列，内核支持io_uring时使用io_uring，否则退回到同步的pread/pwrite。
+ *              队列只能由一个线程使用，见IoQueue
+ * @return {unique_ptr<IoQueue>} 新的队列
+ * @param {unsigned} depth 同时在途的请求数上限
+ * @param {bool} allow_async 为false时总是使用同步的队列
+ */
+std::unique_ptr<IoQueue> DiskManager::create_io_queue(unsigned depth, bool allow_async) {
+    depth = std::max(depth, 1u);
+    if (allow_async) {
+        std::unique_ptr<IoQueue> queue = UringIoQueue::create(depth);
+        if (queue != nullptr) {
+            return queue;
+        }
+    }
+    return std::make_unique<SyncIoQueue>(depth);
+}
+
+/**
+ * @description: 分配一个新的页号，优先重用文件空闲页面列表中最小的页号，没有空闲页面时在文件末尾分配
  * @return {page_id_t} 分配的新页号
  * @param {int} fd 指定文件的文件句柄
  */
 page_id_t DiskManager::allocate_page(int fd) {
-    // 简单的自增分配策略，指定文件的页面编号加1
     assert(fd >= 0 && fd < MAX_FD);
-    return fd2pageno_[fd]++;
+    std::scoped_lock lock{free_pages_latch_};
+    auto it = free_pages_.find(fd);
+    if (it != free_pages_.end()) {
+        std::set<page_id_t> &free_pages = it->second;
+        // 上层用set_fd2pageno缩小了页面个数时，超出范围的空闲页号已经无效
+        free_pages.erase(free_pages.lower_bound(fd2pageno_[fd]), free_pages.end());
+        if (!free_pages.empty()) {
+            page_id_t page_no = *free_pages.begin();
+            free_pages.erase(free_pages.begin());
+            num_free_pages_[fd] = free_pages.size();
+            return page_no;
+        }
+        num_free_pages_[fd] = 0;
+    }
+    // 简单的自增分配策略，指定文件的页面编号加1，超出预分配的范围时再预分配一个区段
+    page_id_t page_no = fd2pageno_[fd]++;
+    if (page_no >= fd2extent_end_[fd]) {
+        reserve_extent(fd, page_no);
+    }
+    return page_no;
+}
+
+/**
+ * @description: 从page_no开始用fallocate预分配一个区段，调用时持有free_pages_latch_。
+ *              区段至少为设置的大小，文件变大后按文件大小的1/EXTENT_GROWTH_RATIO预分配（不超过MAX_EXTENT_SIZE），
+ *              末尾对齐到设置的区段大小，文件的碎片数随文件大小对数增长。
+ *              使用FALLOC_FL_KEEP_SIZE，文件大小仍然只由写入的页面决定；批量插入时文件系统每个区段分配一次空间，
+ *              区段在磁盘上连续，之后的顺序扫描读到的是连续的数据。文件系统不支持时只是不预分配
+ * @param {int} fd 文件句柄
+ * @param {page_id_t} page_no 超出预分配范围的页号
+ */
+void DiskManager::reserve_extent(int fd, page_id_t page_no) {
+    int extent_pages = extent_pages_.load(std::memory_order_relaxed);
+    if (extent_pages <= 1) {
+        return;
+    }
+    int num_pages = std::max<int>(extent_pages, std::min<int>(page_no / EXTENT_GROWTH_RATIO, MAX_EXTENT_SIZE / PAGE_SIZE));
+    page_id_t extent_end = (page_no + num_pages + extent_pages - 1) / extent_pages * extent_pages;
+    off_t offset = static_cast<off_t>(page_no) * PAGE_SIZE;
+    off_t len = static_cast<off_t>(extent_end - page_no) * PAGE_SIZE;
+    if (fallocate(fd, FALLOC_FL_KEEP_SIZE, offset, len) == 0) {
+        num_extents_reserved_++;
+    }
+    fd2extent_end_[fd] = extent_end;
+}
+
+/**
+ * @description: 关闭文件前释放文件末尾之后预分配但没有用到的空间，调用时持有files_latch_的排他锁。
+ *              截断到文件当前的大小不改变文件内容，但会释放文件末尾之后的全部空间
+ * @param {int} fd 文件句柄
+ */
+void DiskManager::release_extent(int fd) {
+    std::scoped_lock lock{free_pages_latch_};
+    struct stat stat_buf;
+    off_t extent_end = static_cast<off_t>(fd2extent_end_[fd]) * PAGE_SIZE;
+    if (fstat(fd, &stat_buf) == 0 && extent_end > stat_buf.st_size && ftruncate(fd, stat_buf.st_size) == -1) {
+        throw UnixError();
+    }
+    fd2extent_end_[fd] = 0;
+}
+
+/**
+ * @description: 把不再使用的页面归还给文件的空闲页面列表，之后allocate_page可以重用它。
+ *              归还的是文件末尾的页面时，连同之前归还的、与它相连的末尾页面一起从文件中截掉，文件变小。
+ *              调用者要保证页面已经从缓冲池中删除，否则缓冲池写回时会重新写入已经截掉的范围
+ * @param {int} fd 文件句柄
+ * @param {page_id_t} page_no 归还的页号
+ */
+void DiskManager::deallocate_page(int fd, page_id_t page_no) {
+    assert(fd >= 0 && fd < MAX_FD);
+    std::scoped_lock lock{free_pages_latch_};
+    page_id_t num_pages = fd2pageno_[fd];
+    if (page_no < 0 || page_no >= num_pages) {
+        return;
+    }
+    std::set<page_id_t> &free_pages = free_pages_[fd];
+    if (page_no != num_pages - 1) {
+        free_pages.insert(page_no);
+        num_free_pages_[fd] = free_pages.size();
+        return;
+    }
+    num_pages--;
+    while (!free_pages.empty() && *free_pages.rbegin() == num_pages - 1) {
+        free_pages.erase(std::prev(free_pages.end()));
+        num_pages--;
+    }
+    num_free_pages_[fd] = free_pages.size();
+    // 先缩小fd2pageno_再截断，扫描按fd2pageno_限定范围，不会再去读截掉的页面
+    fd2pageno_[fd] = num_pages;
+    // 末尾的页面可能还没有写回过，文件比num_pages短时不需要截断
+    struct stat stat_buf;
+    off_t new_size = static_cast<off_t>(num_pages) * PAGE_SIZE;
+    if (fstat(fd, &stat_buf) == 0 && stat_buf.st_size > new_size) {
+        if (ftruncate(fd, new_size) == -1) {
+            throw UnixError();
+        }
+        // 截断同时释放了文件末尾之后预分配的空间
+        fd2extent_end_[fd] = num_pages;
+    }
+}
+
+/**
+ * @description: 判断页面是否在文件的空闲页面列表中，扫描用它跳过已经归还的页面。
+ *              文件没有空闲页面时不加锁直接返回；并发归还的页面可能判断为不空闲，它们归还前已经写回为空页面，读到也没有记录
+ * @return {bool} 页面已经归还且还没有被重新分配时返回true
+ * @param {int} fd 文件句柄
+ * @param {page_id_t} page_no 页号
+ */
+bool DiskManager::is_page_free(int fd, page_id_t page_no) {
+    if (num_free_pages_[fd].load(std::memory_order_relaxed) == 0) {
+        return false;
+    }
+    std::scoped_lock lock{free_pages_latch_};
+    auto it = free_pages_.find(fd);
+    return it != free_pages_.end() && it->second.count(page_no) > 0;
+}
+
+/**
+ * @description: 重新占用一个指定的页号，用于把记录放回已经归还的页面（如事务回滚删除）。
+ *              页号在空闲页面列表中时从列表中取出；页号已经随文件末尾截掉时把页面个数扩大到它之后，
+ *              中间截掉的页面放入空闲页面列表，它们在文件中读出来是空页面
+ * @return {bool} 页号原来是空闲的或已经截掉，现在由调用者占用时返回true；页号正在使用时返回false
+ * @param {int} fd 文件句柄
+ * @param {page_id_t} page_no 要占用的页号
+ */
+bool DiskManager::reclaim_page(int fd, page_id_t page_no) {
+    assert(fd >= 0 && fd < MAX_FD);
+    std::scoped_lock lock{free_pages_latch_};
+    std::set<page_id_t> &free_pages = free_pages_[fd];
+    page_id_t num_pages = fd2pageno_[fd];
+    if (page_no < num_pages) {
+        if (free_pages.erase(page_no) == 0) {
+            return false;
+        }
+    } else {
+        for (page_id_t gap = num_pages; gap < page_no; gap++) {
+            free_pages.insert(gap);
+        }
+        fd2pageno_[fd] = page_no + 1;
+    }
+    num_free_pages_[fd] = free_pages.size();
+    return true;
+}
+
+/**
+ * @description: 文件空闲页面列表中的页面个数，不包括已经从文件末尾截掉的页面
+ * @param {int} fd 文件句柄
+ */
+size_t DiskManager::get_num_free_pages(int fd) { return num_free_pages_[fd].load(std::memory_order_relaxed); }
+
+/**
+ * @description: 从文件旁边的空闲页面列表文件中读入空闲页面，然后删除列表文件，调用时持有files_latch_的排他锁。
+ *              列表只在正常关闭文件时写出，异常退出后文件中的空闲页面不会被重用，但不会被重复分配
+ * @param {int} fd 刚打开的文件句柄，fd2pageno_已经按文件大小设置
+ * @param {string} &path 文件所在路径
+ */
+void DiskManager::load_free_pages(int fd, const std::string &path) {
+    std::string list_path = path + FREE_PAGE_LIST_SUFFIX;
+    std::set<page_id_t> free_pages;
+    int list_fd = open(list_path.c_str(), O_RDONLY);
+    if (list_fd >= 0) {
+        int count = 0;
+        if (pread(list_fd, &count, sizeof(count), 0) == sizeof(count) && count > 0) {
+            std::vector<page_id_t> page_nos(count);
+            ssize_t bytes = static_cast<ssize_t>(count) * sizeof(page_id_t);
+            if (pread(list_fd, page_nos.data(), bytes, sizeof(count)) == bytes) {
+                for (page_id_t page_no : page_nos) {
+                    if (page_no >= 0 && page_no < fd2pageno_[fd]) {
+                        free_pages.insert(page_no);
+                    }
+                }
+            }
+        }
+        close(list_fd);
+        unlink(list_path.c_str());
+    }
+    std::scoped_lock lock{free_pages_latch_};
+    free_pages_.erase(fd);
+    num_free_pages_[fd] = free_pages.size();
+    if (!free_pages.empty()) {
+        free_pages_[fd] = std::move(free_pages);
+    }
 }
 
-void DiskManager::deallocate_page(__attribute__((unused)) page_id_t page_id) {}
+/**
+ * @description: 关闭文件前把空闲页面列表写到文件旁边的列表文件中，没有空闲页面时不写，调用时持有files_latch_的排他锁
+ * @param {int} fd 文件句柄
+ * @param {string} &path 文件所在路径
+ */
+void DiskManager::save_free_pages(int fd, const std::string &path) {
+    std::vector<page_id_t> page_nos;
+    {
+        std::scoped_lock lock{free_pages_latch_};
+        auto it = free_pages_.find(fd);
+        if (it != free_pages_.end()) {
+            page_nos.assign(it->second.lower_bound(0), it->second.lower_bound(fd2pageno_[fd]));
+            free_pages_.erase(it);
+            num_free_pages_[fd] = 0;
+        }
+    }
+    if (page_nos.empty()) {
+        return;
+    }
+    std::string list_path = path + FREE_PAGE_LIST_SUFFIX;
+    int list_fd = open(list_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    if (list_fd < 0) {
+        throw UnixError();
+    }
+    int count = page_nos.size();
+    ssize_t bytes = static_cast<ssize_t>(count) * sizeof(page_id_t);
+    bool ok = pwrite(list_fd, &count, sizeof(count), 0) == sizeof(count) &&
+              pwrite(list_fd, page_nos.data(), bytes, sizeof(count)) == bytes;
+    close(list_fd);
+    if (!ok) {
+        // 写了一半的列表不能留下
+        unlink(list_path.c_str());
+        throw InternalError("DiskManager::save_free_pages Error: write failed.");
+    }
+}
 
 bool DiskManager::is_dir(const std::string& path) {
     struct stat st;
@@ -128,6 +544,7 @@ void DiskManager::destroy_file(const std::string &path) {
     // Todo:
     // 调用unlink()函数
     // 注意不能删除未关闭的文件
+    std::shared_lock lock{files_latch_};
     if (path2fd_.count(path)) {
         throw FileNotClosedError(path); 
     }
@@ -137,6 +554,8 @@ void DiskManager::destroy_file(const std::string &path) {
         }
         throw UnixError();
     }
+    // 文件的空闲页面列表随文件一起删除
+    unlink((path + FREE_PAGE_LIST_SUFFIX).c_str());
 }
 
 
@@ -149,18 +568,44 @@ int DiskManager::open_file(const std::string &path) {
     // Todo:
     // 调用open()函数，使用O_RDWR模式
     // 注意不能重复打开相同文件，并且需要更新文件打开列表
-    // 如果已经打开过，就直接返回原来的 fd（不重复 open）
+    std::scoped_lock lock{files_latch_};
+    return open_file_locked(path);
+}
+
+/**
+ * @description: 打开指定路径文件并加入文件打开列表，调用时持有files_latch_的排他锁
+ * @return {int} 返回打开的文件的文件句柄
+ * @param {string} &path 文件所在路径
+ */
+int DiskManager::open_file_locked(const std::string &path) {
     auto it = path2fd_.find(path);
     if (it != path2fd_.end()) {
         throw FileExistsError(path);  
     }
-    int fd = open(path.c_str(), O_RDWR);
+    // 日志按字节追加写入，不满足O_DIRECT的对齐要求，始终经过页缓存
+    bool direct_io = direct_io_.load(std::memory_order_relaxed) && path != LOG_FILE_NAME;
+    int fd = open(path.c_str(), O_RDWR | (direct_io ? O_DIRECT : 0));
+    if (fd < 0 && direct_io && errno == EINVAL) {
+        // 文件系统不支持O_DIRECT（如tmpfs）时退回到经过页缓存的读写
+        direct_io = false;
+        fd = open(path.c_str(), O_RDWR);
+    }
     if (fd < 0) {
         if (errno == ENOENT) {
             throw FileNotFoundError(path);
         }
         throw UnixError();
     }
+    direct_io_fds_[fd].store(direct_io, std::memory_order_relaxed);
+    // 从文件末尾开始分配页号，表和索引打开后还会按各自的文件头重新设置
+    struct stat stat_buf;
+    if (fstat(fd, &stat_buf) == -1) {
+        close(fd);
+        throw UnixError();
+    }
+    fd2pageno_[fd] = stat_buf.st_size / PAGE_SIZE;
+    fd2extent_end_[fd] = fd2pageno_[fd];
+    load_free_pages(fd, path);
     path2fd_[path] = fd;
     fd2path_[fd] = path;
     return fd;
@@ -174,18 +619,91 @@ void DiskManager::close_file(int fd) {
     // Todo:
     // 调用close()函数
     // 注意不能关闭未打开的文件，并且需要更新文件打开列表
+    std::scoped_lock lock{files_latch_};
     if (!fd2path_.count(fd)) {
         throw FileNotOpenError(fd);
     }
+    save_free_pages(fd, fd2path_[fd]);
+    release_extent(fd);
     if (close(fd) == -1) {
         throw UnixError(); 
     }
+    fd_generation_[fd].fetch_add(1, std::memory_order_release);
+    unmap_file_locked(fd);
     std::string path = fd2path_[fd];
     fd2path_.erase(fd);
     path2fd_.erase(path);
 }
 
 
+/**
+ * @description: 把已经打开的文件只读地映射到内存，映射覆盖映射时文件中的全部页面，已经映射时直接返回。
+ *              映射期间文件不能再被写入（包括缓冲池写回脏页），因此只用于只读打开的表和索引；
+ *              映射默认按MADV_RANDOM访问，点查只读入访问的页面，顺序扫描用advise_mapped提示之后的页面
+ * @return {char*} 映射的首地址，文件为空时返回nullptr
+ * @param {int} fd 文件句柄
+ */
+const char *DiskManager::map_file(int fd) {
+    std::scoped_lock lock{files_latch_};
+    if (!fd2path_.count(fd)) {
+        throw FileNotOpenError(fd);
+    }
+    char *data = mapped_data_[fd].load(std::memory_order_relaxed);
+    if (data != nullptr) {
+        return data;
+    }
+    struct stat stat_buf;
+    if (fstat(fd, &stat_buf) == -1) {
+        throw UnixError();
+    }
+    page_id_t num_pages = stat_buf.st_size / PAGE_SIZE;
+    if (num_pages == 0) {
+        return nullptr;
+    }
+    void *addr = mmap(nullptr, static_cast<size_t>(num_pages) * PAGE_SIZE, PROT_READ, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+        throw UnixError();
+    }
+    madvise(addr, static_cast<size_t>(num_pages) * PAGE_SIZE, MADV_RANDOM);
+    mapped_pages_[fd] = num_pages;
+    mapped_data_[fd].store(static_cast<char *>(addr), std::memory_order_release);
+    return static_cast<char *>(addr);
+}
+
+/**
+ * @description: 对映射中的一段页面给出访问模式的提示，超出映射范围的部分被忽略
+ * @param {int} fd 文件句柄
+ * @param {page_id_t} start_page_no 第一个页面
+ * @param {int} num_pages 页面个数
+ * @param {int} advice madvise的提示，如MADV_WILLNEED、MADV_SEQUENTIAL
+ */
+void DiskManager::advise_mapped(int fd, page_id_t start_page_no, int num_pages, int advice) {
+    const char *data = mapped_data_[fd].load(std::memory_order_acquire);
+    if (data == nullptr) {
+        return;
+    }
+    page_id_t start = std::max(start_page_no, 0);
+    page_id_t end = std::min(start_page_no + num_pages, mapped_pages_[fd]);
+    if (start >= end) {
+        return;
+    }
+    // 提示失败不影响正确性
+    madvise(const_cast<char *>(data) + static_cast<size_t>(start) * PAGE_SIZE,
+            static_cast<size_t>(end - start) * PAGE_SIZE, advice);
+}
+
+/**
+ * @description: 解除文件的只读映射，调用时持有files_latch_的排他锁，调用者保证没有线程还在读映射中的页面
+ * @param {int} fd 文件句柄
+ */
+void DiskManager::unmap_file_locked(int fd) {
+    char *data = mapped_data_[fd].exchange(nullptr, std::memory_order_acq_rel);
+    if (data != nullptr) {
+        munmap(data, static_cast<size_t>(mapped_pages_[fd]) * PAGE_SIZE);
+        mapped_pages_[fd] = 0;
+    }
+}
+
 /**
  * @description: 获得文件的大小
  * @return {int} 文件的大小
@@ -203,10 +721,12 @@ int DiskManager::get_file_size(const std::string &file_name) {
  * @param {int} fd 文件句柄
  */
 std::string DiskManager::get_file_name(int fd) {
-    if (!fd2path_.count(fd)) {
+    std::shared_lock lock{files_latch_};
+    auto it = fd2path_.find(fd);
+    if (it == fd2path_.end()) {
         throw FileNotOpenError(fd);
     }
-    return fd2path_[fd];
+    return it->second;
 }
 
 /**
@@ -215,10 +735,25 @@ std::string DiskManager::get_file_name(int fd) {
  * @param {string} &file_name 文件名
  */
 int DiskManager::get_file_fd(const std::string &file_name) {
-    if (!path2fd_.count(file_name)) {
-        return open_file(file_name);
+    int fd = find_file_fd(file_name);
+    if (fd >= 0) {
+        return fd;
     }
-    return path2fd_[file_name];
+    // 查找和打开在同一个排他锁内完成，两个线程同时打开同一个文件时后一个直接返回前一个打开的fd
+    std::scoped_lock lock{files_latch_};
+    auto it = path2fd_.find(file_name);
+    return it != path2fd_.end() ? it->second : open_file_locked(file_name);
+}
+
+/**
+ * @description:  查找已经打开的文件的文件句柄，与get_file_fd不同，文件没有打开时不会打开它
+ * @return {int} 文件句柄，文件没有打开时返回-1
+ * @param {string} &file_name 文件名
+ */
+int DiskManager::find_file_fd(const std::string &file_name) {
+    std::shared_lock lock{files_latch_};
+    auto it = path2fd_.find(file_name);
+    return it == path2fd_.end() ? -1 : it->second;
 }
 
 
@@ -230,38 +765,74 @@ int DiskManager::get_file_fd(const std::string &file_name) {
  * @param {int} offset 读取的内容在文件中的位置
  */
 int DiskManager::read_log(char *log_data, int size, int offset) {
-    // read log file from the previous end
-    if (log_fd_ == -1) {
-        log_fd_ = open_file(LOG_FILE_NAME);
-    }
-    int file_size = get_file_size(LOG_FILE_NAME);
+    LogWriter *log_writer = get_log_writer();
+    off_t file_size = log_writer->get_append_lsn();
     if (offset > file_size) {
         return -1;
     }
 
-    size = std::min(size, file_size - offset);
+    size = static_cast<int>(std::min<off_t>(size, file_size - offset));
     if(size == 0) return 0;
-    lseek(log_fd_, offset, SEEK_SET);
-    ssize_t bytes_read = read(log_fd_, log_data, size);
-    assert(bytes_read == size);
+    // 还在日志缓冲区中的部分先等刷盘线程写入文件
+    log_writer->wait_written(offset + size);
+    ssize_t bytes_read = pread(log_fd_, log_data, size, offset);
+    if (bytes_read < 0) {
+        throw UnixError();
+    }
     return bytes_read;
 }
 
 
 /**
- * @description: 写日志内容
+ * @description: 写日志内容，返回时日志已经写入日志文件，但不保证持久化
  * @param {char} *log_data 要写入的日志内容
  * @param {int} size 要写入的内容大小
  */
 void DiskManager::write_log(char *log_data, int size) {
-    if (log_fd_ == -1) {
-        log_fd_ = open_file(LOG_FILE_NAME);
+    // 日志追加到LogWriter的日志缓冲区，多个线程同时写日志时由刷盘线程合并成一次写入
+    LogWriter *log_writer = get_log_writer();
+    log_writer->wait_written(log_writer->append(log_data, size));
+}
+
+/**
+ * @description: 指定日志文件的文件句柄，之后由DiskManager负责关闭它，必须在第一次读写日志之前调用。
+ *              LogWriter创建之后其他线程可能还在使用get_log_writer返回的指针，不能再销毁它换成别的文件
+ * @return {bool} LogWriter已经创建时不切换，返回false
+ * @param {int} log_fd 日志文件的文件句柄
+ */
+bool DiskManager::SetLogFd(int log_fd) {
+    std::scoped_lock lock{log_latch_};
+    if (log_writer_ != nullptr) {
+        return false;
     }
+    // 之前用SetLogFd指定的句柄不再使用，关闭它
+    if (log_fd_ != -1 && log_fd_ != log_fd) {
+        close(log_fd_);
+    }
+    log_fd_ = log_fd;
+    return true;
+}
 
-    // write from the file_end
-    lseek(log_fd_, 0, SEEK_END);
-    ssize_t bytes_write = write(log_fd_, log_data, size);
-    if (bytes_write != size) {
-        throw UnixError();
+/**
+ * @description: 返回日志的组提交写入器，第一次调用时打开日志文件，并从文件末尾开始追加日志
+ * @return {LogWriter*} 日志写入器
+ */
+LogWriter *DiskManager::get_log_writer() {
+    LogWriter *log_writer = log_writer_ptr_.load(std::memory_order_acquire);
+    if (log_writer != nullptr) {
+        return log_writer;
+    }
+    std::scoped_lock lock{log_latch_};
+    if (log_writer_ == nullptr) {
+        if (log_fd_ == -1) {
+            log_fd_ = get_file_fd(LOG_FILE_NAME);
+        }
+        struct stat stat_buf;
+        if (fstat(log_fd_, &stat_buf) != 0) {
+            throw UnixError();
+        }
+        log_writer_ = std::make_unique<LogWriter>(log_fd_, stat_buf.st_size);
+        log_writer_ptr_.store(log_writer_.get(), std::memory_order_release);
     }
+    return log_writer_.get();
 }
\ No newline at end of file
@@ -0,0 +1,229 @@
+#pragma once
+
+#include <fcntl.h>     // for open
+#include <sys/stat.h>  // for stat
+#include <unistd.h>    // for lseek
+
+#include <atomic>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+#include "buffer_stats.h"
+#include "common/config.h"
+#include "errors.h"
+#include "io_queue.h"
+#include "log_writer.h"
+
+// 文件的空闲页面列表在关闭文件时写到 文件路径 + FREE_PAGE_LIST_SUFFIX 中，打开时读入
+static constexpr const char *FREE_PAGE_LIST_SUFFIX = ".free";
+// 文件末尾分配页面时默认每次预分配的空间（字节）
+static constexpr size_t DEFAULT_EXTENT_SIZE = 1024 * 1024;
+// 文件较大时每次预分配文件大小的1/EXTENT_GROWTH_RATIO，最多MAX_EXTENT_SIZE字节
+static constexpr int EXTENT_GROWTH_RATIO = 4;
+static constexpr size_t MAX_EXTENT_SIZE = 64 * 1024 * 1024;
+
+/**
+ * @description: DiskManager的作用主要是根据上层的需要对磁盘文件进行操作
+ *              页面和日志都用pread/pwrite在指定偏移量读写，不使用共享的文件偏移量，多个线程可以同时读写同一个文件；
+ *              日志经过LogWriter的日志缓冲区追加，由它的刷盘线程合并写入，事务提交时用wait_durable等待日志持久化；
+ *              文件打开列表由files_latch_保护，查询加共享锁，打开和关闭加排他锁；
+ *              只读打开的表和索引可以把整个文件映射到内存（map_file），直接从映射中读取页面，不经过缓冲池；
+ *              每个文件有一个空闲页面列表，deallocate_page归还的页面由allocate_page重用，文件末尾的空闲页面被截掉；
+ *              在文件末尾分配页面时按区段预分配磁盘空间，已分配的页面个数（fd2pageno_）和预分配的范围（fd2extent_end_）分别记录；
+ *              set_direct_io之后打开的文件使用O_DIRECT，页面不再经过操作系统的页缓存，只缓存在缓冲池中
+ */
+class DiskManager {
+   public:
+    explicit DiskManager();
+
+    ~DiskManager();
+
+    void write_page(int fd, page_id_t page_no, const char *offset, int num_bytes);
+
+    void read_page(int fd, page_id_t page_no, char *offset, int num_bytes);
+
+    void write_pages(int fd, page_id_t start_page_no, const char *const *pages, int num_pages);
+
+    void read_pages(int fd, page_id_t start_page_no, char *const *pages, int num_pages);
+
+    std::unique_ptr<IoQueue> create_io_queue(unsigned depth = DEFAULT_IO_QUEUE_DEPTH, bool allow_async = true);
+
+    page_id_t allocate_page(int fd);
+
+    void deallocate_page(int fd, page_id_t page_no);
+
+    bool is_page_free(int fd, page_id_t page_no);
+
+    bool reclaim_page(int fd, page_id_t page_no);
+
+    size_t get_num_free_pages(int fd);
+
+    /*目录操作*/
+    bool is_dir(const std::string &path);
+
+    void create_dir(const std::string &path);
+
+    void destroy_dir(const std::string &path);
+
+    /*文件操作*/
+    bool is_file(const std::string &path);
+
+    void create_file(const std::string &path);
+
+    void destroy_file(const std::string &path);
+
+    int open_file(const std::string &path);
+
+    void close_file(int fd);
+
+    int get_file_size(const std::string &file_name);
+
+    std::string get_file_name(int fd);
+
+    int get_file_fd(const std::string &file_name);
+
+    int find_file_fd(const std::string &file_name);
+
+    /*只读映射*/
+    const char *map_file(int fd);
+
+    void advise_mapped(int fd, page_id_t start_page_no, int num_pages, int advice);
+
+    /**
+     * @description: 获取只读映射中的页面
+     * @return {char*} 页面在映射中的地址，文件没有映射或页号超出映射范围时返回nullptr
+     * @param {int} fd 文件句柄
+     * @param {page_id_t} page_no 页号
+     */
+    const char *get_mapped_page(int fd, page_id_t page_no) const {
+        const char *data = mapped_data_[fd].load(std::memory_order_acquire);
+        if (data == nullptr || page_no < 0 || page_no >= mapped_pages_[fd]) {
+            return nullptr;
+        }
+        return data + static_cast<size_t>(page_no) * PAGE_SIZE;
+    }
+
+    /*日志操作*/
+    int read_log(char *log_data, int size, int offset);
+
+    void write_log(char *log_data, int size);
+
+    LogWriter *get_log_writer();
+
+    bool SetLogFd(int log_fd);
+
+    int GetLogFd() { return log_fd_; }
+
+    /**
+     * @description: 设置文件已经分配的页面个数
+     * @param {int} fd 文件对应的文件句柄
+     * @param {int} start_page_no 已经分配的页面个数，即文件接下来从start_page_no开始分配页面编号
+     */
+    void set_fd2pageno(int fd, int start_page_no) { fd2pageno_[fd] = start_page_no; }
+
+    /**
+     * @description: 获取指定文件已经分配的页面个数
+     * @return {page_id_t} 文件已经分配的页面个数
+     * @param {int} fd 文件对应的文件句柄
+     */
+    page_id_t get_fd2pageno(int fd) { return fd2pageno_[fd]; }
+
+    /**
+     * @description: 设置之后打开的表和索引文件是否使用O_DIRECT，已经打开的文件不受影响。
+     *              O_DIRECT的文件读写时缓冲区地址和长度要按页面对齐，read_page/write_page和read_pages/write_pages
+     *              对不对齐的缓冲区经过临时缓冲区读写；IoQueue提交的请求不做转换，缓冲区必须对齐
+     * @param {bool} enable 为true时使用O_DIRECT
+     */
+    void set_direct_io(bool enable) { direct_io_ = enable; }
+
+    /**
+     * @description: 文件是否以O_DIRECT打开，文件系统不支持O_DIRECT时即使设置了也返回false
+     * @param {int} fd 文件句柄
+     */
+    bool is_direct_io(int fd) const { return direct_io_fds_[fd].load(std::memory_order_relaxed); }
+
+    /**
+     * @description: 设置文件末尾每次预分配的空间，对之后超出预分配范围的分配生效
+     * @param {size_t} bytes 预分配的字节数，按页面向下取整，不足两个页面时不预分配
+     */
+    void set_extent_size(size_t bytes) { extent_pages_ = static_cast<int>(bytes / PAGE_SIZE); }
+
+    size_t get_extent_size() const { return static_cast<size_t>(extent_pages_.load()) * PAGE_SIZE; }
+
+    /**
+     * @description: 成功预分配的区段个数
+     */
+    uint64_t get_num_extents_reserved() const { return num_extents_reserved_.load(); }
+
+    /**
+     * @description: 获取文件句柄的generation，每次关闭该fd时加一，用于识别fd被其他文件重用
+     * @return {uint32_t} fd当前的generation
+     * @param {int} fd 文件句柄
+     */
+    uint32_t get_fd_generation(int fd) { return fd_generation_[fd].load(std::memory_order_acquire); }
+
+    /**
+     * @description: read_page每次调用和read_pages每次preadv的延迟分布
+     */
+    const LatencyHistogram &get_read_latency() const { return read_latency_; }
+
+    /**
+     * @description: write_page每次调用和write_pages每次pwritev的延迟分布
+     */
+    const LatencyHistogram &get_write_latency() const { return write_latency_; }
+
+    static constexpr int MAX_FD = 8192;
+
+   private:
+    int open_file_locked(const std::string &path);
+
+    void unmap_file_locked(int fd);
+
+    void load_free_pages(int fd, const std::string &path);
+
+    void save_free_pages(int fd, const std::string &path);
+
+    void reserve_extent(int fd, page_id_t page_no);
+
+    bool needs_bounce(int fd, const char *buf, int num_bytes) const;
+
+    bool is_aligned(int fd, const char *const *pages, int num_pages) const;
+
+    void read_page_bounced(int fd, off_t offset_bytes, char *buf, int num_bytes);
+
+    void write_page_bounced(int fd, off_t offset_bytes, const char *buf, int num_bytes);
+
+    void release_extent(int fd);
+
+    // 文件打开列表，用于记录文件是否被打开
+    std::unordered_map<std::string, int> path2fd_;  //<Page文件磁盘路径,Page fd>哈希表
+    std::unordered_map<int, std::string> fd2path_;  //<Page fd,Page文件磁盘路径>哈希表
+    std::shared_mutex files_latch_;                 // 保护文件打开列表，查询加共享锁，打开和关闭加排他锁
+
+    std::atomic<int> log_fd_{-1};                   // WAL日志文件的文件句柄，默认为-1，代表未打开日志文件
+    std::unique_ptr<LogWriter> log_writer_;         // 日志的组提交写入器，第一次读写日志时创建
+    std::atomic<LogWriter *> log_writer_ptr_{nullptr};  // log_writer_发布给不加锁的读取者
+    std::mutex log_latch_;                          // 保护日志文件的打开和log_writer_的创建
+    std::atomic<page_id_t> fd2pageno_[MAX_FD]{};  // 文件中已经分配的页面个数，初始值为0
+    std::atomic<uint32_t> fd_generation_[MAX_FD]{}; // fd被关闭的次数，缓冲池的压缩缓存用它识别fd被重用
+    std::atomic<char *> mapped_data_[MAX_FD]{};     // 文件的只读映射，nullptr表示没有映射，由files_latch_的排他锁保护修改
+    page_id_t mapped_pages_[MAX_FD]{};              // 映射覆盖的页面个数，在mapped_data_发布之前写入
+    LatencyHistogram read_latency_;                 // 页面读的延迟分布
+    LatencyHistogram write_latency_;                // 页面写的延迟分布
+    std::unordered_map<int, std::set<page_id_t>> free_pages_;  // 各文件的空闲页面列表，只包含fd2pageno_以内的页号
+    std::mutex free_pages_latch_;                   // 保护free_pages_、fd2extent_end_，以及分配和归还页面时对fd2pageno_的修改
+    std::atomic<size_t> num_free_pages_[MAX_FD]{};  // 各文件空闲页面列表的大小，在free_pages_latch_内更新，读取时不加锁
+    page_id_t fd2extent_end_[MAX_FD]{};             // 文件中已经预分配到的页号（不含），可能超过文件大小
+    std::atomic<int> extent_pages_{DEFAULT_EXTENT_SIZE / PAGE_SIZE};  // 每次预分配的页面个数，不足2时不预分配
+    std::atomic<uint64_t> num_extents_reserved_{0}; // 成功预分配的区段个数
+    std::atomic<bool> direct_io_{false};            // 之后打开的文件是否使用O_DIRECT
+    std::atomic<bool> direct_io_fds_[MAX_FD]{};     // 各文件是否以O_DIRECT打开
+};
@@ -0,0 +1,258 @@
+#include "io_queue.h"
+
+#include <errno.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include "errors.h"
+
+bool SyncIoQueue::prepare_read(int fd, page_id_t page_no, char *data, int num_bytes, uint64_t user_data) {
+    return prepare({false, fd, page_no, data, num_bytes, user_data});
+}
+
+bool SyncIoQueue::prepare_write(int fd, page_id_t page_no, const char *data, int num_bytes, uint64_t user_data) {
+    return prepare({true, fd, page_no, const_cast<char *>(data), num_bytes, user_data});
+}
+
+bool SyncIoQueue::prepare(const Request &request) {
+    if (in_flight_ >= depth_) {
+        return false;
+    }
+    pending_.push_back(request);
+    in_flight_++;
+    return true;
+}
+
+/**
+ * @description: 按准备的顺序逐个完成请求
+ * @return {int} 提交的请求数
+ */
+int SyncIoQueue::submit() {
+    for (const Request &request : pending_) {
+        off_t offset = static_cast<off_t>(request.page_no) * PAGE_SIZE;
+        ssize_t n = request.is_write ? pwrite(request.fd, request.data, request.num_bytes, offset)
+                                     : pread(request.fd, request.data, request.num_bytes, offset);
+        completed_.push_back({request.user_data, n < 0 ? -errno : static_cast<int>(n)});
+    }
+    int submitted = pending_.size();
+    pending_.clear();
+    return submitted;
+}
+
+/**
+ * @description: 取回已经完成的请求。请求在submit时已经完成，因此不会等待；还没有提交的请求先被提交
+ * @return {int} 取回的请求数
+ */
+int SyncIoQueue::complete(IoCompletion *completions, int max_completions, int min_completions) {
+    if (static_cast<int>(completed_.size()) < min_completions) {
+        submit();
+    }
+    int n = 0;
+    while (n < max_completions && !completed_.empty()) {
+        completions[n++] = completed_.front();
+        completed_.pop_front();
+    }
+    in_flight_ -= n;
+    return n;
+}
+
+/**
+ * @description: 创建io_uring队列
+ * @return {unique_ptr<UringIoQueue>} 内核不支持io_uring、不支持IORING_OP_READ/IORING_OP_WRITE或被禁止使用时返回nullptr
+ * @param {unsigned} depth 队列深度
+ */
+std::unique_ptr<UringIoQueue> UringIoQueue::create(unsigned depth) {
+    std::unique_ptr<UringIoQueue> queue(new UringIoQueue(depth));
+    if (!queue->setup()) {
+        return nullptr;
+    }
+    return queue;
+}
+
+UringIoQueue::~UringIoQueue() {
+    if (sqes_ != nullptr) {
+        munmap(sqes_, sqes_size_);
+    }
+    if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+        munmap(cq_ring_, cq_ring_size_);
+    }
+    if (sq_ring_ != nullptr) {
+        munmap(sq_ring_, sq_ring_size_);
+    }
+    if (ring_fd_ >= 0) {
+        close(ring_fd_);
+    }
+}
+
+/**
+ * @description: 创建io_uring实例并映射提交队列、完成队列和提交队列项，失败时由析构函数释放已经映射的部分
+ * @return {bool} 成功则返回true
+ */
+bool UringIoQueue::setup() {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ring_fd_ = syscall(__NR_io_uring_setup, depth_, &params);
+    if (ring_fd_ < 0) {
+        return false;
+    }
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) {
+        sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+    }
+    void *sq_ring = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                         IORING_OFF_SQ_RING);
+    if (sq_ring == MAP_FAILED) {
+        return false;
+    }
+    sq_ring_ = sq_ring;
+    if (single_mmap) {
+        cq_ring_ = sq_ring_;
+    } else {
+        void *cq_ring = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                             IORING_OFF_CQ_RING);
+        if (cq_ring == MAP_FAILED) {
+            return false;
+        }
+        cq_ring_ = cq_ring;
+    }
+    sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+    void *sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                      IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        return false;
+    }
+    sqes_ = sqes;
+
+    char *sq = static_cast<char *>(sq_ring_);
+    sq_head_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+    sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    sq_mask_ = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    char *cq = static_cast<char *>(cq_ring_);
+    cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    cqes_ = cq + params.cq_off.cqes;
+    return probe_read_write();
+}
+
+/**
+ * @description: 用IORING_REGISTER_PROBE检查内核是否支持IORING_OP_READ和IORING_OP_WRITE。
+ *              io_uring_setup在5.1就有了，这两个操作到5.6才加入，更老的内核会让每个请求都以-EINVAL完成；
+ *              IORING_REGISTER_PROBE也是5.6加入的，探测失败同样视为不支持
+ * @return {bool} 两个操作都支持时返回true
+ */
+bool UringIoQueue::probe_read_write() {
+    const unsigned num_ops = 256;
+    size_t len = sizeof(struct io_uring_probe) + num_ops * sizeof(struct io_uring_probe_op);
+    std::unique_ptr<struct io_uring_probe, decltype(&std::free)> probe(
+        static_cast<struct io_uring_probe *>(std::calloc(1, len)), &std::free);
+    if (probe == nullptr) {
+        return false;
+    }
+    if (syscall(__NR_io_uring_register, ring_fd_, IORING_REGISTER_PROBE, probe.get(), num_ops) < 0) {
+        return false;
+    }
+    for (uint8_t opcode : {IORING_OP_READ, IORING_OP_WRITE}) {
+        if (opcode > probe->last_op || !(probe->ops[opcode].flags & IO_URING_OP_SUPPORTED)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool UringIoQueue::prepare_read(int fd, page_id_t page_no, char *data, int num_bytes, uint64_t user_data) {
+    return prepare(IORING_OP_READ, fd, page_no, data, num_bytes, user_data);
+}
+
+bool UringIoQueue::prepare_write(int fd, page_id_t page_no, const char *data, int num_bytes, uint64_t user_data) {
+    return prepare(IORING_OP_WRITE, fd, page_no, const_cast<char *>(data), num_bytes, user_data);
+}
+
+/**
+ * @description: 在提交队列的尾部填写一个请求，提交队列只由本线程写入，内核只移动head
+ * @return {bool} 在途请求已经达到depth_时返回false
+ */
+bool UringIoQueue::prepare(uint8_t opcode, int fd, page_id_t page_no, char *data, int num_bytes,
+                           uint64_t user_data) {
+    // 内核可能把队列深度向上取整到2的幂，在途请求仍按调用者要求的depth_限制
+    if (in_flight_ >= depth_) {
+        return false;
+    }
+    unsigned tail = *sq_tail_;
+    unsigned index = tail & sq_mask_;
+    struct io_uring_sqe *sqe = static_cast<struct io_uring_sqe *>(sqes_) + index;
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = opcode;
+    sqe->fd = fd;
+    sqe->off = static_cast<uint64_t>(page_no) * PAGE_SIZE;
+    sqe->addr = reinterpret_cast<uint64_t>(data);
+    sqe->len = num_bytes;
+    sqe->user_data = user_data;
+    sq_array_[index] = index;
+    // 请求的内容必须在tail之前对内核可见
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+    pending_++;
+    in_flight_++;
+    return true;
+}
+
+/**
+ * @description: 把所有准备好的请求提交给内核，一次io_uring_enter系统调用
+ * @return {int} 提交的请求数
+ */
+int UringIoQueue::submit() {
+    int submitted = 0;
+    while (pending_ > 0) {
+        int ret = syscall(__NR_io_uring_enter, ring_fd_, pending_, 0, 0, nullptr, 0);
+        if (ret < 0) {
+            if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+                continue;
+            }
+            throw UnixError();
+        }
+        pending_ -= ret;
+        submitted += ret;
+    }
+    return submitted;
+}
+
+/**
+ * @description: 从完成队列取回完成的请求，不足min_completions个时先提交再在内核中等待
+ * @return {int} 取回的请求数
+ * @param {IoCompletion*} completions 取回的请求
+ * @param {int} max_completions 最多取回的请求数
+ * @param {int} min_completions 至少取回的请求数，为0时不等待；超过在途请求数时按在途请求数
+ */
+int UringIoQueue::complete(IoCompletion *completions, int max_completions, int min_completions) {
+    submit();
+    min_completions = std::min({min_completions, max_completions, static_cast<int>(in_flight_)});
+    int n = 0;
+    while (true) {
+        unsigned head = *cq_head_;
+        unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+        while (head != tail && n < max_completions) {
+            const struct io_uring_cqe *cqe = static_cast<const struct io_uring_cqe *>(cqes_) + (head & cq_mask_);
+            completions[n++] = {cqe->user_data, cqe->res};
+            head++;
+        }
+        __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+        if (n >= min_completions) {
+            break;
+        }
+        int ret = syscall(__NR_io_uring_enter, ring_fd_, 0, min_completions - n, IORING_ENTER_GETEVENTS, nullptr, 0);
+        if (ret < 0 && errno != EINTR) {
+            throw UnixError();
+        }
+    }
+    in_flight_ -= n;
+    return n;
+}
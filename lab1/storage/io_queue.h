@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "common/config.h"
+
+// 异步读写队列默认的深度，即同时在途的请求数上限
+static constexpr unsigned DEFAULT_IO_QUEUE_DEPTH = 64;
+
+/**
+ * 一个完成的读写请求
+ */
+struct IoCompletion {
+    uint64_t user_data;     // 提交时传入的标识
+    int result;             // 读写的字节数，失败时为-errno
+};
+
+/**
+ * IoQueue 是页面读写的异步提交队列，由 DiskManager::create_io_queue 创建
+ *
+ * 调用者先用 prepare_read/prepare_write 准备若干请求，再用 submit 一次提交，之后用 complete 取回完成的请求，
+ * 完成的顺序不一定和提交的顺序相同。同时在途（已准备但还没有取回）的请求不超过 get_depth() 个。
+ * 请求的缓冲区在取回对应的完成之前不能释放或修改。
+ *
+ * 一个 IoQueue 只能由一个线程使用，需要并发读写的线程各自创建自己的队列；同一文件上的多个队列可以同时使用。
+ * 内核支持 io_uring 时使用 io_uring（见 UringIoQueue），否则退回到同步的 pread/pwrite（见 SyncIoQueue）。
+ */
+class IoQueue {
+   public:
+    explicit IoQueue(unsigned depth) : depth_(depth) {}
+
+    virtual ~IoQueue() = default;
+
+    virtual bool is_async() const = 0;
+
+    unsigned get_depth() const { return depth_; }
+
+    unsigned get_in_flight() const { return in_flight_; }
+
+    virtual bool prepare_read(int fd, page_id_t page_no, char *data, int num_bytes, uint64_t user_data) = 0;
+
+    virtual bool prepare_write(int fd, page_id_t page_no, const char *data, int num_bytes, uint64_t user_data) = 0;
+
+    virtual int submit() = 0;
+
+    virtual int complete(IoCompletion *completions, int max_completions, int min_completions) = 0;
+
+   protected:
+    unsigned depth_;            // 同时在途的请求数上限
+    unsigned in_flight_ = 0;    // 已准备但还没有被complete取回的请求数
+};
+
+/**
+ * SyncIoQueue 在 submit 时逐个用 pread/pwrite 完成请求，用于内核不支持 io_uring 的情况
+ */
+class SyncIoQueue : public IoQueue {
+   public:
+    explicit SyncIoQueue(unsigned depth) : IoQueue(depth) {}
+
+    bool is_async() const override { return false; }
+
+    bool prepare_read(int fd, page_id_t page_no, char *data, int num_bytes, uint64_t user_data) override;
+
+    bool prepare_write(int fd, page_id_t page_no, const char *data, int num_bytes, uint64_t user_data) override;
+
+    int submit() override;
+
+    int complete(IoCompletion *completions, int max_completions, int min_completions) override;
+
+   private:
+    struct Request {
+        bool is_write;
+        int fd;
+        page_id_t page_no;
+        char *data;
+        int num_bytes;
+        uint64_t user_data;
+    };
+
+    bool prepare(const Request &request);
+
+    std::vector<Request> pending_;          // 已准备还没有提交的请求
+    std::deque<IoCompletion> completed_;    // 已完成还没有取回的请求
+};
+
+/**
+ * UringIoQueue 用 io_uring 异步读写页面
+ *
+ * 直接通过 io_uring_setup/io_uring_enter 系统调用使用内核的提交队列和完成队列，不依赖 liburing。
+ * 提交队列的深度等于 depth，完成队列是它的两倍，在途请求不超过 depth 个，因此完成队列不会溢出。
+ */
+class UringIoQueue : public IoQueue {
+   public:
+    static std::unique_ptr<UringIoQueue> create(unsigned depth);
+
+    ~UringIoQueue() override;
+
+    bool is_async() const override { return true; }
+
+    bool prepare_read(int fd, page_id_t page_no, char *data, int num_bytes, uint64_t user_data) override;
+
+    bool prepare_write(int fd, page_id_t page_no, const char *data, int num_bytes, uint64_t user_data) override;
+
+    int submit() override;
+
+    int complete(IoCompletion *completions, int max_completions, int min_completions) override;
+
+   private:
+    explicit UringIoQueue(unsigned depth) : IoQueue(depth) {}
+
+    bool setup();
+
+    bool probe_read_write();
+
+    bool prepare(uint8_t opcode, int fd, page_id_t page_no, char *data, int num_bytes, uint64_t user_data);
+
+    int ring_fd_ = -1;
+    void *sq_ring_ = nullptr;       // 提交队列的环形缓冲区
+    size_t sq_ring_size_ = 0;
+    void *cq_ring_ = nullptr;       // 完成队列的环形缓冲区，内核支持IORING_FEAT_SINGLE_MMAP时和sq_ring_相同
+    size_t cq_ring_size_ = 0;
+    void *sqes_ = nullptr;          // 提交队列项的数组
+    size_t sqes_size_ = 0;
+    unsigned *sq_head_ = nullptr;
+    unsigned *sq_tail_ = nullptr;
+    unsigned sq_mask_ = 0;
+    unsigned *sq_array_ = nullptr;
+    unsigned *cq_head_ = nullptr;
+    unsigned *cq_tail_ = nullptr;
+    unsigned cq_mask_ = 0;
+    void *cqes_ = nullptr;
+    unsigned pending_ = 0;          // 已准备还没有提交给内核的请求数
+};
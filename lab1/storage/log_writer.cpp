@@ -0,0 +1,157 @@
+#include "log_writer.h"
+
+#include <errno.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "errors.h"
+
+/**
+ * @description: 创建日志写入器并启动刷盘线程
+ * @param {int} log_fd 日志文件的文件句柄
+ * @param {off_t} log_end 日志文件当前的大小，之后的日志从这里开始追加
+ * @param {size_t} buffer_size 每个日志缓冲区的大小（字节）
+ */
+LogWriter::LogWriter(int log_fd, off_t log_end, size_t buffer_size)
+    : log_fd_(log_fd),
+      buffer_size_(buffer_size),
+      buffer_start_(log_end),
+      append_lsn_(log_end),
+      write_requested_lsn_(log_end),
+      sync_requested_lsn_(log_end),
+      written_lsn_(log_end),
+      durable_lsn_(log_end),
+      stop_(false) {
+    append_buffer_.reserve(buffer_size_);
+    flush_buffer_.reserve(buffer_size_);
+    thread_ = std::thread(&LogWriter::run, this);
+}
+
+/**
+ * @description: 通知刷盘线程写出并持久化缓冲区中剩余的日志，等待其退出
+ */
+LogWriter::~LogWriter() {
+    {
+        std::scoped_lock lock{latch_};
+        stop_ = true;
+    }
+    flush_cv_.notify_one();
+    thread_.join();
+}
+
+/**
+ * @description: 把一条日志追加到日志缓冲区，不等待写入文件
+ * @return {off_t} 日志的结束位置（LSN），用wait_written/wait_durable等待它写入文件或持久化
+ * @param {char} *log_data 日志内容
+ * @param {int} size 日志的大小
+ */
+off_t LogWriter::append(const char *log_data, int size) {
+    std::unique_lock lock{latch_};
+    // 缓冲区放不下时请求刷盘线程写出，等它换上空的缓冲区；比缓冲区还大的日志等缓冲区为空时直接放入
+    while (!append_buffer_.empty() && append_buffer_.size() + size > buffer_size_) {
+        if (!error_.empty()) {
+            throw InternalError("LogWriter::append Error: " + error_);
+        }
+        write_requested_lsn_ = std::max(write_requested_lsn_, append_lsn_);
+        flush_cv_.notify_one();
+        done_cv_.wait(lock);
+    }
+    append_buffer_.insert(append_buffer_.end(), log_data, log_data + size);
+    append_lsn_ += size;
+    return append_lsn_;
+}
+
+/**
+ * @description: 等待lsn之前的日志写入日志文件（不保证持久化），之后read_log可以读到它们
+ * @param {off_t} lsn append返回的日志位置
+ */
+void LogWriter::wait_written(off_t lsn) { wait_for(lsn, false); }
+
+/**
+ * @description: 等待lsn之前的日志持久化，同时等待的线程由刷盘线程合并成一次写入和一次fdatasync
+ * @param {off_t} lsn append返回的日志位置
+ */
+void LogWriter::wait_durable(off_t lsn) { wait_for(lsn, true); }
+
+void LogWriter::wait_for(off_t lsn, bool durable) {
+    std::atomic<off_t> &done_lsn = durable ? durable_lsn_ : written_lsn_;
+    if (done_lsn.load() >= lsn) {
+        return;
+    }
+    std::unique_lock lock{latch_};
+    lsn = std::min(lsn, append_lsn_);
+    off_t &requested_lsn = durable ? sync_requested_lsn_ : write_requested_lsn_;
+    requested_lsn = std::max(requested_lsn, lsn);
+    flush_cv_.notify_one();
+    done_cv_.wait(lock, [&] { return done_lsn.load() >= lsn || !error_.empty(); });
+    if (done_lsn.load() < lsn) {
+        throw InternalError("LogWriter::wait_for Error: " + error_);
+    }
+}
+
+/**
+ * @description: 刷盘线程主循环，每轮把追加缓冲区换下来一次写入文件，有线程等待持久化时再做一次fdatasync；
+ *              写入和fdatasync时不持有latch_，期间追加的日志留给下一轮
+ */
+void LogWriter::run() {
+    std::unique_lock lock{latch_};
+    while (true) {
+        flush_cv_.wait(lock, [this] {
+            return stop_ || (error_.empty() && (write_requested_lsn_ > written_lsn_.load() ||
+                                                sync_requested_lsn_ > durable_lsn_.load()));
+        });
+        if (!error_.empty()) {
+            break;
+        }
+        bool stop = stop_;
+        bool sync = sync_requested_lsn_ > durable_lsn_.load() || (stop && append_lsn_ > durable_lsn_.load());
+        off_t start = buffer_start_;
+        off_t end = append_lsn_;
+        std::swap(append_buffer_, flush_buffer_);
+        buffer_start_ = end;
+        // 唤醒等待缓冲区空间的append
+        done_cv_.notify_all();
+        lock.unlock();
+
+        std::string error;
+        size_t written = 0;
+        while (written < flush_buffer_.size()) {
+            ssize_t n = pwrite(log_fd_, flush_buffer_.data() + written, flush_buffer_.size() - written, start + written);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                error = strerror(errno);
+                break;
+            }
+            written += n;
+        }
+        if (!flush_buffer_.empty()) {
+            num_writes_.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (error.empty() && sync) {
+            if (fdatasync(log_fd_) != 0) {
+                error = strerror(errno);
+            } else {
+                num_syncs_.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        flush_buffer_.clear();
+
+        lock.lock();
+        if (!error.empty()) {
+            error_ = error;
+        } else {
+            written_lsn_ = end;
+            if (sync) {
+                durable_lsn_ = end;
+            }
+        }
+        done_cv_.notify_all();
+        if (stop) {
+            break;
+        }
+    }
+}
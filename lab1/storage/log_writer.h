@@ -0,0 +1,80 @@
+#pragma once
+
+#include <sys/types.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/config.h"
+
+// 日志缓冲区默认的大小（字节），缓冲区满时追加日志的线程等待刷盘线程把缓冲区写出
+static constexpr size_t DEFAULT_LOG_WRITER_BUFFER_SIZE = LOG_BUFFER_SIZE;
+
+/**
+ * LogWriter 是日志文件的组提交写入器，由 DiskManager::get_log_writer 创建
+ *
+ * 多个线程用 append 并发地把日志追加到内存中的日志缓冲区，返回日志的结束位置（日志文件中的字节偏移，作为LSN）；
+ * 后台的刷盘线程把缓冲区中积累的日志一次写入文件，需要持久化时每组写入只做一次 fdatasync。
+ * 事务提交时用 wait_durable 等待自己的LSN持久化：刷盘线程在做 fdatasync 时新到的提交在缓冲区中积累，
+ * 下一轮合并成一次写入和一次 fdatasync，并发提交的事务越多，每次 fdatasync 分摊的提交就越多。
+ *
+ * 缓冲区是双缓冲的：刷盘线程写出一个缓冲区时，append 继续写入另一个缓冲区。
+ */
+class LogWriter {
+   public:
+    LogWriter(int log_fd, off_t log_end, size_t buffer_size = DEFAULT_LOG_WRITER_BUFFER_SIZE);
+
+    ~LogWriter();
+
+    off_t append(const char *log_data, int size);
+
+    void wait_written(off_t lsn);
+
+    void wait_durable(off_t lsn);
+
+    /**
+     * @description: 已经追加到日志缓冲区的日志的结束位置，在此之前追加的日志的LSN都不超过它
+     */
+    off_t get_append_lsn() {
+        std::scoped_lock lock{latch_};
+        return append_lsn_;
+    }
+
+    off_t get_written_lsn() const { return written_lsn_.load(); }
+
+    off_t get_durable_lsn() const { return durable_lsn_.load(); }
+
+    uint64_t get_num_writes() const { return num_writes_.load(std::memory_order_relaxed); }
+
+    uint64_t get_num_syncs() const { return num_syncs_.load(std::memory_order_relaxed); }
+
+   private:
+    void run();
+
+    void wait_for(off_t lsn, bool durable);
+
+    int log_fd_;
+    size_t buffer_size_;
+    std::mutex latch_;                      // 保护以下除原子变量之外的所有成员
+    std::condition_variable flush_cv_;      // 唤醒刷盘线程
+    std::condition_variable done_cv_;       // 一轮写入完成后唤醒等待的线程
+    std::vector<char> append_buffer_;       // append写入的缓冲区，从文件偏移buffer_start_开始
+    std::vector<char> flush_buffer_;        // 刷盘线程正在写出的缓冲区
+    off_t buffer_start_;
+    off_t append_lsn_;                      // append_buffer_的末尾
+    off_t write_requested_lsn_;             // 等待写入文件的最大位置
+    off_t sync_requested_lsn_;              // 等待持久化的最大位置
+    std::atomic<off_t> written_lsn_;        // 已经写入文件的位置
+    std::atomic<off_t> durable_lsn_;        // 已经fdatasync的位置
+    std::string error_;                     // 刷盘失败时的错误信息，非空时之后的等待都抛出异常
+    bool stop_;
+    std::atomic<uint64_t> num_writes_{0};   // 刷盘线程写入文件的次数
+    std::atomic<uint64_t> num_syncs_{0};    // 刷盘线程fdatasync的次数
+    std::thread thread_;
+};
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <climits>
+#include <condition_variable>
+#include <shared_mutex>
+
+#include "common/config.h"
+
+/**
+ * @description: 存储层每个Page的id的声明
+ */
+struct PageId {
+    int fd;  //  Page所在的磁盘文件开启后的文件描述符, 来定位打开的文件在内存中的位置
+    page_id_t page_no = INVALID_PAGE_ID;
+
+    friend bool operator==(const PageId &x, const PageId &y) { return x.fd == y.fd && x.page_no == y.page_no; }
+    bool operator<(const PageId& x) const {
+        if(fd < x.fd) return true;
+        return page_no < x.page_no;
+    }
+
+    std::string toString() {
+        return  "{fd: " + std::to_string(fd) + " page_no: " + std::to_string(page_no) + "}";
+    }
+
+    inline int64_t Get() const {
+        return (static_cast<int64_t>(fd << 16) | page_no);
+    }
+};
+
+// PageId的自定义哈希算法, 用于构建unordered_map<PageId, frame_id_t, PageIdHash>
+struct PageIdHash {
+    size_t operator()(const PageId &x) const { return (x.fd << 16) | x.page_no; }
+};
+
+template <>
+struct std::hash<PageId> {
+    size_t operator()(const PageId &obj) const { return std::hash<int64_t>()(obj.Get()); }
+};
+
+/**
+ * @description: 页面的类别，作为缓冲池淘汰页面时的优先级提示，数值越大越晚被淘汰
+ */
+enum class PageClass : uint8_t {
+    SCAN = 0,       // 大范围扫描读入的页面，扫描结束后很少再被访问
+    HEAP,           // 普通的表数据页，默认类别
+    INDEX_LEAF,     // B+树叶子结点
+    INDEX_INNER,    // B+树根结点和内部结点，每次索引查找都要经过
+    NUM_CLASSES
+};
+
+/**
+ * @description: Page类声明, Page是rmdb数据块的单位、是负责数据操作Record模块的操作对象，
+ * Page对象在磁盘上有文件存储, 若在Buffer中则有帧偏移, 并非特指Buffer或Disk上的数据
+ */
+class Page {
+    friend class BufferPoolManager;
+    friend class BufferPoolInstance;
+    friend class ReadPageGuard;
+    friend class WritePageGuard;
+
+   public:
+
+    Page() = default;
+
+    ~Page() = default;
+
+    PageId get_page_id() const { return id_; }
+
+    inline char *get_data() { return data_; }
+
+    bool is_dirty() const { return is_dirty_; }
+
+    // 帧在空闲链表中，或正在被淘汰、删除、读入时，pin_count_加上这个值变为负数，此时无锁命中不能固定该帧
+    static constexpr int PIN_COUNT_CLAIMED = INT_MIN / 2;
+
+    static constexpr size_t OFFSET_PAGE_START = 0;
+    static constexpr size_t OFFSET_LSN = 0;
+    static constexpr size_t OFFSET_PAGE_HDR = 4;
+
+    inline lsn_t get_page_lsn() { return *reinterpret_cast<lsn_t *>(get_data() + OFFSET_LSN) ; }
+
+    inline void set_page_lsn(lsn_t page_lsn) { memcpy(get_data() + OFFSET_LSN, &page_lsn, sizeof(lsn_t)); }
+
+   private:
+    void reset_memory() { memset(data_, OFFSET_PAGE_START, PAGE_SIZE); }  // 将data_的PAGE_SIZE个字节填充为0，帧必须已经分配了数据
+
+    /** page的唯一标识符 */
+    PageId id_;
+
+    /** The actual data that is stored within a page.
+     *  该页面在bufferPool中的偏移地址，指向所属分区的一块帧内存（FrameChunk），帧还没有分配内存或已被缩容释放时为nullptr。
+     *  缩容只释放页面数据，Page对象本身一直保留，无锁命中在固定成功之前只访问Page对象
+     */
+    char *data_ = nullptr;
+
+    /** 脏页判断，由所属分区的latch_保护修改，unpin_page不加锁读取 */
+    std::atomic<bool> is_dirty_{false};
+
+    /** The pin count of this page. 无锁命中直接原子地增减；为负数时帧被淘汰、删除或读入的线程独占 */
+    std::atomic<int> pin_count_{0};
+
+    /** 帧正在进行磁盘读写（读入新页面或写回旧页面），由所属分区的latch_保护 */
+    bool io_in_progress_ = false;
+
+    /** 等待本帧磁盘读写完成的线程在此等待，配合所属分区的latch_使用 */
+    std::condition_variable io_cv_;
+
+    /** 页面由预读装入且还没有被fetch_page访问过，由所属分区的latch_保护设置，命中时原子地清除 */
+    std::atomic<bool> prefetched_{false};
+
+    /** 页面装入本帧以来被fetch_page访问的次数，用于导出预热列表时按热度排序。
+     *  命中时不用原子加法，并发命中丢失几次计数不影响排序 */
+    std::atomic<uint32_t> access_count_{0};
+
+    /** 页面的类别，装入时取fetch_page/new_page的提示，命中时只会提高，由set_page_class直接修改 */
+    std::atomic<PageClass> page_class_{PageClass::HEAP};
+
+    /** 页面内容的读写锁，由ReadPageGuard/WritePageGuard持有；写回磁盘时持有读锁，避免写出修改到一半的页面 */
+    std::shared_mutex rwlatch_;
+};
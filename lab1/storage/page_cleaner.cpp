@@ -0,0 +1,47 @@
+#include "page_cleaner.h"
+
+#include <chrono>
+
+#include "buffer_pool_manager.h"
+
+/**
+ * @description: 创建并启动后台刷脏线程
+ * @param {BufferPoolManager*} buffer_pool_manager 要清理的缓冲池
+ * @param {PageCleanerConfig&} config 刷脏参数
+ */
+PageCleaner::PageCleaner(BufferPoolManager *buffer_pool_manager, const PageCleanerConfig &config)
+    : buffer_pool_manager_(buffer_pool_manager), config_(config), stop_(false) {
+    thread_ = std::thread(&PageCleaner::run, this);
+}
+
+/**
+ * @description: 通知后台线程停止并等待其退出
+ */
+PageCleaner::~PageCleaner() {
+    {
+        std::scoped_lock lock{latch_};
+        stop_ = true;
+    }
+    stop_cv_.notify_all();
+    thread_.join();
+}
+
+/**
+ * @description: 后台线程主循环，每隔interval_ms对所有分区做一轮清理
+ */
+void PageCleaner::run() {
+    std::unique_lock lock{latch_};
+    while (!stop_) {
+        stop_cv_.wait_for(lock, std::chrono::milliseconds(config_.interval_ms), [this] { return stop_; });
+        if (stop_) {
+            break;
+        }
+        lock.unlock();
+        try {
+            buffer_pool_manager_->clean_pages(config_);
+        } catch (...) {
+            // 写回失败的页面仍是脏页，留给下一轮或前台淘汰时处理
+        }
+        lock.lock();
+    }
+}
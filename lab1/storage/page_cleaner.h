@@ -0,0 +1,41 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+
+class BufferPoolManager;
+
+/**
+ * 后台刷脏线程的参数，比例都是相对于单个分区的帧数
+ */
+struct PageCleanerConfig {
+    int interval_ms = 10;               // 每轮检查的间隔
+    double max_dirty_ratio = 0.10;      // 脏页比例超过该值时开始写回
+    double min_clean_ratio = 0.10;      // 干净的可淘汰帧（空闲帧 + 未固定的干净页）低于该比例时开始写回
+    size_t max_pages_per_round = 64;    // 每个分区每轮最多写回的页数
+};
+
+/**
+ * PageCleaner 在后台周期性地调用 BufferPoolManager::clean_pages，
+ * 提前写回未固定的脏页，使前台淘汰页面时大多能直接拿到干净的帧，不必先写回再读入
+ */
+class PageCleaner {
+   public:
+    PageCleaner(BufferPoolManager *buffer_pool_manager, const PageCleanerConfig &config);
+
+    ~PageCleaner();
+
+    const PageCleanerConfig &get_config() const { return config_; }
+
+   private:
+    void run();
+
+    BufferPoolManager *buffer_pool_manager_;
+    PageCleanerConfig config_;
+    std::mutex latch_;                  // 保护stop_
+    std::condition_variable stop_cv_;   // 用于在等待间隔时及时响应停止请求
+    bool stop_;
+    std::thread thread_;
+};
@@ -0,0 +1,64 @@
+#include "page_guard.h"
+
+#include "buffer_pool_manager.h"
+
+ReadPageGuard::ReadPageGuard(ReadPageGuard &&that) noexcept : bpm_(that.bpm_), page_(that.page_) {
+    that.bpm_ = nullptr;
+    that.page_ = nullptr;
+}
+
+ReadPageGuard &ReadPageGuard::operator=(ReadPageGuard &&that) noexcept {
+    if (this != &that) {
+        drop();
+        bpm_ = that.bpm_;
+        page_ = that.page_;
+        that.bpm_ = nullptr;
+        that.page_ = nullptr;
+    }
+    return *this;
+}
+
+/**
+ * @description: 释放读锁并unpin页面，之后guard为空；对空的guard调用没有作用
+ */
+void ReadPageGuard::drop() {
+    if (page_ == nullptr) {
+        return;
+    }
+    // 先释放读锁再unpin：unpin可能要等待该帧上的写回，写回需要读锁
+    PageId page_id = page_->get_page_id();
+    page_->rwlatch_.unlock_shared();
+    bpm_->unpin_page(page_id, false);
+    bpm_ = nullptr;
+    page_ = nullptr;
+}
+
+WritePageGuard::WritePageGuard(WritePageGuard &&that) noexcept : bpm_(that.bpm_), page_(that.page_) {
+    that.bpm_ = nullptr;
+    that.page_ = nullptr;
+}
+
+WritePageGuard &WritePageGuard::operator=(WritePageGuard &&that) noexcept {
+    if (this != &that) {
+        drop();
+        bpm_ = that.bpm_;
+        page_ = that.page_;
+        that.bpm_ = nullptr;
+        that.page_ = nullptr;
+    }
+    return *this;
+}
+
+/**
+ * @description: 释放写锁并以脏页的方式unpin页面，之后guard为空；对空的guard调用没有作用
+ */
+void WritePageGuard::drop() {
+    if (page_ == nullptr) {
+        return;
+    }
+    PageId page_id = page_->get_page_id();
+    page_->rwlatch_.unlock();
+    bpm_->unpin_page(page_id, true);
+    bpm_ = nullptr;
+    page_ = nullptr;
+}
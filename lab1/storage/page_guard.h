@@ -0,0 +1,81 @@
+#pragma once
+
+#include "page.h"
+
+class BufferPoolManager;
+
+/**
+ * ReadPageGuard 持有一个页面的pin和该页面的读锁（共享锁），由BufferPoolManager::fetch_page_read返回。
+ * 析构或调用drop时先释放读锁再unpin，多个ReadPageGuard可以同时读同一个页面。
+ * 只能移动不能复制；获取页面失败或被移动后为空，get_page()返回nullptr
+ */
+class ReadPageGuard {
+    friend class BufferPoolManager;
+
+   public:
+    ReadPageGuard() = default;
+
+    ReadPageGuard(const ReadPageGuard &) = delete;
+
+    ReadPageGuard &operator=(const ReadPageGuard &) = delete;
+
+    ReadPageGuard(ReadPageGuard &&that) noexcept;
+
+    ReadPageGuard &operator=(ReadPageGuard &&that) noexcept;
+
+    ~ReadPageGuard() { drop(); }
+
+    void drop();
+
+    bool is_empty() const { return page_ == nullptr; }
+
+    Page *get_page() const { return page_; }
+
+    PageId get_page_id() const { return page_->get_page_id(); }
+
+    const char *get_data() const { return page_->get_data(); }
+
+   private:
+    ReadPageGuard(BufferPoolManager *bpm, Page *page) : bpm_(bpm), page_(page) {}
+
+    BufferPoolManager *bpm_ = nullptr;
+    Page *page_ = nullptr;      // 已经被固定并加了读锁的页面
+};
+
+/**
+ * WritePageGuard 持有一个页面的pin和该页面的写锁（排他锁），由BufferPoolManager::fetch_page_write/new_page_write返回。
+ * 持有写锁就表示要修改页面，析构或调用drop时先释放写锁，再以脏页的方式unpin。
+ * 只能移动不能复制；获取页面失败或被移动后为空，get_page()返回nullptr
+ */
+class WritePageGuard {
+    friend class BufferPoolManager;
+
+   public:
+    WritePageGuard() = default;
+
+    WritePageGuard(const WritePageGuard &) = delete;
+
+    WritePageGuard &operator=(const WritePageGuard &) = delete;
+
+    WritePageGuard(WritePageGuard &&that) noexcept;
+
+    WritePageGuard &operator=(WritePageGuard &&that) noexcept;
+
+    ~WritePageGuard() { drop(); }
+
+    void drop();
+
+    bool is_empty() const { return page_ == nullptr; }
+
+    Page *get_page() const { return page_; }
+
+    PageId get_page_id() const { return page_->get_page_id(); }
+
+    char *get_data() const { return page_->get_data(); }
+
+   private:
+    WritePageGuard(BufferPoolManager *bpm, Page *page) : bpm_(bpm), page_(page) {}
+
+    BufferPoolManager *bpm_ = nullptr;
+    Page *page_ = nullptr;      // 已经被固定并加了写锁的页面
+};
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+#include "page.h"
+
+/**
+ * PageTable 是缓冲池分区的页表，记录 PageId -> frame_id 的映射，是定长的开放寻址哈希表（线性探测）
+ *
+ * 换页和预读期间一个帧同时保留新旧两个页面的映射，项数最多是帧数的两倍；容量是不小于帧数四倍的2的幂，
+ * 装载因子不超过1/2，表中总有空槽位，探测一定会结束。每个槽位16字节，一个cache line放4个槽位，
+ * 探测序列落在相邻的槽位上，命中通常只访问一个cache line。
+ *
+ * 插入和删除由调用者持有分区的latch_串行执行；find不加锁，可以和插入删除并发执行：
+ * 并发的find可能漏掉正在被挪动的项，也可能读到刚被删除或被复用的槽位。
+ * 因此不持有latch_时find的结果只是提示，调用者要先固定帧，再确认帧中确实是目标页面，
+ * 没找到时回到加latch_的路径重新查找；持有latch_时find的结果是准确的。
+ *
+ * 删除采用向后移位（backward shift），不留下墓碑，长时间运行后探测长度也不会变长。
+ */
+class PageTable {
+   public:
+    explicit PageTable(size_t num_frames) {
+        capacity_ = 2;
+        while (capacity_ < num_frames * 4) {
+            capacity_ <<= 1;
+        }
+        mask_ = capacity_ - 1;
+        void *mem = std::aligned_alloc(CACHE_LINE_SIZE, std::max(capacity_ * sizeof(Slot), CACHE_LINE_SIZE));
+        if (mem == nullptr) {
+            throw std::bad_alloc();
+        }
+        slots_ = static_cast<Slot *>(mem);
+        for (size_t i = 0; i < capacity_; i++) {
+            new (&slots_[i]) Slot();
+        }
+    }
+
+    ~PageTable() { std::free(slots_); }
+
+    PageTable(const PageTable &) = delete;
+
+    PageTable &operator=(const PageTable &) = delete;
+
+    /**
+     * @description: 查找页面所在的帧，不加锁
+     * @return {bool} 找到则返回true
+     * @param {PageId} page_id 目标页面
+     * @param {frame_id_t*} frame_id 返回页面所在的帧
+     */
+    bool find(PageId page_id, frame_id_t *frame_id) const {
+        uint64_t key = encode(page_id);
+        size_t pos = home(key);
+        for (size_t n = 0; n < capacity_; n++, pos = (pos + 1) & mask_) {
+            uint64_t slot_key = slots_[pos].key.load(std::memory_order_acquire);
+            if (slot_key == key) {
+                *frame_id = slots_[pos].frame_id.load(std::memory_order_relaxed);
+                return true;
+            }
+            if (slot_key == EMPTY_KEY) {
+                return false;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @description: 插入映射，页面已经存在时覆盖其帧号，调用时持有latch_
+     */
+    void insert(PageId page_id, frame_id_t frame_id) {
+        uint64_t key = encode(page_id);
+        size_t pos = home(key);
+        for (size_t n = 0;; n++, pos = (pos + 1) & mask_) {
+            assert(n < capacity_ && "PageTable::insert: no empty slot");
+            uint64_t slot_key = slots_[pos].key.load(std::memory_order_relaxed);
+            if (slot_key == key || slot_key == EMPTY_KEY) {
+                // 先写帧号再发布key，无锁查找读到key时一定能读到对应的帧号
+                slots_[pos].frame_id.store(frame_id, std::memory_order_relaxed);
+                slots_[pos].key.store(key, std::memory_order_release);
+                return;
+            }
+        }
+    }
+
+    /**
+     * @description: 删除映射，并把同一探测序列上后面的项向前移动填补空位，调用时持有latch_
+     * @return {bool} 页面在页表中则返回true
+     */
+    bool erase(PageId page_id) {
+        uint64_t key = encode(page_id);
+        size_t hole = home(key);
+        while (true) {
+            uint64_t slot_key = slots_[hole].key.load(std::memory_order_relaxed);
+            if (slot_key == EMPTY_KEY) {
+                return false;
+            }
+            if (slot_key == key) {
+                break;
+            }
+            hole = (hole + 1) & mask_;
+        }
+        for (size_t pos = (hole + 1) & mask_;; pos = (pos + 1) & mask_) {
+            uint64_t slot_key = slots_[pos].key.load(std::memory_order_relaxed);
+            if (slot_key == EMPTY_KEY) {
+                break;
+            }
+            // 只有理想位置不在(hole, pos]之间的项才能移到hole，否则移动后就查不到了
+            size_t ideal = home(slot_key);
+            if (((pos - ideal) & mask_) >= ((pos - hole) & mask_)) {
+                slots_[hole].frame_id.store(slots_[pos].frame_id.load(std::memory_order_relaxed),
+                                            std::memory_order_relaxed);
+                slots_[hole].key.store(slot_key, std::memory_order_release);
+                hole = pos;
+            }
+        }
+        slots_[hole].key.store(EMPTY_KEY, std::memory_order_release);
+        return true;
+    }
+
+    size_t get_capacity() const { return capacity_; }
+
+   private:
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+    static constexpr uint64_t EMPTY_KEY = ~0ULL;    // fd和page_no都是-1，不会是有效的页面
+
+    struct alignas(16) Slot {
+        std::atomic<uint64_t> key{EMPTY_KEY};
+        std::atomic<frame_id_t> frame_id{-1};
+    };
+
+    static uint64_t encode(PageId page_id) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(page_id.fd)) << 32) |
+               static_cast<uint32_t>(page_id.page_no);
+    }
+
+    // 同一分区中的页号按分区个数同余，PageIdHash直接取低位会聚集，这里先打散（murmur3的finalizer）
+    size_t home(uint64_t key) const {
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdULL;
+        key ^= key >> 33;
+        key *= 0xc4ceb9fe1a85ec53ULL;
+        key ^= key >> 33;
+        return static_cast<size_t>(key) & mask_;
+    }
+
+    size_t capacity_;   // 槽位个数，2的幂
+    size_t mask_;       // capacity_ - 1
+    Slot *slots_;       // 按cache line对齐的槽位数组
+};
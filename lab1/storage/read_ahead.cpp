@@ -0,0 +1,152 @@
+#include "read_ahead.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "buffer_pool_manager.h"
+#include "disk_manager.h"
+
+/**
+ * @description: 创建并启动预读线程
+ * @param {BufferPoolManager*} buffer_pool_manager 页面读入的缓冲池
+ * @param {DiskManager*} disk_manager 用于判断页号是否超出文件范围
+ * @param {ReadAheadConfig&} config 预读参数
+ */
+ReadAhead::ReadAhead(BufferPoolManager *buffer_pool_manager, DiskManager *disk_manager, const ReadAheadConfig &config)
+    : buffer_pool_manager_(buffer_pool_manager), disk_manager_(disk_manager), config_(config), stop_(false) {
+    thread_ = std::thread(&ReadAhead::run, this);
+}
+
+/**
+ * @description: 丢弃尚未执行的预读请求，等待预读线程退出
+ */
+ReadAhead::~ReadAhead() {
+    {
+        std::scoped_lock lock{latch_};
+        stop_ = true;
+        queue_.clear();
+    }
+    queue_cv_.notify_all();
+    thread_.join();
+}
+
+/**
+ * @description: 记录一次可能触发预读的页面访问（未命中，或第一次命中预读的页面）
+ * @param {PageId} page_id 访问的页面
+ * @param {bool} bulk 访问是否来自带BufferAccessStrategy的大范围扫描
+ */
+void ReadAhead::on_access(PageId page_id, bool bulk) {
+    std::scoped_lock lock{latch_};
+    Stream &stream = streams_[page_id.fd];
+    if (stream.last_page_no != INVALID_PAGE_ID && page_id.page_no == stream.last_page_no + 1) {
+        stream.run++;
+    } else if (page_id.page_no != stream.last_page_no) {
+        // 访问不连续，重新开始一个访问流
+        stream.run = 1;
+        stream.read_ahead_upto = page_id.page_no;
+    }
+    stream.last_page_no = page_id.page_no;
+    if (stream.run < config_.trigger) {
+        return;
+    }
+    // 预读窗口中还剩一半以上的页面时不追加
+    page_id_t window_end = page_id.page_no + static_cast<page_id_t>(config_.window);
+    page_id_t start = std::max(stream.read_ahead_upto, page_id.page_no) + 1;
+    if (start > window_end || static_cast<size_t>(window_end - start + 1) < config_.window / 2) {
+        return;
+    }
+    if (queue_.size() >= config_.max_queue) {
+        return;
+    }
+    BufferAccessStrategy *strategy = nullptr;
+    if (bulk) {
+        if (stream.strategy == nullptr) {
+            // 环中要同时容纳已经读入但还没被扫描到的整个窗口
+            stream.strategy = std::make_unique<BufferAccessStrategy>(std::max(BULK_READ_RING_SIZE, 2 * config_.window));
+        }
+        strategy = stream.strategy.get();
+    }
+    queue_.push_back(Request{PageId{page_id.fd, start}, static_cast<size_t>(window_end - start + 1), nullptr, strategy});
+    stream.read_ahead_upto = window_end;
+    queue_cv_.notify_one();
+}
+
+/**
+ * @description: 沿链表预读从start开始的count个页面
+ * @param {PageId} start 链表中第一个要预读的页面
+ * @param {size_t} count 最多预读的页面数
+ * @param {NextPageFn} next_of 从页面数据中取出下一个页面的页号
+ */
+void ReadAhead::read_ahead_chain(PageId start, size_t count, NextPageFn next_of) {
+    std::scoped_lock lock{latch_};
+    if (queue_.size() >= config_.max_queue) {
+        return;
+    }
+    queue_.push_back(Request{start, count, std::move(next_of), nullptr});
+    queue_cv_.notify_one();
+}
+
+/**
+ * @description: 预读线程主循环
+ */
+void ReadAhead::run() {
+    std::unique_lock lock{latch_};
+    while (true) {
+        queue_cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+        if (stop_) {
+            break;
+        }
+        Request request = std::move(queue_.front());
+        queue_.pop_front();
+        lock.unlock();
+        try {
+            execute(request);
+        } catch (...) {
+            // 预读只是提示，读入失败时由之后的fetch_page重新读取并报告错误
+        }
+        lock.lock();
+    }
+}
+
+/**
+ * @description: 执行一个预读请求，超出文件范围的页面不读
+ */
+void ReadAhead::execute(const Request &request) {
+    PageId page_id = request.start;
+    if (!request.next_of) {
+        // 顺序预读：扫描已经越过的页面不再预读，否则读入后不会再被访问，只会挤占缓冲池。
+        // 访问流只会向前移动，跳过开头被越过的页面后，其余页面用一次prefetch_pages批量读入
+        if (page_id.page_no < 0) {
+            return;
+        }
+        page_id_t end = std::min<int64_t>(static_cast<int64_t>(page_id.page_no) + request.count,
+                                          disk_manager_->get_fd2pageno(page_id.fd));
+        while (page_id.page_no < end && is_behind_stream(page_id)) {
+            page_id.page_no++;
+        }
+        if (page_id.page_no < end) {
+            buffer_pool_manager_->prefetch_pages(page_id, end - page_id.page_no, request.strategy);
+        }
+        return;
+    }
+    std::vector<char> data(PAGE_SIZE);
+    for (size_t i = 0; i < request.count; i++) {
+        if (page_id.page_no == INVALID_PAGE_ID || page_id.page_no < 0 ||
+            page_id.page_no >= disk_manager_->get_fd2pageno(page_id.fd)) {
+            return;
+        }
+        if (!buffer_pool_manager_->prefetch_page(page_id, request.strategy, data.data())) {
+            return;
+        }
+        page_id.page_no = request.next_of(data.data());
+    }
+}
+
+/**
+ * @description: 判断页面是否已经被所在文件的访问流越过
+ */
+bool ReadAhead::is_behind_stream(PageId page_id) {
+    std::scoped_lock lock{latch_};
+    auto it = streams_.find(page_id.fd);
+    return it != streams_.end() && page_id.page_no <= it->second.last_page_no;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include "buffer_access_strategy.h"
+#include "common/config.h"
+#include "page.h"
+
+class BufferPoolManager;
+class DiskManager;
+
+// 从页面数据中取出链表中下一个页面的页号，没有下一个页面时返回INVALID_PAGE_ID
+using NextPageFn = std::function<page_id_t(const char *data)>;
+
+/**
+ * 预读的参数
+ */
+struct ReadAheadConfig {
+    size_t window = 32;         // 预读窗口，始终保持当前页面之后最多window个页面已经读入或正在读入
+    size_t trigger = 2;         // 同一个文件连续访问多少个相邻页面后才开始预读
+    size_t max_queue = 256;     // 等待执行的预读请求上限，超过时直接丢弃新的请求
+};
+
+/**
+ * ReadAhead 在后台线程中把即将访问的页面提前读入缓冲池
+ *
+ * - 顺序预读：按fd记录页面访问流，BufferPoolManager在未命中或第一次命中预读页面时调用on_access，
+ *   连续访问相邻页面达到trigger后，在当前页面之后维持一个window大小的预读窗口，
+ *   剩余不足半个窗口时再追加下一批
+ * - 链式预读：页面之间不按页号相邻的链表（如B+树叶子结点的next_leaf），
+ *   由调用者通过read_ahead_chain给出起点和取下一页的方法，后台线程沿链表依次读入
+ *
+ * 带着BufferAccessStrategy的大范围扫描触发的顺序预读也使用一个私有的环形缓冲区，
+ * 预读不会把扫描页面放进整个缓冲池。
+ */
+class ReadAhead {
+   public:
+    ReadAhead(BufferPoolManager *buffer_pool_manager, DiskManager *disk_manager, const ReadAheadConfig &config);
+
+    ~ReadAhead();
+
+    void on_access(PageId page_id, bool bulk);
+
+    void read_ahead_chain(PageId start, size_t count, NextPageFn next_of);
+
+    const ReadAheadConfig &get_config() const { return config_; }
+
+   private:
+    /**
+     * @description: 一个文件上的顺序访问流
+     */
+    struct Stream {
+        page_id_t last_page_no = INVALID_PAGE_ID;   // 上一次访问的页号
+        size_t run = 0;                             // 连续访问相邻页面的个数
+        page_id_t read_ahead_upto = INVALID_PAGE_ID;  // 已经提交预读的最大页号
+        std::unique_ptr<BufferAccessStrategy> strategy;  // 大范围扫描的预读使用的环形缓冲区
+    };
+
+    /**
+     * @description: 一个预读请求，next_of为空时读入从start开始页号连续的count个页面，否则沿链表读入count个页面
+     */
+    struct Request {
+        PageId start;
+        size_t count;
+        NextPageFn next_of;
+        BufferAccessStrategy *strategy;
+    };
+
+    void run();
+
+    void execute(const Request &request);
+
+    bool is_behind_stream(PageId page_id);
+
+    BufferPoolManager *buffer_pool_manager_;
+    DiskManager *disk_manager_;
+    ReadAheadConfig config_;
+    std::mutex latch_;                          // 保护streams_、queue_和stop_
+    std::condition_variable queue_cv_;
+    std::unordered_map<int, Stream> streams_;   // fd -> 该文件上的访问流
+    std::deque<Request> queue_;
+    bool stop_;
+    std::thread thread_;
+};
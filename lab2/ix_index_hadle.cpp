@@ -220,8 +220,8 @@ int IxNodeHandle::remove(const char *key) {
     return get_size();
 }
 
-IxIndexHandle::IxIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd)
-    : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager), fd_(fd) {
+IxIndexHandle::IxIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd, bool read_only)
+    : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager), fd_(fd), read_only_(read_only) {
     // init file_hdr_
     // disk_manager_->read_page(fd, IX_FILE_HDR_PAGE, (char *)&file_hdr_, sizeof(file_hdr_));
     char* buf = new char[PAGE_SIZE];
@@ -230,9 +230,14 @@ IxIndexHandle::IxIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffe
     file_hdr_ = new IxFileHdr();
     file_hdr_->deserialize(buf);
 
-    // disk_manager管理的fd对应的文件中，设置从file_hdr_->num_pages开始分配page_no
-    int now_page_no = disk_manager_->get_fd2pageno(fd);
-    disk_manager_->set_fd2pageno(fd, now_page_no + 1);
+    // 打开文件时disk_manager已经按文件大小设置了页面个数，新结点从文件末尾或文件的空闲页面中分配；
+    // 文件头中的页面还没有写回时文件可能更短，至少从file_hdr_->num_pages_开始分配
+    if (disk_manager_->get_fd2pageno(fd) < file_hdr_->num_pages_) {
+        disk_manager_->set_fd2pageno(fd, file_hdr_->num_pages_);
+    }
+    if (read_only_) {
+        disk_manager_->map_file(fd);
+    }
 }
 
 /**
@@ -242,8 +247,9 @@ IxIndexHandle::IxIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffe
  * @param transaction 事务参数，如果不需要则默认nullptr
  * @param find_first 是否找第一个
  * @return [leaf_node] and [root_is_latched] 返回目标叶子结点以及根结点是否加锁
- * @note 用了FindLeafPage之后一定要unlatch叶结点，否则下次latch该结点会堵塞！
- * @注意：用了FindLeafPage之后一定要unlatch叶结点，否则下次latch该结点会堵塞！
+ * @note 调用者持有root_latch_：查找时为共享锁，插入和删除时为排他锁，本函数不再对root_latch_加锁，root_is_latched总为false。
+ * 下降时内部结点只短暂加读锁；查找返回带读锁的叶子结点，用完后由调用者delete以释放读锁和pin；
+ * 插入和删除返回write_set_中带写锁的叶子结点，操作结束时随write_set_一起释放
  */
 std::pair<IxNodeHandle *, bool> IxIndexHandle::find_leaf_page(const char *key, Operation operation,Transaction *transaction, bool find_first) {
     // Todo:
@@ -254,15 +260,18 @@ std::pair<IxNodeHandle *, bool> IxIndexHandle::find_leaf_page(const char *key, O
     // internal_lookup 暂时处理不了找不到的情况
     // 一键找得到？
     page_id_t node_page = file_hdr_->root_page_;
-    IxNodeHandle *node_handle = fetch_node(node_page);
-    std::scoped_lock lock{root_latch_};
+    auto node_handle = std::make_unique<IxNodeHandle>(read_node(node_page));
     while(!node_handle->is_leaf_page()){
-        node_page = node_handle->internal_lookup(key);
-        node_handle = fetch_node(node_page);
+        node_page = find_first ? node_handle->value_at(0) : node_handle->internal_lookup(key);
+        // 先获取孩子结点再释放父结点
+        node_handle = std::make_unique<IxNodeHandle>(read_node(node_page));
     }
-    buffer_pool_manager_->unpin_page(node_handle->get_page_id(),false);
-    root_latch_.unlock();
-    return std::make_pair(node_handle, false);
+    if (operation == Operation::FIND) {
+        return std::make_pair(node_handle.release(), false);
+    }
+    // 持有root_latch_的排他锁，叶子结点不会在释放读锁和加写锁之间被修改
+    node_handle.reset();
+    return std::make_pair(fetch_node(node_page), false);
 }
 
 /**
@@ -280,18 +289,17 @@ bool IxIndexHandle::get_value(const char *key, std::vector<Rid> *result, Transac
     // 提示：使用完buffer_pool提供的page之后，记得unpin page；记得处理并发的上锁
 
     // 0 Find 1 insert 2 delete
+    std::shared_lock lock{root_latch_};
     Operation op = Operation::FIND;
     IxNodeHandle * node_handle = find_leaf_page(key, op, transaction, false).first;
     //printf("%d\n",node_handle->get_page_no());
     Rid *rid;
-    if(node_handle->leaf_lookup(key, &rid)){
+    bool found = node_handle->leaf_lookup(key, &rid);
+    if(found){
         result->push_back(*rid);
-        buffer_pool_manager_->unpin_page(node_handle->get_page_id(), false);
-        return true;
     }
-    buffer_pool_manager_->unpin_page(node_handle->get_page_id(), false);
-    root_latch_.unlock();
-    return false;
+    delete node_handle;
+    return found;
 }
 
 IxNodeHandle *IxIndexHandle::split(IxNodeHandle *node) {
@@ -384,35 +392,38 @@ page_id_t IxIndexHandle::insert_entry(const char *key, const Rid &value, Transac
 
     //first_leaf 首叶节点对应的页号，在上层IxManager的open函数进行初始化，初始化为root_page_no这个不会变
     //printf("start entry\n");
+    if (read_only_) {
+        throw InternalError("IxIndexHandle::insert_entry Error: index is opened read-only.");
+    }
+    std::scoped_lock lock{root_latch_};
     Operation op = Operation::INSERT;
-    std::pair<IxNodeHandle *, bool> result = find_leaf_page(key, op, transaction, false);
-
-    IxNodeHandle *leaf_node = result.first;
-    // int NO = leaf_node->get_page_no();
-    // printf("%d\n",NO);
-    bool root_is_latched = result.second;
-
-    int insert_result = leaf_node->insert(key, value);
-    //printf("insert_result: %d\n", insert_result);
-    if( insert_result == leaf_node->get_max_size() ) {
-        IxNodeHandle *new_node = split(leaf_node);
-        insert_into_parent(leaf_node, key, new_node, transaction);
-        if(file_hdr_->last_leaf_ == leaf_node->get_page_no()){
-            file_hdr_->last_leaf_ = new_node->get_page_id().page_no;
+    page_id_t leaf_page_no;
+    try {
+        std::pair<IxNodeHandle *, bool> result = find_leaf_page(key, op, transaction, false);
+
+        IxNodeHandle *leaf_node = result.first;
+        // int NO = leaf_node->get_page_no();
+        // printf("%d\n",NO);
+        leaf_page_no = leaf_node->get_page_no();
+
+        int insert_result = leaf_node->insert(key, value);
+        //printf("insert_result: %d\n", insert_result);
+        if( insert_result == leaf_node->get_max_size() ) {
+            IxNodeHandle *new_node = split(leaf_node);
+            insert_into_parent(leaf_node, key, new_node, transaction);
+            if(file_hdr_->last_leaf_ == leaf_node->get_page_no()){
+                file_hdr_->last_leaf_ = new_node->get_page_id().page_no;
+            }
+            //本质是个pushup
         }
-        //本质是个pushup
-        buffer_pool_manager_->unpin_page(leaf_node->get_page_id(), true);
-        buffer_pool_manager_->unpin_page(new_node->get_page_id(), true);
-    }
-    else{
-        buffer_pool_manager_->unpin_page(leaf_node->get_page_id(), true);
-    }
-
-    if (root_is_latched) {
-        root_latch_.unlock();
+    } catch (...) {
+        write_set_.clear();
+        throw;
     }
+    // 释放本次插入加了写锁的所有结点
+    write_set_.clear();
     //printf("END entry\n");
-    return leaf_node->get_page_no();
+    return leaf_page_no;
 }
 
 bool IxIndexHandle::delete_entry(const char *key, Transaction *transaction) {
@@ -422,16 +433,28 @@ bool IxIndexHandle::delete_entry(const char *key, Transaction *transaction) {
     // 3. 如果删除成功需要调用CoalesceOrRedistribute来进行合并或重分配操作，并根据函数返回结果判断是否有结点需要删除
     // 4. 如果需要并发，并且需要删除叶子结点，则需要在事务的delete_page_set中添加删除结点的对应页面；记得处理并发的上锁
 
+    if (read_only_) {
+        throw InternalError("IxIndexHandle::delete_entry Error: index is opened read-only.");
+    }
     std::scoped_lock lock{root_latch_};
-    // 1. 获取该键值对所在的叶子结点
-    IxNodeHandle *leaf = find_leaf_page( key, Operation::DELETE, transaction ).first;
-    int num = leaf->get_size();
-    // 2. 在该叶子结点中删除键值对
-    bool res = ( num != leaf->remove(key));
-    //3
-    if(res)coalesce_or_redistribute(leaf);
-
-    buffer_pool_manager_->unpin_page( leaf->get_page_id(), res );
+    bool res;
+    try {
+        // 1. 获取该键值对所在的叶子结点
+        IxNodeHandle *leaf = find_leaf_page( key, Operation::DELETE, transaction ).first;
+        int num = leaf->get_size();
+        // 2. 在该叶子结点中删除键值对
+        res = ( num != leaf->remove(key));
+        //3
+        if(res)coalesce_or_redistribute(leaf);
+    } catch (...) {
+        write_set_.clear();
+        // 出错时树的状态不确定，被删除的结点不归还，只是不能重用
+        released_pages_.clear();
+        throw;
+    }
+    // 释放本次删除加了写锁的所有结点
+    write_set_.clear();
+    free_released_pages();
 
     return res;
 }
@@ -458,14 +481,10 @@ bool IxIndexHandle::coalesce_or_redistribute(IxNodeHandle *node, Transaction *tr
         IxNodeHandle *neighbor = fetch_node( parent->get_rid( index+(index-1?:1) )->page_no ); // 3
         if( node->get_size()+neighbor->get_size() >= node->get_min_size()*2 ) { // 4
             redistribute( neighbor, node, parent, index );
-            buffer_pool_manager_->unpin_page(parent->get_page_id(), true);
-            buffer_pool_manager_->unpin_page(neighbor->get_page_id(), true);
             return false;
         }
         else {
             coalesce( &neighbor, &node, &parent, index, transaction, root_is_latched); // 5
-            buffer_pool_manager_->unpin_page( parent->get_page_id(), true );
-            buffer_pool_manager_->unpin_page( neighbor->get_page_id(), true );
             return true;
         }
     }
@@ -490,7 +509,6 @@ bool IxIndexHandle::adjust_root(IxNodeHandle *old_root_node) {
         release_node_handle( *old_root_node );
         file_hdr_->root_page_ = child->get_page_no();
         child->set_parent_page_no(IX_NO_PAGE);
-        buffer_pool_manager_->unpin_page( child->get_page_id(), true );
         return true;
     }
     else if( old_root_node->is_leaf_page() && old_root_node->page_hdr->num_key ){ // 2
@@ -571,13 +589,11 @@ bool IxIndexHandle::coalesce(IxNodeHandle **neighbor_node, IxNodeHandle **node,
 }
 
 Rid IxIndexHandle::get_rid(const Iid &iid) const {
-    IxNodeHandle *node = fetch_node(iid.page_no);
-    if (iid.slot_no >= node->get_size()) {
+    IxNodeHandle node = read_node(iid.page_no);
+    if (iid.slot_no >= node.get_size()) {
         throw IndexEntryNotFoundError();
     }
-
-    buffer_pool_manager_->unpin_page(node->get_page_id(), false); // unpin it!
-    return *node->get_rid(iid.slot_no);
+    return *node.get_rid(iid.slot_no);
 }
 
 /**
@@ -589,6 +605,7 @@ Rid IxIndexHandle::get_rid(const Iid &iid) const {
  */
 Iid IxIndexHandle::lower_bound(const char *key) {
     // 1. 找到包含 key 的叶子节点
+    std::shared_lock lock{root_latch_};
     std::pair<IxNodeHandle *, bool> result = find_leaf_page(key, Operation::FIND, nullptr, false);
     IxNodeHandle *node = result.first;
 
@@ -601,10 +618,8 @@ Iid IxIndexHandle::lower_bound(const char *key) {
     // 这里简单处理：直接返回该位置
     Iid iid = {node->get_page_no(), slot_no};
 
-    // 4. Unpin
-    buffer_pool_manager_->unpin_page(node->get_page_id(), false);
-    if (result.second) { root_latch_.unlock(); } // 如果加了锁要释放
-    delete node; // 释放 handle 内存
+    // 4. 释放 handle，同时释放叶子结点的读锁和pin
+    delete node;
 
     return iid;
 }
@@ -615,28 +630,32 @@ Iid IxIndexHandle::lower_bound(const char *key) {
  * @return Iid
  */
 Iid IxIndexHandle::upper_bound(const char *key) {
+    std::shared_lock lock{root_latch_};
     std::pair<IxNodeHandle *, bool> result = find_leaf_page(key, Operation::FIND, nullptr, false);
     IxNodeHandle *node = result.first;
 
     int slot_no = node->upper_bound(key);
     Iid iid = {node->get_page_no(), slot_no};
 
-    buffer_pool_manager_->unpin_page(node->get_page_id(), false);
-    if (result.second) { root_latch_.unlock(); }
     delete node;
 
     return iid;
 }
 
+/**
+ * @brief 创建一个新结点并加写锁，结点放入write_set_，在插入或删除结束时释放
+ */
 IxNodeHandle *IxIndexHandle::create_node() {
-    IxNodeHandle *node;
     file_hdr_->num_pages_++;
 
     PageId new_page_id = {.fd = fd_, .page_no = INVALID_PAGE_ID};
     // 从3开始分配page_no，第一次分配之后，new_page_id.page_no=3；file_hdr_.num_pages=4
-    Page *page = buffer_pool_manager_->new_page(&new_page_id);
-    node = new IxNodeHandle(file_hdr_, page);
-    return node;
+    // 新结点是叶子还是内部结点由调用者之后设置，先按叶子处理，下次获取时由classify_node修正
+    WritePageGuard page_guard = buffer_pool_manager_->new_page_write(&new_page_id, PageClass::INDEX_LEAF);
+    auto node = std::make_unique<IxNodeHandle>(file_hdr_, std::move(page_guard));
+    IxNodeHandle *ret = node.get();
+    write_set_.emplace(new_page_id.page_no, std::move(node));
+    return ret;
 }
 
 /**
@@ -652,13 +671,10 @@ void IxIndexHandle::maintain_parent(IxNodeHandle *node) {
         char *parent_key = parent->get_key(rank);
         char *child_first_key = curr->get_key(0);
         if (memcmp(parent_key, child_first_key, file_hdr_->col_tot_len_) == 0) {
-            assert(buffer_pool_manager_->unpin_page(parent->get_page_id(), true));
             break;
         }
         memcpy(parent_key, child_first_key, file_hdr_->col_tot_len_); // 修改了parent node
         curr = parent;
-
-        assert(buffer_pool_manager_->unpin_page(parent->get_page_id(), true));
     }
 }
 
@@ -667,19 +683,29 @@ void IxIndexHandle::erase_leaf(IxNodeHandle *leaf) {
 
     IxNodeHandle *prev = fetch_node(leaf->get_prev_leaf());
     prev->set_next_leaf(leaf->get_next_leaf());
-    buffer_pool_manager_->unpin_page(prev->get_page_id(), true);
 
     IxNodeHandle *next = fetch_node(leaf->get_next_leaf());
     next->set_prev_leaf(leaf->get_prev_leaf()); // 注意此处是SetPrevLeaf()
-    buffer_pool_manager_->unpin_page(next->get_page_id(), true);
 }
 
 /**
- * @brief 删除node时，更新file_hdr_.num_pages
+ * @brief 删除node时，更新file_hdr_.num_pages，并记下它的页面，在write_set_释放之后归还给文件
  * @param node
  */
 void IxIndexHandle::release_node_handle(IxNodeHandle &node) {
     file_hdr_->num_pages_--;
+    released_pages_.push_back(node.get_page_no());
+}
+
+/**
+ * @brief 把本次删除中从B+树中摘除的结点的页面归还给文件的空闲页面列表，之后create_node可以重用，调用时持有root_latch_的排他锁
+ * @note 结点还被并发的扫描固定时页面不归还，只是不能重用
+ */
+void IxIndexHandle::free_released_pages() {
+    for (page_id_t page_no : released_pages_) {
+        buffer_pool_manager_->free_page({.fd = fd_, .page_no = page_no});
+    }
+    released_pages_.clear();
 }
 
 /**
@@ -691,34 +717,80 @@ void IxIndexHandle::maintain_child(IxNodeHandle *node, int child_idx) {
         int child_page_no = node->value_at(child_idx);
         IxNodeHandle *child = fetch_node(child_page_no);
         child->set_parent_page_no(node->get_page_no());
-        buffer_pool_manager_->unpin_page(child->get_page_id(), true);
     }
 }
 
 /**
- * @brief 辅助函数：从缓冲池获取一个节点并封装成句柄
+ * @brief 辅助函数：从缓冲池获取一个结点并加读锁，用于构造只读的结点句柄
+ */
+ReadPageGuard IxIndexHandle::fetch_node_read(int page_no) const {
+    PageId page_id = {.fd = fd_, .page_no = (page_id_t)page_no};
+    ReadPageGuard page_guard = buffer_pool_manager_->fetch_page_read(page_id, nullptr, PageClass::INDEX_LEAF);
+    if (page_guard.is_empty()) {
+        // 这是一个严重的错误，意味着页号无效或缓冲池已满且不可置换
+        assert(false && "FetchPage failed in fetch_node_read: Page not found");
+    }
+    classify_node(page_guard.get_page());
+    return page_guard;
+}
+
+/**
+ * @brief 辅助函数：获取一个只读的结点句柄。只读打开的索引直接指向映射中的页面，不加锁也不pin；
+ * 否则从缓冲池获取并加读锁，随句柄一起释放
  */
-IxNodeHandle *IxIndexHandle::fetch_node(int page_no) const {
+IxNodeHandle IxIndexHandle::read_node(int page_no) const {
+    if (read_only_) {
+        const char *data = disk_manager_->get_mapped_page(fd_, page_no);
+        if (data == nullptr) {
+            throw InternalError("IxIndexHandle::read_node Error: page is not mapped.");
+        }
+        return IxNodeHandle(file_hdr_, const_cast<char *>(data), page_no);
+    }
+    return IxNodeHandle(file_hdr_, fetch_node_read(page_no));
+}
+
+/**
+ * @brief 辅助函数：插入或删除过程中获取一个结点并加写锁，封装成句柄放入write_set_
+ * 同一次操作中再次获取已经加锁的结点时直接返回write_set_中的句柄，避免对同一页面重复加写锁
+ */
+IxNodeHandle *IxIndexHandle::fetch_node(int page_no) {
+    auto it = write_set_.find(page_no);
+    if (it != write_set_.end()) {
+        return it->second.get();
+    }
     PageId page_id = {.fd = fd_, .page_no = (page_id_t)page_no};
-    Page *page = buffer_pool_manager_->fetch_page(page_id);
-    if (page == nullptr) {
+    WritePageGuard page_guard = buffer_pool_manager_->fetch_page_write(page_id, PageClass::INDEX_LEAF);
+    if (page_guard.is_empty()) {
         // 这是一个严重的错误，意味着页号无效或缓冲池已满且不可置换
         assert(false && "FetchPage failed in fetch_node: Page not found");
     }
-    return new IxNodeHandle(file_hdr_, page);
+    classify_node(page_guard.get_page());
+    auto node = std::make_unique<IxNodeHandle>(file_hdr_, std::move(page_guard));
+    IxNodeHandle *ret = node.get();
+    write_set_.emplace(page_no, std::move(node));
+    return ret;
+}
+
+/**
+ * @brief 辅助函数：按结点是否为叶子设置页面在缓冲池中的类别，根结点和内部结点比叶子结点更晚被淘汰
+ * 获取结点时还不知道它是否为叶子，先按叶子获取，读出结点头之后再修正
+ */
+void IxIndexHandle::classify_node(Page *page) const {
+    const IxPageHdr *page_hdr = reinterpret_cast<const IxPageHdr *>(page->get_data());
+    buffer_pool_manager_->set_page_class(page, page_hdr->is_leaf ? PageClass::INDEX_LEAF : PageClass::INDEX_INNER);
 }
 
 /**
  * @brief 获取 B+ 树的第一个叶子节点的 Iid (用于 scan begin)
  */
 Iid IxIndexHandle::leaf_begin() const {
+    std::shared_lock lock{root_latch_};
     std::pair<IxNodeHandle *, bool> result = 
         const_cast<IxIndexHandle *>(this)->find_leaf_page(nullptr, Operation::FIND, nullptr, true);
     
     IxNodeHandle *leaf = result.first;
     Iid iid = Iid{leaf->get_page_no(), 0};
     
-    buffer_pool_manager_->unpin_page(leaf->get_page_id(), false);
     delete leaf;
     
     return iid;
@@ -1,5 +1,10 @@
 #pragma once
 
+#include <memory>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
 #include "ix_defs.h"
 #include "transaction/transaction.h"
 
@@ -47,16 +52,33 @@ class IxNodeHandle {
     IxPageHdr *page_hdr;            // page->data的第一部分，指针指向首地址，长度为sizeof(IxPageHdr)
     char *keys;                     // page->data的第二部分，指针指向首地址，长度为file_hdr->keys_size，每个key的长度为file_hdr->col_len
     Rid *rids;                      // page->data的第三部分，指针指向首地址
+    ReadPageGuard read_guard;       // 结点句柄持有的页面读锁和pin，随句柄一起释放
+    WritePageGuard write_guard;     // 结点句柄持有的页面写锁和pin，随句柄一起释放
+    page_id_t mapped_page_no = INVALID_PAGE_ID;    // 只读映射中的结点的页号，此时page为nullptr
 
    public:
     IxNodeHandle() = default;
 
-    IxNodeHandle(const IxFileHdr *file_hdr_, Page *page_) : file_hdr(file_hdr_), page(page_) {
-        page_hdr = reinterpret_cast<IxPageHdr *>(page->get_data());
-        keys = page->get_data() + sizeof(IxPageHdr);
+    IxNodeHandle(const IxFileHdr *file_hdr_, Page *page_) : IxNodeHandle(file_hdr_, page_->get_data(), INVALID_PAGE_ID) {
+        page = page_;
+    }
+
+    // 只读映射中的结点没有对应的Page，结点内容不能修改
+    IxNodeHandle(const IxFileHdr *file_hdr_, char *data, page_id_t page_no)
+        : file_hdr(file_hdr_), page(nullptr), mapped_page_no(page_no) {
+        page_hdr = reinterpret_cast<IxPageHdr *>(data);
+        keys = data + sizeof(IxPageHdr);
         rids = reinterpret_cast<Rid *>(keys + file_hdr->keys_size_);
     }
 
+    IxNodeHandle(const IxFileHdr *file_hdr_, ReadPageGuard &&guard) : IxNodeHandle(file_hdr_, guard.get_page()) {
+        read_guard = std::move(guard);
+    }
+
+    IxNodeHandle(const IxFileHdr *file_hdr_, WritePageGuard &&guard) : IxNodeHandle(file_hdr_, guard.get_page()) {
+        write_guard = std::move(guard);
+    }
+
     int get_size() { return page_hdr->num_key; }
 
     void set_size(int size) { page_hdr->num_key = size; }
@@ -70,7 +92,7 @@ class IxNodeHandle {
     /* 得到第i个孩子结点的page_no */
     page_id_t value_at(int i) { return get_rid(i)->page_no; }
 
-    page_id_t get_page_no() { return page->get_page_id().page_no; }
+    page_id_t get_page_no() { return page != nullptr ? page->get_page_id().page_no : mapped_page_no; }
 
     PageId get_page_id() { return page->get_page_id(); }
 
@@ -157,10 +179,15 @@ class IxIndexHandle {
     BufferPoolManager *buffer_pool_manager_;
     int fd_;                                    // 存储B+树的文件
     IxFileHdr* file_hdr_;                       // 存了root_page，但其初始化为2（第0页存FILE_HDR_PAGE，第1页存LEAF_HEADER_PAGE）
-    std::mutex root_latch_;
+    bool read_only_;                            // 只读打开：结点直接从DiskManager的只读映射中读取，不经过缓冲池，不能插入和删除
+    mutable std::shared_mutex root_latch_;      // 查找持有共享锁，插入和删除持有排他锁
+    std::unordered_map<page_id_t, std::unique_ptr<IxNodeHandle>> write_set_;  // 插入或删除过程中已经加写锁的结点，操作结束时一起释放
+    std::vector<page_id_t> released_pages_;     // 删除过程中从B+树中摘除的结点，write_set_释放之后归还给文件
 
    public:
-    IxIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd);
+    IxIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd, bool read_only = false);
+
+    bool is_read_only() const { return read_only_; }
 
     // for search
     bool get_value(const char *key, std::vector<Rid> *result, Transaction *transaction);
@@ -202,10 +229,16 @@ class IxIndexHandle {
     bool is_empty() const { return file_hdr_->root_page_ == IX_NO_PAGE; }
 
     // for get/create node
-    IxNodeHandle *fetch_node(int page_no) const;
+    ReadPageGuard fetch_node_read(int page_no) const;
+
+    IxNodeHandle read_node(int page_no) const;
+
+    IxNodeHandle *fetch_node(int page_no);
 
     IxNodeHandle *create_node();
 
+    void classify_node(Page *page) const;
+
     // for maintain data structure
     void maintain_parent(IxNodeHandle *node);
 
@@ -213,6 +246,8 @@ class IxIndexHandle {
 
     void release_node_handle(IxNodeHandle &node);
 
+    void free_released_pages();
+
     void maintain_child(IxNodeHandle *node, int child_idx);
 
     // for index test
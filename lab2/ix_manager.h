@@ -134,19 +134,27 @@ class IxManager {
     }
 
     // 注意这里打开文件，创建并返回了index file handle的指针
-    std::unique_ptr<IxIndexHandle> open_index(const std::string &filename, const std::vector<ColMeta>& index_cols) {
+    // read_only为true时索引文件被只读映射，查找和扫描直接读取映射中的结点，不能插入和删除
+    std::unique_ptr<IxIndexHandle> open_index(const std::string &filename, const std::vector<ColMeta>& index_cols,
+                                              bool read_only = false) {
         std::string ix_name = get_index_name(filename, index_cols);
         int fd = disk_manager_->open_file(ix_name);
-        return std::make_unique<IxIndexHandle>(disk_manager_, buffer_pool_manager_, fd);
+        return std::make_unique<IxIndexHandle>(disk_manager_, buffer_pool_manager_, fd, read_only);
     }
 
-    std::unique_ptr<IxIndexHandle> open_index(const std::string &filename, const std::vector<std::string>& index_cols) {
+    std::unique_ptr<IxIndexHandle> open_index(const std::string &filename, const std::vector<std::string>& index_cols,
+                                              bool read_only = false) {
         std::string ix_name = get_index_name(filename, index_cols);
         int fd = disk_manager_->open_file(ix_name);
-        return std::make_unique<IxIndexHandle>(disk_manager_, buffer_pool_manager_, fd);
+        return std::make_unique<IxIndexHandle>(disk_manager_, buffer_pool_manager_, fd, read_only);
     }
 
     void close_index(const IxIndexHandle *ih) {
+        if (ih->read_only_) {
+            // 只读打开的索引没有修改，关闭文件时解除映射
+            disk_manager_->close_file(ih->fd_);
+            return;
+        }
         char* data = new char[ih->file_hdr_->tot_len_];
         ih->file_hdr_->serialize(data);
         disk_manager_->write_page(ih->fd_, IX_FILE_HDR_PAGE, data, ih->file_hdr_->tot_len_);
@@ -1,21 +1,55 @@
 #include "ix_scan.h"
 
+#include <sys/mman.h>
+
 /**
- * @brief 
- * @todo 加上读锁（需要使用缓冲池得到page）
+ * @brief 移动到下一个位置，访问叶子结点时持有它的读锁，函数返回时随结点句柄一起释放读锁和pin
+ * 扫描不持有root_latch_，插入和删除修改叶子结点时持有写锁，扫描不会读到修改到一半的结点
  */
 void IxScan::next() {
     assert(!is_end());
-    IxNodeHandle *node = ih_->fetch_node(iid_.page_no);
-    assert(node->is_leaf_page());
-    assert(iid_.slot_no < node->get_size());
+    IxNodeHandle node = ih_->read_node(iid_.page_no);
+    assert(node.is_leaf_page());
+    assert(iid_.slot_no < node.get_size());
     // increment slot no
     iid_.slot_no++;
-    if (iid_.page_no != ih_->file_hdr_->last_leaf_ && iid_.slot_no == node->get_size()) {
+    if (iid_.page_no != ih_->file_hdr_->last_leaf_ && iid_.slot_no == node.get_size()) {
         // go to next leaf
         iid_.slot_no = 0;
-        iid_.page_no = node->get_next_leaf();
+        iid_.page_no = node.get_next_leaf();
+        read_ahead_leaves();
+    }
+}
+
+/**
+ * @brief 叶子结点在文件中不一定相邻，无法按页号顺序预读；
+ * 每进入IX_SCAN_READ_AHEAD_LEAVES个叶子结点，就从当前叶子结点开始沿next_leaf链表预读下一批叶子结点
+ */
+void IxScan::read_ahead_leaves() {
+    if (ih_->read_only_) {
+        // 映射中的叶子结点由缺页读入：扫描当前叶子结点的同时让内核异步读入下一个叶子结点
+        if (iid_.page_no == IX_LEAF_HEADER_PAGE) {
+            return;
+        }
+        const IxPageHdr *page_hdr =
+            reinterpret_cast<const IxPageHdr *>(ih_->disk_manager_->get_mapped_page(ih_->fd_, iid_.page_no));
+        if (page_hdr != nullptr && page_hdr->next_leaf != IX_LEAF_HEADER_PAGE) {
+            ih_->disk_manager_->advise_mapped(ih_->fd_, page_hdr->next_leaf, 1, MADV_WILLNEED);
+        }
+        return;
+    }
+    if (leaves_visited_++ % IX_SCAN_READ_AHEAD_LEAVES != 0) {
+        return;
     }
+    PageId start = {ih_->fd_, iid_.page_no};
+    bpm_->read_ahead_chain(start, IX_SCAN_READ_AHEAD_LEAVES + 1, [](const char *data) -> page_id_t {
+        const IxPageHdr *page_hdr = reinterpret_cast<const IxPageHdr *>(data);
+        // 最后一个叶子结点的next_leaf指向叶子头结点
+        if (!page_hdr->is_leaf || page_hdr->next_leaf == IX_LEAF_HEADER_PAGE) {
+            return INVALID_PAGE_ID;
+        }
+        return page_hdr->next_leaf;
+    });
 }
 
 Rid IxScan::rid() const {
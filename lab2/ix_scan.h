@@ -3,16 +3,21 @@
 #include "ix_defs.h"
 #include "ix_index_handle.h"
 
+// 扫描每经过这么多个叶子结点，就沿next_leaf链表预读之后的这么多个叶子结点
+// （只读映射的索引改为每进入一个叶子结点就用MADV_WILLNEED提示下一个叶子结点）
+static constexpr size_t IX_SCAN_READ_AHEAD_LEAVES = 16;
+
 // class IxIndexHandle;
 
 // 用于遍历叶子结点
 // 用于直接遍历叶子结点，而不用findleafpage来得到叶子结点
-// TODO：对page遍历时，要加上读锁
+// 对page遍历时，每次只持有当前叶子结点的读锁
 class IxScan : public RecScan {
     const IxIndexHandle *ih_;
     Iid iid_;  // 初始为lower（用于遍历的指针）
     Iid end_;  // 初始为upper
     BufferPoolManager *bpm_;
+    size_t leaves_visited_ = 0;  // 已经进入的叶子结点个数，用于决定何时提交下一批叶子结点预读
 
    public:
     IxScan(const IxIndexHandle *ih, const Iid &lower, const Iid &upper, BufferPoolManager *bpm)
@@ -25,4 +30,7 @@ class IxScan : public RecScan {
     Rid rid() const override;
 
     const Iid &iid() const { return iid_; }
+
+   private:
+    void read_ahead_leaves();
 };
\ No newline at end of file
@@ -21,6 +21,7 @@ const char *help_info = "Supported SQL syntax:\n"
                    "  DELETE FROM table_name [WHERE where_clause]\n"
                    "  UPDATE table_name SET column_name = value [, column_name = value ...] [WHERE where_clause]\n"
                    "  SELECT selector FROM table_name [WHERE where_clause]\n"
+                   "  SHOW BUFFER STATS\n"
                    "type:\n"
                    "  {INT | FLOAT | CHAR(n)}\n"
                    "where_clause:\n"
@@ -102,7 +103,7 @@ void QlManager::run_mutli_query(std::shared_ptr<Plan> plan, Context *context){
     }
 }
 
-// 执行help; show tables; desc table; begin; commit; abort;语句
+// 执行help; show tables; desc table; show buffer stats; begin; commit; abort;语句
 void QlManager::run_cmd_utility(std::shared_ptr<Plan> plan, txn_id_t *txn_id, Context *context) {
     if (auto x = std::dynamic_pointer_cast<OtherPlan>(plan)) {
         switch(x->tag) {
@@ -122,6 +123,13 @@ void QlManager::run_cmd_utility(std::shared_ptr<Plan> plan, txn_id_t *txn_id, Co
                 sm_manager_->desc_table(x->tab_name_, context);
                 break;
             }
+            // T_ShowBufferStats要在optimizer/plan.h的PlanTag中声明，parser/yacc.y中要有SHOW BUFFER STATS语句，
+            // 并由planner为它生成tag为T_ShowBufferStats的OtherPlan；这几个文件不在本目录中，需要一起修改
+            case T_ShowBufferStats:
+            {
+                show_buffer_stats(context);
+                break;
+            }
             case T_Transaction_begin:
             {
                 // 显示开启一个事务
@@ -154,6 +162,69 @@ void QlManager::run_cmd_utility(std::shared_ptr<Plan> plan, txn_id_t *txn_id, Co
     }
 }
 
+/**
+ * @description: 显示缓冲池的统计：每个文件和全部文件的命中、未命中、淘汰、脏页写回、等待读写的次数，
+ *              未命中时压缩缓存的命中和未命中次数，以及磁盘页面读写的延迟分布（平均值和按2的幂分桶估计的P50/P99）；
+ *              由run_cmd_utility执行SHOW BUFFER STATS语句时调用，把统计写入context的发送缓冲区
+ * @param {Context*} context
+ */
+void QlManager::show_buffer_stats(Context *context) {
+    BufferPoolManager *bpm = sm_manager_->get_bpm();
+    const BufferStats &stats = bpm->get_stats();
+    DiskManager *disk_manager = bpm->get_disk_manager();
+
+    std::vector<std::string> captions = {"File",        "Hits",      "Misses",    "Hit %",      "Evictions",
+                                         "Write-backs", "Pin waits", "Tier hits", "Tier misses"};
+    RecordPrinter printer(captions.size());
+    printer.print_separator(context);
+    printer.print_record(captions, context);
+    printer.print_separator(context);
+    auto print_row = [&](const std::string &name, int fd) {
+        auto get = [&](BufferStat stat) { return fd < 0 ? stats.get(stat) : stats.get(stat, fd); };
+        uint64_t hits = get(BufferStat::HIT);
+        uint64_t misses = get(BufferStat::MISS);
+        char hit_ratio[16];
+        snprintf(hit_ratio, sizeof(hit_ratio), "%.2f", hits + misses == 0 ? 0.0 : 100.0 * hits / (hits + misses));
+        printer.print_record({name, std::to_string(hits), std::to_string(misses), hit_ratio,
+                              std::to_string(get(BufferStat::EVICTION)),
+                              std::to_string(get(BufferStat::DIRTY_WRITE_BACK)),
+                              std::to_string(get(BufferStat::PIN_WAIT)), std::to_string(get(BufferStat::TIER_HIT)),
+                              std::to_string(get(BufferStat::TIER_MISS))},
+                             context);
+    };
+    for (int fd : stats.get_active_fds()) {
+        std::string name;
+        try {
+            name = disk_manager->get_file_name(fd);
+        } catch (RMDBError &) {
+            // 文件已经关闭
+            name = "fd " + std::to_string(fd);
+        }
+        print_row(name, fd);
+    }
+    // fd为-1表示全部文件的合计
+    print_row("ALL", -1);
+    printer.print_separator(context);
+
+    std::vector<std::string> io_captions = {"I/O", "Count", "Avg (us)", "P50 (us)", "P99 (us)"};
+    RecordPrinter io_printer(io_captions.size());
+    io_printer.print_separator(context);
+    io_printer.print_record(io_captions, context);
+    io_printer.print_separator(context);
+    auto print_io_row = [&](const std::string &name, const LatencyHistogram &histogram) {
+        uint64_t count = histogram.get_count();
+        char avg[16];
+        snprintf(avg, sizeof(avg), "%.1f", count == 0 ? 0.0 : histogram.get_total_ns() / 1000.0 / count);
+        io_printer.print_record({name, std::to_string(count), avg,
+                                 "<" + std::to_string(histogram.get_percentile_us(0.5)),
+                                 "<" + std::to_string(histogram.get_percentile_us(0.99))},
+                                context);
+    };
+    print_io_row("read_page", disk_manager->get_read_latency());
+    print_io_row("write_page", disk_manager->get_write_latency());
+    io_printer.print_separator(context);
+}
+
 // 执行select语句，select语句的输出除了需要返回客户端外，还需要写入output.txt文件中
 void QlManager::select_from(std::unique_ptr<AbstractExecutor> executorTreeRoot, std::vector<TabCol> sel_cols, 
                             Context *context) {
@@ -98,6 +98,8 @@ void SmManager::open_db(const std::string& db_name) {
             }
         }
     }
+    // 所有数据文件都已打开，按上次关闭时导出的预热列表在后台把常驻页面读回缓冲池
+    buffer_pool_manager_->start_warm_up(WARM_UP_FILE_NAME);
 }
 
 /**
@@ -113,6 +115,9 @@ void SmManager::flush_meta() {
  * @description: 关闭数据库并把数据落盘
  */
 void SmManager::close_db() {
+    // 在关闭数据文件之前导出预热列表，此时还能把页面的fd换成文件路径；导出失败只影响下次启动的预热
+    buffer_pool_manager_->stop_warm_up();
+    buffer_pool_manager_->dump_resident_pages(WARM_UP_FILE_NAME);
     flush_meta();
     db_.name_.clear();
     db_.tabs_.clear();
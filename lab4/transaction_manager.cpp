@@ -42,6 +42,10 @@ void TransactionManager::commit(Transaction* txn, LogManager* log_manager) {
     if (txn==nullptr) {
         return;
     }
+    // 事务的日志都在提交之前追加，它们的LSN不超过当前的追加位置；只等这个位置持久化，
+    // 同时提交的事务由刷盘线程合并成一次fdatasync
+    LogWriter *log_writer=sm_manager_->get_bpm()->get_disk_manager()->get_log_writer();
+    log_writer->wait_durable(log_writer->get_append_lsn());
     auto lock_set=txn->get_lock_set();
     for (auto &lock_data_id:*lock_set) {
         lock_manager_->unlock(txn,lock_data_id);